@@ -17,6 +17,11 @@
 
 #include "rapidjson.h"
 
+#if RAPIDJSON_HAS_CXX11_THREADS
+#include <atomic>
+#include <new>
+#endif
+
 RAPIDJSON_NAMESPACE_BEGIN
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -279,6 +284,219 @@ private:
     BaseAllocator* ownBaseAllocator_;   //!< base allocator created by this object.
 };
 
+#if RAPIDJSON_HAS_CXX11_THREADS || defined(RAPIDJSON_DOXYGEN_RUNNING)
+
+///////////////////////////////////////////////////////////////////////////////
+// ConcurrentMemoryPoolAllocator
+
+//! Memory pool allocator which can be shared by several threads.
+/*! This is a lock-free variant of MemoryPoolAllocator, so that values of one
+    document can be built by several threads at the same time.
+
+    Memory blocks are allocated from chunks as in MemoryPoolAllocator, but each
+    thread allocates from the current chunk of its own cache slot, selected by
+    a per-thread index. A block is reserved by a compare-and-swap of the
+    chunk size, so threads sharing a slot remain correct. New chunks are pushed
+    to an atomic linked list, and all of them are deallocated at once by
+    Clear() or the destructor.
+
+    It does not free memory blocks. And Realloc() only expands the block in
+    place if it is the last one of the current chunk of the calling thread.
+
+    \note Malloc() and Realloc() may be called concurrently. Clear(),
+          Capacity() and Size() must not be called during allocations.
+    \note BaseAllocator must be thread-safe, as CrtAllocator is.
+    \note This requires C++11 (\c RAPIDJSON_HAS_CXX11_THREADS).
+
+    \tparam BaseAllocator the allocator type for allocating memory chunks. Default is CrtAllocator.
+    \note implements Allocator concept
+*/
+template <typename BaseAllocator = CrtAllocator>
+class ConcurrentMemoryPoolAllocator {
+public:
+    static const bool kNeedFree = false;    //!< Tell users that no need to call Free() with this allocator. (concept Allocator)
+
+    //! Constructor with chunkSize.
+    /*! \param chunkSize The size of memory chunk. The default is kDefaultChunkSize.
+        \param baseAllocator The allocator for allocating memory chunks.
+    */
+    ConcurrentMemoryPoolAllocator(size_t chunkSize = kDefaultChunkCapacity, BaseAllocator* baseAllocator = 0) :
+        chunkHead_(0), slots_(), chunk_capacity_(chunkSize), baseAllocator_(baseAllocator), ownBaseAllocator_(0)
+    {
+        // Created here rather than by the first allocation, which may be concurrent
+        if (!baseAllocator_)
+            ownBaseAllocator_ = baseAllocator_ = RAPIDJSON_NEW(BaseAllocator)();
+        for (size_t i = 0; i < kSlotCount; i++)
+            slots_[i].chunk.store(0, std::memory_order_relaxed);
+    }
+
+    //! Destructor.
+    /*! This deallocates all memory chunks.
+    */
+    ~ConcurrentMemoryPoolAllocator() {
+        Clear();
+        RAPIDJSON_DELETE(ownBaseAllocator_);
+    }
+
+    //! Deallocates all memory chunks.
+    void Clear() {
+        for (size_t i = 0; i < kSlotCount; i++)
+            slots_[i].chunk.store(0, std::memory_order_relaxed);
+        ChunkHeader* chunk = chunkHead_.exchange(0, std::memory_order_acquire);
+        while (chunk) {
+            ChunkHeader* next = chunk->next;
+            chunk->~ChunkHeader();
+            baseAllocator_->Free(chunk);
+            chunk = next;
+        }
+    }
+
+    //! Computes the total capacity of allocated memory chunks.
+    /*! \return total capacity in bytes.
+    */
+    size_t Capacity() const {
+        size_t capacity = 0;
+        for (ChunkHeader* c = chunkHead_.load(std::memory_order_acquire); c != 0; c = c->next)
+            capacity += c->capacity;
+        return capacity;
+    }
+
+    //! Computes the memory blocks allocated.
+    /*! \return total used bytes.
+    */
+    size_t Size() const {
+        size_t size = 0;
+        for (ChunkHeader* c = chunkHead_.load(std::memory_order_acquire); c != 0; c = c->next)
+            size += c->size.load(std::memory_order_relaxed);
+        return size;
+    }
+
+    //! Allocates a memory block. (concept Allocator)
+    void* Malloc(size_t size) {
+        if (!size)
+            return NULL;
+
+        size = RAPIDJSON_ALIGN(size);
+        std::atomic<ChunkHeader*>& slot = slots_[ThreadIndex() % kSlotCount].chunk;
+        if (ChunkHeader* chunk = slot.load(std::memory_order_acquire)) {
+            size_t offset = chunk->size.load(std::memory_order_relaxed);
+            while (size <= chunk->capacity - offset)
+                if (chunk->size.compare_exchange_weak(offset, offset + size, std::memory_order_relaxed))
+                    return GetChunkBuffer(chunk) + offset;
+        }
+        return AddChunk(slot, size);
+    }
+
+    //! Resizes a memory block (concept Allocator)
+    void* Realloc(void* originalPtr, size_t originalSize, size_t newSize) {
+        if (originalPtr == 0)
+            return Malloc(newSize);
+
+        if (newSize == 0)
+            return NULL;
+
+        originalSize = RAPIDJSON_ALIGN(originalSize);
+        newSize = RAPIDJSON_ALIGN(newSize);
+
+        // Do not shrink if new size is smaller than original
+        if (originalSize >= newSize)
+            return originalPtr;
+
+        // Simply expand it if it is the last allocation and there is sufficient space
+        if (ChunkHeader* chunk = slots_[ThreadIndex() % kSlotCount].chunk.load(std::memory_order_acquire)) {
+            size_t size = chunk->size.load(std::memory_order_relaxed);
+            const size_t increment = newSize - originalSize;
+            if (size >= originalSize && increment <= chunk->capacity - size &&
+                originalPtr == GetChunkBuffer(chunk) + size - originalSize &&
+                chunk->size.compare_exchange_strong(size, size + increment, std::memory_order_relaxed))
+                return originalPtr;
+        }
+
+        // Realloc process: allocate and copy memory, do not free original buffer.
+        if (void* newBuffer = Malloc(newSize)) {
+            if (originalSize)
+                std::memcpy(newBuffer, originalPtr, originalSize);
+            return newBuffer;
+        }
+        else
+            return NULL;
+    }
+
+    //! Frees a memory block (concept Allocator)
+    static void Free(void *ptr) { (void)ptr; } // Do nothing
+
+private:
+    //! Copy constructor is not permitted.
+    ConcurrentMemoryPoolAllocator(const ConcurrentMemoryPoolAllocator& rhs) /* = delete */;
+    //! Copy assignment operator is not permitted.
+    ConcurrentMemoryPoolAllocator& operator=(const ConcurrentMemoryPoolAllocator& rhs) /* = delete */;
+
+    struct ChunkHeader;
+
+    //! Creates a new chunk with the first block allocated, and makes it the current chunk of the slot.
+    /*! \param slot Cache slot of the calling thread.
+        \param size Size of the first block, aligned.
+        \return the first block, or null if failed.
+    */
+    char* AddChunk(std::atomic<ChunkHeader*>& slot, size_t size) {
+        const size_t capacity = chunk_capacity_ > size ? chunk_capacity_ : size;
+        void* buffer = baseAllocator_->Malloc(RAPIDJSON_ALIGN(sizeof(ChunkHeader)) + capacity);
+        if (!buffer)
+            return NULL;
+
+        ChunkHeader* chunk = new (buffer) ChunkHeader();
+        chunk->capacity = capacity;
+        chunk->size.store(size, std::memory_order_relaxed);
+        chunk->next = chunkHead_.load(std::memory_order_relaxed);
+        while (!chunkHead_.compare_exchange_weak(chunk->next, chunk, std::memory_order_release, std::memory_order_relaxed))
+            ;
+
+        // A chunk filled by a large block does not replace the current one
+        if (size < capacity)
+            slot.store(chunk, std::memory_order_release);
+        return GetChunkBuffer(chunk);
+    }
+
+    static char* GetChunkBuffer(ChunkHeader* chunk) {
+        return reinterpret_cast<char*>(chunk) + RAPIDJSON_ALIGN(sizeof(ChunkHeader));
+    }
+
+    //! Index of the calling thread, given in order of the first allocation by any ConcurrentMemoryPoolAllocator.
+    static size_t ThreadIndex() {
+        static std::atomic<size_t> count(0);
+        static thread_local const size_t index = count.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    static const int kDefaultChunkCapacity = RAPIDJSON_ALLOCATOR_DEFAULT_CHUNK_CAPACITY; //!< Default chunk capacity.
+    static const size_t kSlotCount = 16;    //!< Number of cache slots. Threads beyond it share slots.
+    static const size_t kCacheLineSize = 64;
+
+    //! Chunk header for perpending to each chunk.
+    /*! Chunks are stored as a singly linked list.
+    */
+    struct ChunkHeader {
+        ChunkHeader() : capacity(), size(), next() {}
+        size_t capacity;            //!< Capacity of the chunk in bytes (excluding the header itself).
+        std::atomic<size_t> size;   //!< Current size of allocated memory in bytes.
+        ChunkHeader *next;          //!< Next chunk in the linked list.
+    };
+
+    //! Current chunk of the threads using a slot, padded to avoid false sharing between slots.
+    struct Slot {
+        std::atomic<ChunkHeader*> chunk;
+        char padding[kCacheLineSize - sizeof(std::atomic<ChunkHeader*>)];
+    };
+
+    std::atomic<ChunkHeader*> chunkHead_;   //!< Head of the chunk linked-list.
+    Slot slots_[kSlotCount];                //!< Current chunks serving allocation.
+    size_t chunk_capacity_;                 //!< The minimum capacity of chunk when they are allocated.
+    BaseAllocator* baseAllocator_;          //!< base allocator for allocating memory chunks.
+    BaseAllocator* ownBaseAllocator_;       //!< base allocator created by this object.
+};
+
+#endif // RAPIDJSON_HAS_CXX11_THREADS
+
 RAPIDJSON_NAMESPACE_END
 
 #endif // RAPIDJSON_ENCODINGS_H_
@@ -650,7 +650,7 @@ public:
         switch (rhs.GetType()) {
         case kObjectType: {
                 SizeType count = rhs.data_.o.size;
-                Member* lm = reinterpret_cast<Member*>(allocator.Malloc(count * sizeof(Member)));
+                Member* lm = AllocateMembers(count, allocator);
                 const typename GenericValue<Encoding,SourceAllocator>::Member* rm = rhs.GetMembersPointer();
                 for (SizeType i = 0; i < count; i++) {
                     new (&lm[i].name) GenericValue(rm[i].name, allocator, copyConstStrings);
@@ -809,7 +809,7 @@ public:
             case kObjectFlag:
                 for (MemberIterator m = MemberBegin(); m != MemberEnd(); ++m)
                     m->~Member();
-                Allocator::Free(GetMembersPointer());
+                FreeMembers();
                 break;
 
             case kCopyStringFlag:
@@ -1173,10 +1173,8 @@ public:
     */
     GenericValue& MemberReserve(SizeType newCapacity, Allocator &allocator) {
         RAPIDJSON_ASSERT(IsObject());
-        if (newCapacity > data_.o.capacity) {
-            SetMembersPointer(reinterpret_cast<Member*>(allocator.Realloc(GetMembersPointer(), data_.o.capacity * sizeof(Member), newCapacity * sizeof(Member))));
-            data_.o.capacity = newCapacity;
-        }
+        if (newCapacity > data_.o.capacity)
+            ReallocateMembers(newCapacity, allocator);
         return *this;
     }
 
@@ -1224,7 +1222,7 @@ public:
         \note Earlier versions of Rapidjson returned a \c NULL pointer, in case
             the requested member doesn't exist. For consistency with e.g.
             \c std::map, this has been changed to MemberEnd() now.
-        \note Linear time complexity.
+        \note Linear time complexity, unless the object is indexed (see \ref RAPIDJSON_MEMBER_HASH_INDEX).
     */
     MemberIterator FindMember(const Ch* name) {
         GenericValue n(StringRef(name));
@@ -1244,12 +1242,16 @@ public:
         \note Earlier versions of Rapidjson returned a \c NULL pointer, in case
             the requested member doesn't exist. For consistency with e.g.
             \c std::map, this has been changed to MemberEnd() now.
-        \note Linear time complexity.
+        \note Linear time complexity, unless the object is indexed (see \ref RAPIDJSON_MEMBER_HASH_INDEX).
     */
     template <typename SourceAllocator>
     MemberIterator FindMember(const GenericValue<Encoding, SourceAllocator>& name) {
         RAPIDJSON_ASSERT(IsObject());
         RAPIDJSON_ASSERT(name.IsString());
+#if RAPIDJSON_MEMBER_HASH_INDEX
+        if (data_.o.size >= kMemberIndexThreshold)
+            return MemberIterator(FindMemberIndexed(name));
+#endif
         MemberIterator member = MemberBegin();
         for ( ; member != MemberEnd(); ++member)
             if (name.StringEqual(member->name))
@@ -1291,6 +1293,10 @@ public:
         members[o.size].name.RawAssign(name);
         members[o.size].value.RawAssign(value);
         o.size++;
+#if RAPIDJSON_MEMBER_HASH_INDEX
+        if (MemberIndex* index = GetMemberIndex())
+            index->Insert(members, o.size - 1);
+#endif
         return *this;
     }
 
@@ -1427,6 +1433,10 @@ public:
         for (MemberIterator m = MemberBegin(); m != MemberEnd(); ++m)
             m->~Member();
         data_.o.size = 0;
+#if RAPIDJSON_MEMBER_HASH_INDEX
+        if (MemberIndex* index = GetMemberIndex())
+            index->Clear();
+#endif
     }
 
     //! Remove a member in object by its name.
@@ -1472,6 +1482,13 @@ public:
         RAPIDJSON_ASSERT(m >= MemberBegin() && m < MemberEnd());
 
         MemberIterator last(GetMembersPointer() + (data_.o.size - 1));
+#if RAPIDJSON_MEMBER_HASH_INDEX
+        if (MemberIndex* index = GetMemberIndex()) {
+            index->Remove(GetMembersPointer(), static_cast<SizeType>(m - MemberBegin()));
+            if (m != last)
+                index->Move(GetMembersPointer(), data_.o.size - 1, static_cast<SizeType>(m - MemberBegin()));
+        }
+#endif
         if (data_.o.size > 1 && m != last)
             *m = *last; // Move the last one to this place
         else
@@ -1515,6 +1532,13 @@ public:
             itr->~Member();
         std::memmove(&*pos, &*last, static_cast<size_t>(MemberEnd() - last) * sizeof(Member));
         data_.o.size -= static_cast<SizeType>(last - first);
+#if RAPIDJSON_MEMBER_HASH_INDEX
+        if (MemberIndex* index = GetMemberIndex()) {
+            index->Clear();
+            for (SizeType i = 0; i < data_.o.size; i++)
+                index->Insert(GetMembersPointer(), i);
+        }
+#endif
         return pos;
     }
 
@@ -1937,6 +1961,9 @@ private:
 
     static const SizeType kDefaultArrayCapacity = 16;
     static const SizeType kDefaultObjectCapacity = 16;
+#if RAPIDJSON_MEMBER_HASH_INDEX
+    static const SizeType kMemberIndexThreshold = RAPIDJSON_MEMBER_HASH_INDEX_THRESHOLD;
+#endif
 
     struct Flag {
 #if RAPIDJSON_48BITPOINTER_OPTIMIZATION
@@ -2026,6 +2053,182 @@ private:
     RAPIDJSON_FORCEINLINE Member* GetMembersPointer() const { return RAPIDJSON_GETPOINTER(Member, data_.o.members); }
     RAPIDJSON_FORCEINLINE Member* SetMembersPointer(Member* members) { return RAPIDJSON_SETPOINTER(Member, data_.o.members, members); }
 
+#if RAPIDJSON_MEMBER_HASH_INDEX
+    //! Hash table of member positions with linear probing, followed by its buckets.
+    struct MemberIndex {
+        struct Bucket {
+            SizeType hash;
+            SizeType member;    //!< Position of the member plus one, 0 if the bucket is empty.
+        };
+
+        static MemberIndex* Create(SizeType capacity, Allocator& allocator) {
+            SizeType bucketCount = 1;
+            while (bucketCount < capacity * 2)
+                bucketCount *= 2;
+            MemberIndex* index = static_cast<MemberIndex*>(allocator.Malloc(sizeof(MemberIndex) + bucketCount * sizeof(Bucket)));
+            index->bucketCount = bucketCount;
+            index->Clear();
+            return index;
+        }
+
+        // FNV-1a
+        template <typename NameType>
+        static SizeType Hash(const NameType& name) {
+            const Ch* s = name.GetString();
+            SizeType h = 2166136261u;
+            for (SizeType n = name.GetStringLength(); n > 0; n--, s++)
+                h = (h ^ static_cast<SizeType>(*s)) * 16777619u;
+            return h;
+        }
+
+        Bucket* Buckets() { return reinterpret_cast<Bucket*>(this + 1); }
+        SizeType Mask() const { return bucketCount - 1; }
+
+        void Clear() { std::memset(Buckets(), 0, bucketCount * sizeof(Bucket)); }
+
+        void Insert(const Member* members, SizeType i) {
+            Bucket* b = Buckets();
+            const SizeType h = Hash(members[i].name);
+            SizeType j = h & Mask();
+            while (b[j].member)
+                j = (j + 1) & Mask();
+            b[j].hash = h;
+            b[j].member = i + 1;
+        }
+
+        SizeType Lookup(const Member* members, SizeType i) {
+            Bucket* b = Buckets();
+            SizeType j = Hash(members[i].name) & Mask();
+            while (b[j].member != i + 1) {
+                RAPIDJSON_ASSERT(b[j].member != 0); // names must not be changed in place
+                j = (j + 1) & Mask();
+            }
+            return j;
+        }
+
+        void Move(const Member* members, SizeType from, SizeType to) {
+            Buckets()[Lookup(members, from)].member = to + 1;
+        }
+
+        // Backward shift deletion, so that no tombstones are needed.
+        void Remove(const Member* members, SizeType i) {
+            Bucket* b = Buckets();
+            SizeType hole = Lookup(members, i);
+            for (SizeType j = (hole + 1) & Mask(); b[j].member; j = (j + 1) & Mask()) {
+                const SizeType home = b[j].hash & Mask();
+                if (((j - home) & Mask()) >= ((j - hole) & Mask())) {
+                    b[hole] = b[j];
+                    hole = j;
+                }
+            }
+            b[hole].member = 0;
+        }
+
+        SizeType bucketCount;   //!< Power of two, at least twice the capacity of the object.
+    };
+
+    //! Header before the members of an object with a capacity of at least kMemberIndexThreshold.
+    struct MemberHeader {
+        Allocator* allocator;   //!< For building the index in FindMember().
+        MemberIndex* index;     //!< Built by the first lookup.
+    };
+
+    static size_t MemberHeaderSize(SizeType capacity) { return capacity >= kMemberIndexThreshold ? sizeof(MemberHeader) : 0; }
+
+    MemberHeader* GetMemberHeader() const {
+        return data_.o.capacity >= kMemberIndexThreshold ? reinterpret_cast<MemberHeader*>(GetMembersPointer()) - 1 : 0;
+    }
+
+    MemberIndex* GetMemberIndex() const {
+        MemberHeader* header = GetMemberHeader();
+        return header ? header->index : 0;
+    }
+
+    Member* AllocateMembers(SizeType capacity, Allocator& allocator) {
+        const size_t headerSize = MemberHeaderSize(capacity);
+        char* p = static_cast<char*>(allocator.Malloc(headerSize + capacity * sizeof(Member)));
+        if (headerSize) {
+            MemberHeader* header = reinterpret_cast<MemberHeader*>(p);
+            header->allocator = &allocator;
+            header->index = 0;
+        }
+        return reinterpret_cast<Member*>(p + headerSize);
+    }
+
+    void ReallocateMembers(SizeType newCapacity, Allocator& allocator) {
+        Member* members = GetMembersPointer();
+        const size_t headerSize = MemberHeaderSize(data_.o.capacity);
+        if (headerSize == MemberHeaderSize(newCapacity)) {
+            MemberHeader* header = GetMemberHeader();
+            if (header && header->index && header->index->bucketCount < newCapacity * 2) {
+                Allocator::Free(header->index);
+                header->index = 0;  // rebuilt by the next lookup
+            }
+            char* p = members ? reinterpret_cast<char*>(members) - headerSize : 0;
+            p = static_cast<char*>(allocator.Realloc(p, headerSize + data_.o.capacity * sizeof(Member), headerSize + newCapacity * sizeof(Member)));
+            SetMembersPointer(reinterpret_cast<Member*>(p + headerSize));
+        }
+        else {
+            // Move the members behind a header
+            Member* m = AllocateMembers(newCapacity, allocator);
+            if (data_.o.size) {
+RAPIDJSON_DIAG_PUSH
+#if defined(__GNUC__) && __GNUC__ >= 8
+RAPIDJSON_DIAG_OFF(class-memaccess) // ignore complains from gcc that no trivial copy constructor exists.
+#endif
+                std::memcpy(m, members, data_.o.size * sizeof(Member));
+RAPIDJSON_DIAG_POP
+            }
+            Allocator::Free(members);
+            SetMembersPointer(m);
+        }
+        data_.o.capacity = newCapacity;
+    }
+
+    void FreeMembers() {
+        if (MemberHeader* header = GetMemberHeader()) {
+            Allocator::Free(header->index);
+            Allocator::Free(header);
+        }
+        else
+            Allocator::Free(GetMembersPointer());
+    }
+
+    //! Find a member in an object with at least kMemberIndexThreshold members, building the index if needed.
+    template <typename SourceAllocator>
+    Member* FindMemberIndexed(const GenericValue<Encoding, SourceAllocator>& name) {
+        MemberHeader* header = GetMemberHeader();
+        RAPIDJSON_ASSERT(header != 0);
+        Member* members = GetMembersPointer();
+        MemberIndex* index = header->index;
+        if (!index) {
+            index = header->index = MemberIndex::Create(data_.o.capacity, *header->allocator);
+            for (SizeType i = 0; i < data_.o.size; i++)
+                index->Insert(members, i);
+        }
+
+        // The first one of duplicated names is found, as by the linear search
+        typename MemberIndex::Bucket* b = index->Buckets();
+        const SizeType h = MemberIndex::Hash(name);
+        SizeType found = data_.o.size;
+        for (SizeType j = h & index->Mask(); b[j].member; j = (j + 1) & index->Mask())
+            if (b[j].hash == h && b[j].member - 1 < found && name.StringEqual(members[b[j].member - 1].name))
+                found = b[j].member - 1;
+        return members + found;
+    }
+#else
+    Member* AllocateMembers(SizeType capacity, Allocator& allocator) {
+        return static_cast<Member*>(allocator.Malloc(capacity * sizeof(Member)));
+    }
+
+    void ReallocateMembers(SizeType newCapacity, Allocator& allocator) {
+        SetMembersPointer(static_cast<Member*>(allocator.Realloc(GetMembersPointer(), data_.o.capacity * sizeof(Member), newCapacity * sizeof(Member))));
+        data_.o.capacity = newCapacity;
+    }
+
+    void FreeMembers() { Allocator::Free(GetMembersPointer()); }
+#endif // RAPIDJSON_MEMBER_HASH_INDEX
+
     // Initialize this value as array with initial data, without calling destructor.
     void SetArrayRaw(GenericValue* values, SizeType count, Allocator& allocator) {
         data_.f.flags = kArrayFlag;
@@ -2048,7 +2251,7 @@ RAPIDJSON_DIAG_POP
     void SetObjectRaw(Member* members, SizeType count, Allocator& allocator) {
         data_.f.flags = kObjectFlag;
         if (count) {
-            Member* m = static_cast<Member*>(allocator.Malloc(count * sizeof(Member)));
+            Member* m = AllocateMembers(count, allocator);
             SetMembersPointer(m);
 RAPIDJSON_DIAG_PUSH
 #if defined(__GNUC__) && __GNUC__ >= 8
@@ -41,6 +41,11 @@ class CrtAllocator;
 template <typename BaseAllocator>
 class MemoryPoolAllocator;
 
+#if RAPIDJSON_HAS_CXX11_THREADS
+template <typename BaseAllocator>
+class ConcurrentMemoryPoolAllocator;
+#endif
+
 // stream.h
 
 template <typename Encoding>
@@ -79,6 +84,10 @@ typedef GenericMemoryBuffer<CrtAllocator> MemoryBuffer;
 
 struct MemoryStream;
 
+// memorymappedfilestream.h
+
+class MemoryMappedFileStream;
+
 // reader.h
 
 template<typename Encoding, typename Derived>
@@ -120,6 +129,15 @@ class GenericDocument;
 
 typedef GenericDocument<UTF8<char>, MemoryPoolAllocator<CrtAllocator>, CrtAllocator> Document;
 
+// lazydocument.h
+
+template <typename Encoding, typename Allocator, typename StackAllocator>
+class GenericLazyValue;
+
+template <typename Encoding, typename Allocator, typename StackAllocator>
+class GenericLazyDocument;
+typedef GenericLazyDocument<UTF8<char>, MemoryPoolAllocator<CrtAllocator>, CrtAllocator> LazyDocument;
+
 // pointer.h
 
 template <typename ValueType, typename Allocator>
@@ -127,6 +145,13 @@ class GenericPointer;
 
 typedef GenericPointer<Value, CrtAllocator> Pointer;
 
+// projection.h
+
+template <typename PointerType, typename StackAllocator>
+class GenericProjectionReader;
+
+typedef GenericProjectionReader<Pointer, CrtAllocator> ProjectionReader;
+
 // schema.h
 
 template <typename SchemaDocumentType>
@@ -172,6 +172,26 @@ struct DiyFp {
     int e;
 };
 
+// Full product of two 64-bit integers: returns the low half, and stores the high half.
+inline uint64_t UMul128(uint64_t a, uint64_t b, uint64_t* high) {
+#if defined(_MSC_VER) && defined(_M_AMD64)
+    return _umul128(a, b, high);
+#elif (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6)) && defined(__x86_64__)
+    __extension__ typedef unsigned __int128 uint128;
+    const uint128 p = static_cast<uint128>(a) * static_cast<uint128>(b);
+    *high = static_cast<uint64_t>(p >> 64);
+    return static_cast<uint64_t>(p);
+#else
+    const uint64_t M32 = 0xFFFFFFFF;
+    const uint64_t aHi = a >> 32, aLo = a & M32;
+    const uint64_t bHi = b >> 32, bLo = b & M32;
+    const uint64_t lo = aLo * bLo, mid1 = aHi * bLo, mid2 = aLo * bHi;
+    const uint64_t mid = (lo >> 32) + (mid1 & M32) + (mid2 & M32);
+    *high = aHi * bHi + (mid1 >> 32) + (mid2 >> 32) + (mid >> 32);
+    return (mid << 32) | (lo & M32);
+#endif
+}
+
 inline DiyFp GetCachedPowerByIndex(size_t index) {
     // 10^-348, 10^-340, ..., 10^340
     static const uint64_t kCachedPowers_F[] = {
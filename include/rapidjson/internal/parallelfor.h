@@ -0,0 +1,80 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_INTERNAL_PARALLELFOR_H_
+#define RAPIDJSON_INTERNAL_PARALLELFOR_H_
+
+#include "../rapidjson.h"
+
+#if RAPIDJSON_HAS_CXX11_THREADS
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+RAPIDJSON_NAMESPACE_BEGIN
+namespace internal {
+
+//! Number of threads to use for a requested count, where 0 means one per hardware thread.
+inline unsigned ResolveThreadCount(unsigned threadCount) {
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    return threadCount == 0 ? 1u : threadCount;
+}
+
+//! Number of threads ParallelFor() runs for count items, at most one per batch.
+inline size_t ParallelForThreadCount(size_t threadCount, size_t count, size_t batchSize) {
+    const size_t batchCount = count / batchSize + (count % batchSize ? 1u : 0u);
+    return threadCount < batchCount ? threadCount : batchCount;
+}
+
+//! Call f(thread, i) for each i < count on several threads.
+/*! The threads take batches of batchSize consecutive items in turn. The
+    calling thread is thread 0, and the others are started for the call.
+    \param threadCount Maximum number of threads, including the calling one.
+    \param count Number of items.
+    \param batchSize Number of items taken by a thread at a time, greater than 0.
+    \param f Function called as f(size_t thread, size_t i), where thread is less than ParallelForThreadCount().
+    \note f must not throw exceptions, which would terminate the program in a started thread.
+*/
+template <typename Function>
+void ParallelFor(size_t threadCount, size_t count, size_t batchSize, Function f) {
+    RAPIDJSON_ASSERT(batchSize > 0);
+    std::atomic<size_t> next(0);
+    auto work = [count, batchSize, &next, &f](size_t thread) {
+        for (;;) {
+            const size_t begin = next.fetch_add(batchSize, std::memory_order_relaxed);
+            if (begin >= count)
+                break;
+            const size_t end = count - begin > batchSize ? begin + batchSize : count;
+            for (size_t i = begin; i < end; i++)
+                f(thread, i);
+        }
+    };
+
+    const size_t n = ParallelForThreadCount(threadCount, count, batchSize);
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < n; i++)
+        threads.push_back(std::thread(work, i));
+    work(0);
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+}
+
+} // namespace internal
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_HAS_CXX11_THREADS
+
+#endif // RAPIDJSON_INTERNAL_PARALLELFOR_H_
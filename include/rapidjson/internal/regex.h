@@ -41,6 +41,13 @@ RAPIDJSON_DIAG_OFF(implicit-fallthrough)
 #define RAPIDJSON_REGEX_VERBOSE 0
 #endif
 
+//! Maximum number of states of the DFA compiled for a regex.
+/*! A regex needing more states, or all regexes when it is defined as 0, are matched by the NFA only.
+*/
+#ifndef RAPIDJSON_REGEX_MAX_DFA_STATES
+#define RAPIDJSON_REGEX_MAX_DFA_STATES 128
+#endif
+
 RAPIDJSON_NAMESPACE_BEGIN
 namespace internal {
 
@@ -78,6 +85,9 @@ static const SizeType kRegexInvalidRange = ~SizeType(0);
 template <typename Encoding, typename Allocator>
 class GenericRegexSearch;
 
+template <typename Encoding, typename Allocator>
+class GenericRegexSet;
+
 //! Regular expression engine with subset of ECMAscript grammar.
 /*!
     Supported regular expression syntax:
@@ -109,6 +119,10 @@ class GenericRegexSearch;
     \note This is a Thompson NFA engine, implemented with reference to 
         Cox, Russ. "Regular Expression Matching Can Be Simple And Fast (but is slow in Java, Perl, PHP, Python, Ruby,...).", 
         https://swtch.com/~rsc/regexp/regexp1.html 
+
+    \note The NFA is also compiled into a DFA over ASCII code points, with at most
+        RAPIDJSON_REGEX_MAX_DFA_STATES states, so that matching takes a table lookup
+        per character. The NFA takes over from the first non-ASCII character.
 */
 template <typename Encoding, typename Allocator = CrtAllocator>
 class GenericRegex {
@@ -116,14 +130,22 @@ public:
     typedef Encoding EncodingType;
     typedef typename Encoding::Ch Ch;
     template <typename, typename> friend class GenericRegexSearch;
+    template <typename, typename> friend class GenericRegexSet;
 
     GenericRegex(const Ch* source, Allocator* allocator = 0) : 
         states_(allocator, 256), ranges_(allocator, 256), root_(kRegexInvalidState), stateCount_(), rangeCount_(), 
-        anchorBegin_(), anchorEnd_()
+        asciiClassCount_(), anchoredDfa_(allocator), unanchoredDfa_(allocator), anchorBegin_(), anchorEnd_()
     {
         GenericStringStream<Encoding> ss(source);
         DecodedStream<GenericStringStream<Encoding>, Encoding> ds(ss);
         Parse(ds);
+        if (IsValid() && RAPIDJSON_REGEX_MAX_DFA_STATES > 0) {
+            ComputeAsciiClasses();
+            GenericRegexSearch<GenericRegex, Allocator> rs(*this, allocator);
+            rs.CompileDfa(anchoredDfa_, true);
+            if (!anchorBegin_)
+                rs.CompileDfa(unanchoredDfa_, false);
+        }
     }
 
     ~GenericRegex() {}
@@ -159,6 +181,15 @@ private:
         unsigned codepoint;
     };
 
+    //! DFA over ASCII code points, by subset construction of the NFA. The start state is 0.
+    struct Dfa {
+        Dfa(Allocator* allocator) : transitions(allocator, 0), stateSets(allocator, 0), accepts(allocator, 0), stateCount() {}
+        Stack<Allocator> transitions;   //!< Next state per ASCII class of each state, kRegexInvalidState if no NFA state is left (SizeType)
+        Stack<Allocator> stateSets;     //!< Bit set of the NFA states of each state (uint32_t)
+        Stack<Allocator> accepts;       //!< Whether each state is reached by a match (bool)
+        SizeType stateCount;            //!< Zero if the DFA is not available
+    };
+
     struct Frag {
         Frag(SizeType s, SizeType o, SizeType m) : start(s), out(o), minIndex(m) {}
         SizeType start;
@@ -186,6 +217,44 @@ private:
         return ranges_.template Bottom<Range>()[index];
     }
 
+    bool MatchCodepoint(const State& s, unsigned codepoint) const {
+        return s.codepoint == codepoint ||
+            s.codepoint == kAnyCharacterClass ||
+            (s.codepoint == kRangeCharacterClass && MatchRange(s.rangeStart, codepoint));
+    }
+
+    bool MatchRange(SizeType rangeIndex, unsigned codepoint) const {
+        bool yes = (GetRange(rangeIndex).start & kRangeNegationFlag) == 0;
+        while (rangeIndex != kRegexInvalidRange) {
+            const Range& r = GetRange(rangeIndex);
+            if (codepoint >= (r.start & ~kRangeNegationFlag) && codepoint <= r.end)
+                return yes;
+            rangeIndex = r.next;
+        }
+        return !yes;
+    }
+
+    // Group the ASCII code points which are matched by the same states, as the alphabet of the DFA.
+    // '\0' terminates the input, so it is never looked up.
+    void ComputeAsciiClasses() {
+        asciiClasses_[0] = 0;
+        for (unsigned c = 1; c < 128; c++) {
+            SizeType k = 0;
+            for (; k < asciiClassCount_; k++) {
+                const unsigned other = asciiClassCodepoints_[k];
+                SizeType i = 0;
+                for (; i < stateCount_; i++)
+                    if (MatchCodepoint(GetState(i), c) != MatchCodepoint(GetState(i), other))
+                        break;
+                if (i == stateCount_)
+                    break;
+            }
+            if (k == asciiClassCount_)
+                asciiClassCodepoints_[asciiClassCount_++] = c;
+            asciiClasses_[c] = static_cast<unsigned char>(k);
+        }
+    }
+
     template <typename InputStream>
     void Parse(DecodedStream<InputStream, Encoding>& ds) {
         Allocator allocator;
@@ -590,6 +659,12 @@ private:
 
     static const unsigned kInfinityQuantifier = ~0u;
 
+    unsigned char asciiClasses_[128];       //!< ASCII class of each ASCII code point
+    unsigned asciiClassCodepoints_[128];    //!< First code point of each ASCII class
+    SizeType asciiClassCount_;
+    Dfa anchoredDfa_;                       //!< For searching from the beginning only
+    Dfa unanchoredDfa_;                     //!< For searching from any position, unless the regex begins with '^'
+
     // For SearchWithAnchoring()
     bool anchorBegin_;
     bool anchorEnd_;
@@ -600,17 +675,13 @@ class GenericRegexSearch {
 public:
     typedef typename RegexType::EncodingType Encoding;
     typedef typename Encoding::Ch Ch;
+    template <typename, typename> friend class GenericRegex;
 
     GenericRegexSearch(const RegexType& regex, Allocator* allocator = 0) : 
         regex_(regex), allocator_(allocator), ownAllocator_(0),
         state0_(allocator, 0), state1_(allocator, 0), stateSet_()
     {
         RAPIDJSON_ASSERT(regex_.IsValid());
-        if (!allocator_)
-            ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator)();
-        stateSet_ = static_cast<unsigned*>(allocator_->Malloc(GetStateSetSize()));
-        state0_.template Reserve<SizeType>(regex_.stateCount_);
-        state1_.template Reserve<SizeType>(regex_.stateCount_);
     }
 
     ~GenericRegexSearch() {
@@ -641,28 +712,60 @@ public:
 private:
     typedef typename RegexType::State State;
     typedef typename RegexType::Range Range;
+    typedef typename RegexType::Dfa Dfa;
 
     template <typename InputStream>
     bool SearchWithAnchoring(InputStream& is, bool anchorBegin, bool anchorEnd) {
         DecodedStream<InputStream, Encoding> ds(is);
+        const Dfa& dfa = anchorBegin ? regex_.anchoredDfa_ : regex_.unanchoredDfa_;
+        unsigned codepoint;
 
+        if (dfa.stateCount) {
+            const SizeType* transitions = dfa.transitions.template Bottom<SizeType>();
+            const bool* accepts = dfa.accepts.template Bottom<bool>();
+            SizeType d = 0;
+            while ((codepoint = ds.Take()) != 0) {
+                if (codepoint >= 128) {
+                    // Continue with the NFA states of the DFA state
+                    Prepare();
+                    state0_.Clear();
+                    const uint32_t* stateSet = dfa.stateSets.template Bottom<uint32_t>() + d * (GetStateSetSize() / sizeof(uint32_t));
+                    for (SizeType i = 0; i < regex_.stateCount_; i++)
+                        if (stateSet[i >> 5] & (1u << (i & 31)))
+                            *state0_.template PushUnsafe<SizeType>() = i;
+                    return SearchNfa(ds, codepoint, anchorBegin, anchorEnd);
+                }
+                d = transitions[d * regex_.asciiClassCount_ + regex_.asciiClasses_[codepoint]];
+                if (d == kRegexInvalidState)
+                    return false;
+                if (!anchorEnd && accepts[d])
+                    return true;
+            }
+            return accepts[d];
+        }
+
+        Prepare();
         state0_.Clear();
+        std::memset(stateSet_, 0, GetStateSetSize());
+        bool matched = AddState(state0_, regex_.root_);
+        if ((codepoint = ds.Take()) == 0)
+            return matched;
+        return SearchNfa(ds, codepoint, anchorBegin, anchorEnd);
+    }
+
+    // Simulate the NFA from the states in state0_, with codepoint and the rest of the stream.
+    template <typename InputStream>
+    bool SearchNfa(DecodedStream<InputStream, Encoding>& ds, unsigned codepoint, bool anchorBegin, bool anchorEnd) {
         Stack<Allocator> *current = &state0_, *next = &state1_;
         const size_t stateSetSize = GetStateSetSize();
-        std::memset(stateSet_, 0, stateSetSize);
-
-        bool matched = AddState(*current, regex_.root_);
-        unsigned codepoint;
-        while (!current->Empty() && (codepoint = ds.Take()) != 0) {
+        bool matched;
+        do {
             std::memset(stateSet_, 0, stateSetSize);
             next->Clear();
             matched = false;
             for (const SizeType* s = current->template Bottom<SizeType>(); s != current->template End<SizeType>(); ++s) {
                 const State& sr = regex_.GetState(*s);
-                if (sr.codepoint == codepoint ||
-                    sr.codepoint == RegexType::kAnyCharacterClass || 
-                    (sr.codepoint == RegexType::kRangeCharacterClass && MatchRange(sr.rangeStart, codepoint)))
-                {
+                if (regex_.MatchCodepoint(sr, codepoint)) {
                     matched = AddState(*next, sr.out) || matched;
                     if (!anchorEnd && matched)
                         return true;
@@ -671,11 +774,86 @@ private:
                     AddState(*next, regex_.root_);
             }
             internal::Swap(current, next);
-        }
+        } while (!current->Empty() && (codepoint = ds.Take()) != 0);
 
         return matched;
     }
 
+    // Build the DFA by taking each NFA step once per DFA state and ASCII class.
+    // The DFA is left unavailable if it needs more than RAPIDJSON_REGEX_MAX_DFA_STATES states.
+    void CompileDfa(Dfa& dfa, bool anchorBegin) {
+        Prepare();
+        const size_t stateSetSize = GetStateSetSize();
+        state0_.Clear();
+        std::memset(stateSet_, 0, stateSetSize);
+        AddDfaState(dfa, AddState(state0_, regex_.root_));
+
+        for (SizeType d = 0; d < dfa.stateCount; d++) {
+            for (SizeType k = 0; k < regex_.asciiClassCount_; k++) {
+                const unsigned codepoint = regex_.asciiClassCodepoints_[k];
+                std::memset(stateSet_, 0, stateSetSize);
+                state1_.Clear();
+                state0_.Clear();
+                const uint32_t* stateSet = dfa.stateSets.template Bottom<uint32_t>() + d * (stateSetSize / sizeof(uint32_t));
+                for (SizeType i = 0; i < regex_.stateCount_; i++)
+                    if (stateSet[i >> 5] & (1u << (i & 31)))
+                        *state0_.template PushUnsafe<SizeType>() = i;
+
+                bool matched = false;
+                for (const SizeType* s = state0_.template Bottom<SizeType>(); s != state0_.template End<SizeType>(); ++s) {
+                    const State& sr = regex_.GetState(*s);
+                    if (regex_.MatchCodepoint(sr, codepoint))
+                        matched = AddState(state1_, sr.out) || matched;
+                }
+                if (!anchorBegin)
+                    AddState(state1_, regex_.root_);
+
+                SizeType target = kRegexInvalidState;
+                if (!state1_.Empty() && (target = FindDfaState(dfa, matched)) == kRegexInvalidState) {
+                    if (dfa.stateCount == RAPIDJSON_REGEX_MAX_DFA_STATES) {
+                        dfa.transitions.Clear(); dfa.transitions.ShrinkToFit();
+                        dfa.stateSets.Clear(); dfa.stateSets.ShrinkToFit();
+                        dfa.accepts.Clear(); dfa.accepts.ShrinkToFit();
+                        dfa.stateCount = 0;
+                        return;
+                    }
+                    target = AddDfaState(dfa, matched);
+                }
+                *dfa.transitions.template Push<SizeType>() = target;
+            }
+        }
+    }
+
+    // Find the DFA state of the NFA states in stateSet_.
+    SizeType FindDfaState(const Dfa& dfa, bool accept) const {
+        const size_t stateSetSize = GetStateSetSize();
+        const uint32_t* stateSet = dfa.stateSets.template Bottom<uint32_t>();
+        const bool* accepts = dfa.accepts.template Bottom<bool>();
+        for (SizeType d = 0; d < dfa.stateCount; d++, stateSet += stateSetSize / sizeof(uint32_t))
+            if (accepts[d] == accept && std::memcmp(stateSet, stateSet_, stateSetSize) == 0)
+                return d;
+        return kRegexInvalidState;
+    }
+
+    // Add a DFA state of the NFA states in stateSet_.
+    SizeType AddDfaState(Dfa& dfa, bool accept) {
+        const size_t stateSetSize = GetStateSetSize();
+        std::memcpy(dfa.stateSets.template Push<uint32_t>(stateSetSize / sizeof(uint32_t)), stateSet_, stateSetSize);
+        *dfa.accepts.template Push<bool>() = accept;
+        return dfa.stateCount++;
+    }
+
+    // Allocate the states of the NFA simulation, unless already done.
+    void Prepare() {
+        if (stateSet_)
+            return;
+        if (!allocator_)
+            ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator)();
+        stateSet_ = static_cast<uint32_t*>(allocator_->Malloc(GetStateSetSize()));
+        state0_.template Reserve<SizeType>(regex_.stateCount_);
+        state1_.template Reserve<SizeType>(regex_.stateCount_);
+    }
+
     size_t GetStateSetSize() const {
         return (regex_.stateCount_ + 31) / 32 * 4;
     }
@@ -696,17 +874,6 @@ private:
         return s.out == kRegexInvalidState; // by using PushUnsafe() above, we can ensure s is not validated due to reallocation.
     }
 
-    bool MatchRange(SizeType rangeIndex, unsigned codepoint) const {
-        bool yes = (regex_.GetRange(rangeIndex).start & RegexType::kRangeNegationFlag) == 0;
-        while (rangeIndex != kRegexInvalidRange) {
-            const Range& r = regex_.GetRange(rangeIndex);
-            if (codepoint >= (r.start & ~RegexType::kRangeNegationFlag) && codepoint <= r.end)
-                return yes;
-            rangeIndex = r.next;
-        }
-        return !yes;
-    }
-
     const RegexType& regex_;
     Allocator* allocator_;
     Allocator* ownAllocator_;
@@ -715,8 +882,204 @@ private:
     uint32_t* stateSet_;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// GenericRegexSet
+
+//! Searches several regexes in one pass over a string.
+/*!
+    The DFAs of the regexes are combined into a product DFA over the ASCII classes of all regexes, whose
+    states also tag the regexes found so far. So a string of ASCII characters is searched by all regexes
+    with one table lookup per character.
+
+    Otherwise, that is, for a string with non-ASCII characters, a regex without DFA, or a product DFA
+    which would exceed RAPIDJSON_REGEX_MAX_DFA_STATES states, each regex is searched in turn.
+
+    \tparam RegexType Type of GenericRegex.
+    \tparam Allocator Allocator of the product DFA.
+*/
+template <typename RegexType, typename Allocator = CrtAllocator>
+class GenericRegexSet {
+public:
+    typedef typename RegexType::EncodingType Encoding;
+    typedef typename Encoding::Ch Ch;
+
+    //! Constructor.
+    /*!
+        \param regexes Valid regexes to be searched, or null for one which is never found. They must outlive this object.
+        \param count Number of regexes.
+        \param allocator Optional allocator for the product DFA.
+    */
+    GenericRegexSet(const RegexType* const* regexes, SizeType count, Allocator* allocator = 0) :
+        regexes_(allocator, count * sizeof(const RegexType*)), regexCount_(count), wordCount_((count + 31) / 32), asciiClassCount_(),
+        transitions_(allocator, 0), tuples_(allocator, 0), founds_(allocator, 0), results_(allocator, 0), finals_(allocator, 0), stateCount_()
+    {
+        if (count)
+            std::memcpy(regexes_.template Push<const RegexType*>(count), regexes, count * sizeof(const RegexType*));
+        if (count && RAPIDJSON_REGEX_MAX_DFA_STATES > 0)
+            CompileDfa();
+    }
+
+    SizeType GetRegexCount() const { return regexCount_; }
+
+    //! Search a string by all regexes, like GenericRegexSearch::Search().
+    /*!
+        \param s Null-terminated string.
+        \param handler Its \c Found(SizeType index) is called for each regex found in the string, in the order of indices.
+    */
+    template <typename Handler>
+    void Search(const Ch* s, Handler& handler) const {
+        if (stateCount_) {
+            GenericStringStream<Encoding> is(s);
+            DecodedStream<GenericStringStream<Encoding>, Encoding> ds(is);
+            const SizeType* transitions = transitions_.template Bottom<SizeType>();
+            const bool* finals = finals_.template Bottom<bool>();
+            SizeType d = 0;
+            unsigned codepoint = 0;
+            while (!finals[d] && (codepoint = ds.Take()) != 0 && codepoint < 128)
+                d = transitions[d * asciiClassCount_ + asciiClasses_[codepoint]];
+
+            if (finals[d] || codepoint == 0) {
+                const uint32_t* result = results_.template Bottom<uint32_t>() + d * wordCount_;
+                for (SizeType i = 0; i < regexCount_; i++)
+                    if (result[i >> 5] & (1u << (i & 31)))
+                        handler.Found(i);
+                return;
+            }
+        }
+
+        for (SizeType i = 0; i < regexCount_; i++)
+            if (const RegexType* regex = GetRegex(i)) {
+                GenericRegexSearch<RegexType> rs(*regex);
+                if (rs.Search(s))
+                    handler.Found(i);
+            }
+    }
+
+private:
+    typedef typename RegexType::Dfa Dfa;
+
+    const RegexType* GetRegex(SizeType index) const { return regexes_.template Bottom<const RegexType*>()[index]; }
+
+    const Dfa& GetDfa(const RegexType& regex) const { return regex.anchorBegin_ ? regex.anchoredDfa_ : regex.unanchoredDfa_; }
+
+    // Build the product DFA, whose states are the tuples of the state of each regex, with the bits of the regexes
+    // found before the end. A regex found, or which cannot match anymore, has no state in the tuple.
+    void CompileDfa() {
+        for (SizeType i = 0; i < regexCount_; i++)
+            if (GetRegex(i) && GetDfa(*GetRegex(i)).stateCount == 0)
+                return;
+
+        ComputeAsciiClasses();
+
+        Allocator allocator;
+        Stack<Allocator> tuple(&allocator, regexCount_ * sizeof(SizeType));
+        Stack<Allocator> found(&allocator, wordCount_ * sizeof(uint32_t));
+        SizeType* t = tuple.template Push<SizeType>(regexCount_);
+        uint32_t* f = found.template Push<uint32_t>(wordCount_);
+        for (SizeType i = 0; i < regexCount_; i++)
+            t[i] = GetRegex(i) ? 0 : kRegexInvalidState;
+        std::memset(f, 0, wordCount_ * sizeof(uint32_t));
+        AddDfaState(t, f);
+
+        for (SizeType d = 0; d < stateCount_; d++) {
+            for (SizeType k = 0; k < asciiClassCount_; k++) {
+                const unsigned codepoint = asciiClassCodepoints_[k];
+                std::memcpy(t, tuples_.template Bottom<SizeType>() + d * regexCount_, regexCount_ * sizeof(SizeType));
+                std::memcpy(f, founds_.template Bottom<uint32_t>() + d * wordCount_, wordCount_ * sizeof(uint32_t));
+                for (SizeType i = 0; i < regexCount_; i++) {
+                    if (t[i] == kRegexInvalidState)
+                        continue;
+                    const RegexType& regex = *GetRegex(i);
+                    const Dfa& dfa = GetDfa(regex);
+                    t[i] = dfa.transitions.template Bottom<SizeType>()[t[i] * regex.asciiClassCount_ + regex.asciiClasses_[codepoint]];
+                    if (t[i] != kRegexInvalidState && !regex.anchorEnd_ && dfa.accepts.template Bottom<bool>()[t[i]]) {
+                        f[i >> 5] |= 1u << (i & 31);
+                        t[i] = kRegexInvalidState;
+                    }
+                }
+
+                SizeType target = FindDfaState(t, f);
+                if (target == kRegexInvalidState) {
+                    if (stateCount_ == RAPIDJSON_REGEX_MAX_DFA_STATES) {
+                        transitions_.Clear(); transitions_.ShrinkToFit();
+                        tuples_.Clear(); tuples_.ShrinkToFit();
+                        founds_.Clear(); founds_.ShrinkToFit();
+                        results_.Clear(); results_.ShrinkToFit();
+                        finals_.Clear(); finals_.ShrinkToFit();
+                        stateCount_ = 0;
+                        return;
+                    }
+                    target = AddDfaState(t, f);
+                }
+                *transitions_.template Push<SizeType>() = target;
+            }
+        }
+    }
+
+    // Group the ASCII code points which are in the same class of every regex.
+    void ComputeAsciiClasses() {
+        asciiClasses_[0] = 0;
+        for (unsigned c = 1; c < 128; c++) {
+            SizeType k = 0;
+            for (; k < asciiClassCount_; k++) {
+                const unsigned other = asciiClassCodepoints_[k];
+                SizeType i = 0;
+                for (; i < regexCount_; i++)
+                    if (GetRegex(i) && GetRegex(i)->asciiClasses_[c] != GetRegex(i)->asciiClasses_[other])
+                        break;
+                if (i == regexCount_)
+                    break;
+            }
+            if (k == asciiClassCount_)
+                asciiClassCodepoints_[asciiClassCount_++] = c;
+            asciiClasses_[c] = static_cast<unsigned char>(k);
+        }
+    }
+
+    SizeType FindDfaState(const SizeType* tuple, const uint32_t* found) const {
+        const SizeType* t = tuples_.template Bottom<SizeType>();
+        const uint32_t* f = founds_.template Bottom<uint32_t>();
+        for (SizeType d = 0; d < stateCount_; d++, t += regexCount_, f += wordCount_)
+            if (std::memcmp(t, tuple, regexCount_ * sizeof(SizeType)) == 0 && std::memcmp(f, found, wordCount_ * sizeof(uint32_t)) == 0)
+                return d;
+        return kRegexInvalidState;
+    }
+
+    SizeType AddDfaState(const SizeType* tuple, const uint32_t* found) {
+        std::memcpy(tuples_.template Push<SizeType>(regexCount_), tuple, regexCount_ * sizeof(SizeType));
+        std::memcpy(founds_.template Push<uint32_t>(wordCount_), found, wordCount_ * sizeof(uint32_t));
+
+        // The regexes found if the string ends in this state, as in GenericRegexSearch::SearchWithAnchoring()
+        uint32_t* result = results_.template Push<uint32_t>(wordCount_);
+        std::memcpy(result, found, wordCount_ * sizeof(uint32_t));
+        bool decided = true;
+        for (SizeType i = 0; i < regexCount_; i++)
+            if (tuple[i] != kRegexInvalidState) {
+                decided = false;
+                if (GetDfa(*GetRegex(i)).accepts.template Bottom<bool>()[tuple[i]])
+                    result[i >> 5] |= 1u << (i & 31);
+            }
+        *finals_.template Push<bool>() = decided;
+        return stateCount_++;
+    }
+
+    Stack<Allocator> regexes_;          //!< const RegexType*
+    SizeType regexCount_;
+    SizeType wordCount_;                //!< Number of uint32_t in a bit set of regexes
+    unsigned char asciiClasses_[128];
+    unsigned asciiClassCodepoints_[128];
+    SizeType asciiClassCount_;
+    Stack<Allocator> transitions_;      //!< Next state per ASCII class of each state (SizeType)
+    Stack<Allocator> tuples_;           //!< State of each regex of each state, kRegexInvalidState if decided (SizeType)
+    Stack<Allocator> founds_;           //!< Bit set of the regexes found before the end of each state (uint32_t)
+    Stack<Allocator> results_;          //!< Bit set of the regexes found if the string ends in each state (uint32_t)
+    Stack<Allocator> finals_;           //!< Whether all regexes are decided in each state (bool)
+    SizeType stateCount_;               //!< Zero if the product DFA is not available
+};
+
 typedef GenericRegex<UTF8<> > Regex;
 typedef GenericRegexSearch<Regex> RegexSearch;
+typedef GenericRegexSet<Regex> RegexSet;
 
 } // namespace internal
 RAPIDJSON_NAMESPACE_END
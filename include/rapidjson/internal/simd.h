@@ -0,0 +1,911 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_INTERNAL_SIMD_H_
+#define RAPIDJSON_INTERNAL_SIMD_H_
+
+#include "../rapidjson.h"
+
+// x86 SIMD kernels shared by reader.h and writer.h.
+//
+// Without RAPIDJSON_SIMD_DISPATCH only the kernels of the instruction set selected
+// by RAPIDJSON_SSE2/RAPIDJSON_SSE42/RAPIDJSON_AVX2/RAPIDJSON_AVX512 are compiled and
+// called directly. With RAPIDJSON_SIMD_DISPATCH every level is compiled (with
+// per-function target attributes on gcc/clang) and the best one supported by the
+// running CPU is selected once, on first use.
+
+#if defined(RAPIDJSON_SIMD_DISPATCH)
+#define RAPIDJSON_SIMD_KERNEL_SSE2
+#define RAPIDJSON_SIMD_KERNEL_SSE42
+#define RAPIDJSON_SIMD_KERNEL_AVX2
+#define RAPIDJSON_SIMD_KERNEL_AVX512
+#elif defined(RAPIDJSON_AVX512)
+#define RAPIDJSON_SIMD_KERNEL_AVX512
+#elif defined(RAPIDJSON_AVX2)
+#define RAPIDJSON_SIMD_KERNEL_AVX2
+#elif defined(RAPIDJSON_SSE42)
+#define RAPIDJSON_SIMD_KERNEL_SSE42
+#define RAPIDJSON_SIMD_KERNEL_SSE2  // string scanning is shared with SSE2
+#elif defined(RAPIDJSON_SSE2)
+#define RAPIDJSON_SIMD_KERNEL_SSE2
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+namespace internal {
+
+//! Character classes of a 64-byte block, bit i corresponds to byte i.
+struct SimdBlockMasks {
+    uint64_t whitespace;    //!< ' ', '\n', '\r', '\t'
+    uint64_t structural;    //!< '{', '}', '[', ']', ':', ','
+    uint64_t quote;         //!< '\"'
+    uint64_t backslash;     //!< '\\'
+    uint64_t nul;           //!< '\0'
+    uint64_t control;       //!< Characters below 0x20, including '\0' and whitespace other than ' '
+};
+
+//! Classify a 64-byte block one by one, for targets without SIMD kernels.
+/*! Only the bytes from \c begin up to the first '\0' are read, the others are left unclassified.
+*/
+inline void ClassifyBlock_Scalar(const char* p, unsigned begin, SimdBlockMasks& m) {
+    m.whitespace = m.structural = m.quote = m.backslash = m.nul = m.control = 0;
+    for (unsigned i = begin; i < 64; i++) {
+        const uint64_t bit = static_cast<uint64_t>(1) << i;
+        switch (p[i]) {
+            case ' ': case '\n': case '\r': case '\t': m.whitespace |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': m.structural |= bit; break;
+            case '\"': m.quote |= bit; break;
+            case '\\': m.backslash |= bit; break;
+            case '\0': m.nul |= bit; break;
+            default: break;
+        }
+        if (static_cast<unsigned char>(p[i]) < 0x20)
+            m.control |= bit;
+        if (p[i] == '\0')
+            break;
+    }
+}
+
+inline void ClassifyBlock_Scalar(const char* p, SimdBlockMasks& m) { ClassifyBlock_Scalar(p, 0, m); }
+
+#if RAPIDJSON_ENDIAN == RAPIDJSON_LITTLEENDIAN
+#define RAPIDJSON_SIMD_SWAR_DIGITS  // reader.h uses internal::SimdParseDigits8() below
+
+//! Count the leading decimal digits of 8 characters packed in a 64-bit integer, the first one in the lowest byte.
+inline unsigned SwarCountDigits(uint64_t w) {
+    // A byte is a digit if its high nibble is 3 both before and after adding 6
+    const uint64_t x = (w & RAPIDJSON_UINT64_C2(0xF0F0F0F0, 0xF0F0F0F0)) |
+        (((w + RAPIDJSON_UINT64_C2(0x06060606, 0x06060606)) & RAPIDJSON_UINT64_C2(0xF0F0F0F0, 0xF0F0F0F0)) >> 4);
+    const uint64_t y = x ^ RAPIDJSON_UINT64_C2(0x33333333, 0x33333333);
+    // High bit of each non-zero byte of y, which is a non-digit
+    const uint64_t z = (((y & RAPIDJSON_UINT64_C2(0x7F7F7F7F, 0x7F7F7F7F)) + RAPIDJSON_UINT64_C2(0x7F7F7F7F, 0x7F7F7F7F)) | y) &
+        RAPIDJSON_UINT64_C2(0x80808080, 0x80808080);
+    if (z == 0)
+        return 8;
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(z)) >> 3;
+#else
+    // The bytes below the first non-digit, plus one, summed in the highest byte
+    const uint64_t below = ((z & (0 - z)) - 1) & RAPIDJSON_UINT64_C2(0x01010101, 0x01010101);
+    return static_cast<unsigned>((below * RAPIDJSON_UINT64_C2(0x01010101, 0x01010101)) >> 56) - 1;
+#endif
+}
+
+//! Parse up to 8 decimal digits at once with SWAR (SIMD within a register).
+/*! As with the SIMD kernels, nothing is read across a page boundary, which may
+    follow the terminating '\0': near the end of a page, 0 is returned and the
+    caller takes the digits one by one.
+    \param p Characters, terminated by a non-digit.
+    \param value Value of the digits, 0 if there is none.
+    \return Number of digits, up to 8.
+*/
+inline unsigned SimdParseDigits8(const char* p, uint32_t* value) {
+    *value = 0;
+    if (RAPIDJSON_UNLIKELY((reinterpret_cast<size_t>(p) & 4095) > 4096 - 8))
+        return 0;
+    uint64_t w;
+    std::memcpy(&w, p, 8);
+    const unsigned n = SwarCountDigits(w);
+    if (n == 0)
+        return 0;
+
+    // Move the digits to the high bytes, the low ones become leading zeros, then combine 2, 4 and 8 digits
+    w = (w - RAPIDJSON_UINT64_C2(0x30303030, 0x30303030)) << ((8 - n) * 8);
+    w = (w * 10) + (w >> 8);
+    w = (((w & RAPIDJSON_UINT64_C2(0x000000FF, 0x000000FF)) * RAPIDJSON_UINT64_C2(0x000F4240, 0x00000064)) +
+         (((w >> 16) & RAPIDJSON_UINT64_C2(0x000000FF, 0x000000FF)) * RAPIDJSON_UINT64_C2(0x00002710, 0x00000001))) >> 32;
+    *value = static_cast<uint32_t>(w);
+    return n;
+}
+#endif // RAPIDJSON_ENDIAN == RAPIDJSON_LITTLEENDIAN
+
+} // namespace internal
+RAPIDJSON_NAMESPACE_END
+
+#if defined(RAPIDJSON_SIMD_KERNEL_SSE2) || defined(RAPIDJSON_SIMD_KERNEL_AVX512) || defined(RAPIDJSON_SIMD_KERNEL_AVX2)
+#define RAPIDJSON_SIMD_X86  // reader.h and writer.h use internal::Simd*() below
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#pragma intrinsic(_BitScanForward)
+#endif
+#if defined(RAPIDJSON_SIMD_DISPATCH) || defined(RAPIDJSON_AVX512) || defined(RAPIDJSON_AVX2)
+#include <immintrin.h>
+#elif defined(RAPIDJSON_SSE42)
+#include <nmmintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+#if defined(RAPIDJSON_SIMD_DISPATCH) && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+//!@cond RAPIDJSON_HIDDEN_FROM_DOXYGEN
+#if defined(RAPIDJSON_SIMD_DISPATCH) && defined(__GNUC__)
+#define RAPIDJSON_SIMD_TARGET(x) __attribute__((target(x)))
+#else
+#define RAPIDJSON_SIMD_TARGET(x)
+#endif
+//!@endcond
+
+RAPIDJSON_NAMESPACE_BEGIN
+namespace internal {
+
+inline unsigned SimdCountTrailingZeros(uint32_t r) {
+    RAPIDJSON_ASSERT(r != 0);
+#ifdef _MSC_VER
+    unsigned long offset;
+    _BitScanForward(&offset, r);
+    return static_cast<unsigned>(offset);
+#else
+    return static_cast<unsigned>(__builtin_ctz(r));
+#endif
+}
+
+inline unsigned SimdCountTrailingZeros64(uint64_t r) {
+    RAPIDJSON_ASSERT(r != 0);
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long offset;
+    _BitScanForward64(&offset, r);
+    return static_cast<unsigned>(offset);
+#elif defined(_MSC_VER)
+    const uint32_t low = static_cast<uint32_t>(r);
+    return low != 0 ? SimdCountTrailingZeros(low) : 32 + SimdCountTrailingZeros(static_cast<uint32_t>(r >> 32));
+#else
+    return static_cast<unsigned>(__builtin_ctzll(r));
+#endif
+}
+
+inline bool SimdIsWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+//! Whether a character stops the scan of an unescaped string: '\"', '\\' or a control character.
+inline bool SimdIsStringStop(char c) {
+    return c == '\"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+// The unbounded kernels work on null-terminated text. They scan one by one until
+// alignment and then use aligned loads only, because an unaligned load may cross
+// a page boundary after '\0' and cause crash. The bounded kernels never read past
+// end and finish the tail one by one.
+
+///////////////////////////////////////////////////////////////////////////////
+// Scalar (only used by dispatch on CPUs without SSE2)
+
+#ifdef RAPIDJSON_SIMD_DISPATCH
+inline const char* SkipWhitespace_Scalar(const char* p) {
+    while (SimdIsWhitespace(*p))
+        ++p;
+    return p;
+}
+
+inline const char* SkipWhitespace_Scalar(const char* p, const char* end) {
+    while (p != end && SimdIsWhitespace(*p))
+        ++p;
+    return p;
+}
+
+inline const char* ScanUnescapedString_Scalar(const char* p) {
+    while (!SimdIsStringStop(*p))
+        ++p;
+    return p;
+}
+
+inline const char* ScanUnescapedString_Scalar(const char* p, const char* end) {
+    while (p != end && !SimdIsStringStop(*p))
+        ++p;
+    return p;
+}
+#endif // RAPIDJSON_SIMD_DISPATCH
+
+///////////////////////////////////////////////////////////////////////////////
+// SSE2
+
+#ifdef RAPIDJSON_SIMD_KERNEL_SSE2
+//! Skip whitespace with SSE2 instructions, testing 16 8-byte characters at once.
+RAPIDJSON_SIMD_TARGET("sse2")
+inline const char* SkipWhitespace_SSE2(const char* p) {
+    // Fast return for single non-whitespace
+    if (SimdIsWhitespace(*p))
+        ++p;
+    else
+        return p;
+
+    // 16-byte align to the next boundary
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
+    while (p != nextAligned)
+        if (SimdIsWhitespace(*p))
+            ++p;
+        else
+            return p;
+
+    // The rest of string
+    const __m128i w0 = _mm_set1_epi8(' ');
+    const __m128i w1 = _mm_set1_epi8('\n');
+    const __m128i w2 = _mm_set1_epi8('\r');
+    const __m128i w3 = _mm_set1_epi8('\t');
+
+    for (;; p += 16) {
+        const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i x = _mm_cmpeq_epi8(s, w0);
+        x = _mm_or_si128(x, _mm_cmpeq_epi8(s, w1));
+        x = _mm_or_si128(x, _mm_cmpeq_epi8(s, w2));
+        x = _mm_or_si128(x, _mm_cmpeq_epi8(s, w3));
+        unsigned short r = static_cast<unsigned short>(~_mm_movemask_epi8(x));
+        if (r != 0)     // some of characters may be non-whitespace
+            return p + SimdCountTrailingZeros(r);
+    }
+}
+
+RAPIDJSON_SIMD_TARGET("sse2")
+inline const char* SkipWhitespace_SSE2(const char* p, const char* end) {
+    // Fast return for single non-whitespace
+    if (p != end && SimdIsWhitespace(*p))
+        ++p;
+    else
+        return p;
+
+    const __m128i w0 = _mm_set1_epi8(' ');
+    const __m128i w1 = _mm_set1_epi8('\n');
+    const __m128i w2 = _mm_set1_epi8('\r');
+    const __m128i w3 = _mm_set1_epi8('\t');
+
+    for (; end - p >= 16; p += 16) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i x = _mm_cmpeq_epi8(s, w0);
+        x = _mm_or_si128(x, _mm_cmpeq_epi8(s, w1));
+        x = _mm_or_si128(x, _mm_cmpeq_epi8(s, w2));
+        x = _mm_or_si128(x, _mm_cmpeq_epi8(s, w3));
+        unsigned short r = static_cast<unsigned short>(~_mm_movemask_epi8(x));
+        if (r != 0)     // some of characters may be non-whitespace
+            return p + SimdCountTrailingZeros(r);
+    }
+
+    while (p != end && SimdIsWhitespace(*p))
+        ++p;
+    return p;
+}
+
+//! Find the first '\"', '\\' or control character with SSE2 instructions, 16 characters at once.
+RAPIDJSON_SIMD_TARGET("sse2")
+inline const char* ScanUnescapedString_SSE2(const char* p) {
+    // Scan one by one until alignment (unaligned load may cross page boundary and cause crash)
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
+    for (; p != nextAligned; ++p)
+        if (RAPIDJSON_UNLIKELY(SimdIsStringStop(*p)))
+            return p;
+
+    // The rest of string using SIMD
+    const __m128i dq = _mm_set1_epi8('\"');
+    const __m128i bs = _mm_set1_epi8('\\');
+    const __m128i sp = _mm_set1_epi8(0x1F);
+
+    for (;; p += 16) {
+        const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i t1 = _mm_cmpeq_epi8(s, dq);
+        const __m128i t2 = _mm_cmpeq_epi8(s, bs);
+        const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
+        const __m128i x = _mm_or_si128(_mm_or_si128(t1, t2), t3);
+        unsigned short r = static_cast<unsigned short>(_mm_movemask_epi8(x));
+        if (RAPIDJSON_UNLIKELY(r != 0))     // some of characters is escaped
+            return p + SimdCountTrailingZeros(r);
+    }
+}
+
+RAPIDJSON_SIMD_TARGET("sse2")
+inline const char* ScanUnescapedString_SSE2(const char* p, const char* end) {
+    const __m128i dq = _mm_set1_epi8('\"');
+    const __m128i bs = _mm_set1_epi8('\\');
+    const __m128i sp = _mm_set1_epi8(0x1F);
+
+    for (; end - p >= 16; p += 16) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i t1 = _mm_cmpeq_epi8(s, dq);
+        const __m128i t2 = _mm_cmpeq_epi8(s, bs);
+        const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
+        const __m128i x = _mm_or_si128(_mm_or_si128(t1, t2), t3);
+        unsigned short r = static_cast<unsigned short>(_mm_movemask_epi8(x));
+        if (RAPIDJSON_UNLIKELY(r != 0))     // some of characters is escaped
+            return p + SimdCountTrailingZeros(r);
+    }
+
+    while (p != end && !SimdIsStringStop(*p))
+        ++p;
+    return p;
+}
+//! Classify a 64-byte aligned block with SSE2 instructions.
+RAPIDJSON_SIMD_TARGET("sse2")
+inline void ClassifyBlock_SSE2(const char* p, SimdBlockMasks& m) {
+    const __m128i w0 = _mm_set1_epi8(' ');
+    const __m128i w1 = _mm_set1_epi8('\n');
+    const __m128i w2 = _mm_set1_epi8('\r');
+    const __m128i w3 = _mm_set1_epi8('\t');
+    const __m128i lower = _mm_set1_epi8(0x20);  // '[' | 0x20 == '{', ']' | 0x20 == '}'
+    const __m128i ob = _mm_set1_epi8('{');
+    const __m128i cb = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i dq = _mm_set1_epi8('\"');
+    const __m128i bs = _mm_set1_epi8('\\');
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c1f = _mm_set1_epi8(0x1F);    // max(s, 0x1F) == 0x1F iff s < 0x20
+
+    m.whitespace = m.structural = m.quote = m.backslash = m.nul = m.control = 0;
+    for (unsigned i = 0; i < 64; i += 16) {
+        const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p + i));
+        const __m128i l = _mm_or_si128(s, lower);
+        __m128i w = _mm_or_si128(_mm_cmpeq_epi8(s, w0), _mm_cmpeq_epi8(s, w1));
+        w = _mm_or_si128(w, _mm_or_si128(_mm_cmpeq_epi8(s, w2), _mm_cmpeq_epi8(s, w3)));
+        __m128i st = _mm_or_si128(_mm_cmpeq_epi8(l, ob), _mm_cmpeq_epi8(l, cb));
+        st = _mm_or_si128(st, _mm_or_si128(_mm_cmpeq_epi8(s, colon), _mm_cmpeq_epi8(s, comma)));
+        m.whitespace |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(w))) << i;
+        m.structural |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(st))) << i;
+        m.quote |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(s, dq)))) << i;
+        m.backslash |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(s, bs)))) << i;
+        m.nul |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(s, zero)))) << i;
+        m.control |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(s, c1f), c1f)))) << i;
+    }
+}
+#endif // RAPIDJSON_SIMD_KERNEL_SSE2
+
+///////////////////////////////////////////////////////////////////////////////
+// SSE4.2
+
+#ifdef RAPIDJSON_SIMD_KERNEL_SSE42
+//! Skip whitespace with SSE 4.2 pcmpistrm instruction, testing 16 8-byte characters at once.
+RAPIDJSON_SIMD_TARGET("sse4.2")
+inline const char* SkipWhitespace_SSE42(const char* p) {
+    // Fast return for single non-whitespace
+    if (SimdIsWhitespace(*p))
+        ++p;
+    else
+        return p;
+
+    // 16-byte align to the next boundary
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
+    while (p != nextAligned)
+        if (SimdIsWhitespace(*p))
+            ++p;
+        else
+            return p;
+
+    // The rest of string using SIMD
+    static const char whitespace[16] = " \n\r\t";
+    const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespace[0]));
+
+    for (;; p += 16) {
+        const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
+        const int r = _mm_cmpistri(w, s, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT | _SIDD_NEGATIVE_POLARITY);
+        if (r != 16)    // some of characters is non-whitespace
+            return p + r;
+    }
+}
+
+RAPIDJSON_SIMD_TARGET("sse4.2")
+inline const char* SkipWhitespace_SSE42(const char* p, const char* end) {
+    // Fast return for single non-whitespace
+    if (p != end && SimdIsWhitespace(*p))
+        ++p;
+    else
+        return p;
+
+    // The middle of string using SIMD
+    static const char whitespace[16] = " \n\r\t";
+    const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespace[0]));
+
+    for (; end - p >= 16; p += 16) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const int r = _mm_cmpistri(w, s, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT | _SIDD_NEGATIVE_POLARITY);
+        if (r != 16)    // some of characters is non-whitespace
+            return p + r;
+    }
+
+    while (p != end && SimdIsWhitespace(*p))
+        ++p;
+    return p;
+}
+#endif // RAPIDJSON_SIMD_KERNEL_SSE42
+
+///////////////////////////////////////////////////////////////////////////////
+// AVX2
+
+#ifdef RAPIDJSON_SIMD_KERNEL_AVX2
+//! Skip whitespace with AVX2 instructions, testing 32 8-byte characters at once.
+RAPIDJSON_SIMD_TARGET("avx2")
+inline const char* SkipWhitespace_AVX2(const char* p) {
+    // Fast return for single non-whitespace
+    if (SimdIsWhitespace(*p))
+        ++p;
+    else
+        return p;
+
+    // 32-byte align to the next boundary
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 31) & static_cast<size_t>(~31));
+    while (p != nextAligned)
+        if (SimdIsWhitespace(*p))
+            ++p;
+        else
+            return p;
+
+    // The rest of string using SIMD
+    const __m256i w0 = _mm256_set1_epi8(' ');
+    const __m256i w1 = _mm256_set1_epi8('\n');
+    const __m256i w2 = _mm256_set1_epi8('\r');
+    const __m256i w3 = _mm256_set1_epi8('\t');
+
+    for (;; p += 32) {
+        const __m256i s = _mm256_load_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i x = _mm256_cmpeq_epi8(s, w0);
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w1));
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w2));
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w3));
+        uint32_t r = ~static_cast<uint32_t>(_mm256_movemask_epi8(x));
+        if (r != 0)     // some of characters is non-whitespace
+            return p + SimdCountTrailingZeros(r);
+    }
+}
+
+RAPIDJSON_SIMD_TARGET("avx2")
+inline const char* SkipWhitespace_AVX2(const char* p, const char* end) {
+    // Fast return for single non-whitespace
+    if (p != end && SimdIsWhitespace(*p))
+        ++p;
+    else
+        return p;
+
+    // The middle of string using SIMD
+    const __m256i w0 = _mm256_set1_epi8(' ');
+    const __m256i w1 = _mm256_set1_epi8('\n');
+    const __m256i w2 = _mm256_set1_epi8('\r');
+    const __m256i w3 = _mm256_set1_epi8('\t');
+
+    for (; end - p >= 32; p += 32) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i x = _mm256_cmpeq_epi8(s, w0);
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w1));
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w2));
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w3));
+        uint32_t r = ~static_cast<uint32_t>(_mm256_movemask_epi8(x));
+        if (r != 0)     // some of characters is non-whitespace
+            return p + SimdCountTrailingZeros(r);
+    }
+
+    while (p != end && SimdIsWhitespace(*p))
+        ++p;
+    return p;
+}
+
+//! Find the first '\"', '\\' or control character with AVX2 instructions, 32 characters at once.
+RAPIDJSON_SIMD_TARGET("avx2")
+inline const char* ScanUnescapedString_AVX2(const char* p) {
+    // Scan one by one until alignment (unaligned load may cross page boundary and cause crash)
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 31) & static_cast<size_t>(~31));
+    for (; p != nextAligned; ++p)
+        if (RAPIDJSON_UNLIKELY(SimdIsStringStop(*p)))
+            return p;
+
+    // The rest of string using SIMD
+    const __m256i dq = _mm256_set1_epi8('\"');
+    const __m256i bs = _mm256_set1_epi8('\\');
+    const __m256i sp = _mm256_set1_epi8(0x1F);
+
+    for (;; p += 32) {
+        const __m256i s = _mm256_load_si256(reinterpret_cast<const __m256i *>(p));
+        const __m256i t1 = _mm256_cmpeq_epi8(s, dq);
+        const __m256i t2 = _mm256_cmpeq_epi8(s, bs);
+        const __m256i t3 = _mm256_cmpeq_epi8(_mm256_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
+        const __m256i x = _mm256_or_si256(_mm256_or_si256(t1, t2), t3);
+        uint32_t r = static_cast<uint32_t>(_mm256_movemask_epi8(x));
+        if (RAPIDJSON_UNLIKELY(r != 0))     // some of characters is escaped
+            return p + SimdCountTrailingZeros(r);
+    }
+}
+
+RAPIDJSON_SIMD_TARGET("avx2")
+inline const char* ScanUnescapedString_AVX2(const char* p, const char* end) {
+    const __m256i dq = _mm256_set1_epi8('\"');
+    const __m256i bs = _mm256_set1_epi8('\\');
+    const __m256i sp = _mm256_set1_epi8(0x1F);
+
+    for (; end - p >= 32; p += 32) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        const __m256i t1 = _mm256_cmpeq_epi8(s, dq);
+        const __m256i t2 = _mm256_cmpeq_epi8(s, bs);
+        const __m256i t3 = _mm256_cmpeq_epi8(_mm256_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
+        const __m256i x = _mm256_or_si256(_mm256_or_si256(t1, t2), t3);
+        uint32_t r = static_cast<uint32_t>(_mm256_movemask_epi8(x));
+        if (RAPIDJSON_UNLIKELY(r != 0))     // some of characters is escaped
+            return p + SimdCountTrailingZeros(r);
+    }
+
+    while (p != end && !SimdIsStringStop(*p))
+        ++p;
+    return p;
+}
+//! Classify a 64-byte aligned block with AVX2 instructions.
+/*! Whitespace and structural characters are found by looking up both nibbles
+    of every character in small tables, then intersecting the results.
+*/
+RAPIDJSON_SIMD_TARGET("avx2")
+inline void ClassifyBlock_AVX2(const char* p, SimdBlockMasks& m) {
+    // Bits 0-2 for structural characters, 3-4 for whitespace
+    const __m256i lowTable = _mm256_setr_epi8(
+        16, 0, 0, 0, 0, 0, 0, 0, 0, 8, 12, 1, 2, 9, 0, 0,
+        16, 0, 0, 0, 0, 0, 0, 0, 0, 8, 12, 1, 2, 9, 0, 0);
+    const __m256i highTable = _mm256_setr_epi8(
+        8, 0, 18, 4, 0, 1, 0, 1, 0, 0, 0, 3, 2, 1, 0, 0,
+        8, 0, 18, 4, 0, 1, 0, 1, 0, 0, 0, 3, 2, 1, 0, 0);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i structuralBits = _mm256_set1_epi8(0x07);
+    const __m256i whitespaceBits = _mm256_set1_epi8(0x18);
+    const __m256i dq = _mm256_set1_epi8('\"');
+    const __m256i bs = _mm256_set1_epi8('\\');
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i c1f = _mm256_set1_epi8(0x1F);  // max(s, 0x1F) == 0x1F iff s < 0x20
+
+    m.whitespace = m.structural = m.quote = m.backslash = m.nul = m.control = 0;
+    for (unsigned i = 0; i < 64; i += 32) {
+        const __m256i s = _mm256_load_si256(reinterpret_cast<const __m256i *>(p + i));
+        const __m256i v = _mm256_and_si256(_mm256_shuffle_epi8(lowTable, s),    // zero for characters >= 0x80
+                                           _mm256_shuffle_epi8(highTable, _mm256_and_si256(_mm256_srli_epi16(s, 4), nibble)));
+        const __m256i st = _mm256_cmpeq_epi8(_mm256_and_si256(v, structuralBits), zero);
+        const __m256i w = _mm256_cmpeq_epi8(_mm256_and_si256(v, whitespaceBits), zero);
+        m.whitespace |= static_cast<uint64_t>(~static_cast<uint32_t>(_mm256_movemask_epi8(w))) << i;
+        m.structural |= static_cast<uint64_t>(~static_cast<uint32_t>(_mm256_movemask_epi8(st))) << i;
+        m.quote |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(s, dq)))) << i;
+        m.backslash |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(s, bs)))) << i;
+        m.nul |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(s, zero)))) << i;
+        m.control |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(s, c1f), c1f)))) << i;
+    }
+}
+#endif // RAPIDJSON_SIMD_KERNEL_AVX2
+
+///////////////////////////////////////////////////////////////////////////////
+// AVX-512 (requires AVX-512BW for byte comparisons)
+
+#ifdef RAPIDJSON_SIMD_KERNEL_AVX512
+//! Skip whitespace with AVX-512BW instructions, testing 64 8-byte characters at once.
+RAPIDJSON_SIMD_TARGET("avx512f,avx512bw")
+inline const char* SkipWhitespace_AVX512(const char* p) {
+    // Fast return for single non-whitespace
+    if (SimdIsWhitespace(*p))
+        ++p;
+    else
+        return p;
+
+    // 64-byte align to the next boundary
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 63) & static_cast<size_t>(~63));
+    while (p != nextAligned)
+        if (SimdIsWhitespace(*p))
+            ++p;
+        else
+            return p;
+
+    // The rest of string using SIMD
+    const __m512i w0 = _mm512_set1_epi8(' ');
+    const __m512i w1 = _mm512_set1_epi8('\n');
+    const __m512i w2 = _mm512_set1_epi8('\r');
+    const __m512i w3 = _mm512_set1_epi8('\t');
+
+    for (;; p += 64) {
+        const __m512i s = _mm512_load_si512(reinterpret_cast<const void *>(p));
+        const uint64_t r = ~static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(s, w0) | _mm512_cmpeq_epi8_mask(s, w1)
+                                                | _mm512_cmpeq_epi8_mask(s, w2) | _mm512_cmpeq_epi8_mask(s, w3));
+        if (r != 0)     // some of characters is non-whitespace
+            return p + SimdCountTrailingZeros64(r);
+    }
+}
+
+RAPIDJSON_SIMD_TARGET("avx512f,avx512bw")
+inline const char* SkipWhitespace_AVX512(const char* p, const char* end) {
+    // Fast return for single non-whitespace
+    if (p != end && SimdIsWhitespace(*p))
+        ++p;
+    else
+        return p;
+
+    // The middle of string using SIMD
+    const __m512i w0 = _mm512_set1_epi8(' ');
+    const __m512i w1 = _mm512_set1_epi8('\n');
+    const __m512i w2 = _mm512_set1_epi8('\r');
+    const __m512i w3 = _mm512_set1_epi8('\t');
+
+    for (; end - p >= 64; p += 64) {
+        const __m512i s = _mm512_loadu_si512(reinterpret_cast<const void *>(p));
+        const uint64_t r = ~static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(s, w0) | _mm512_cmpeq_epi8_mask(s, w1)
+                                                | _mm512_cmpeq_epi8_mask(s, w2) | _mm512_cmpeq_epi8_mask(s, w3));
+        if (r != 0)     // some of characters is non-whitespace
+            return p + SimdCountTrailingZeros64(r);
+    }
+
+    while (p != end && SimdIsWhitespace(*p))
+        ++p;
+    return p;
+}
+
+//! Find the first '\"', '\\' or control character with AVX-512BW instructions, 64 characters at once.
+RAPIDJSON_SIMD_TARGET("avx512f,avx512bw")
+inline const char* ScanUnescapedString_AVX512(const char* p) {
+    // Scan one by one until alignment (unaligned load may cross page boundary and cause crash)
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 63) & static_cast<size_t>(~63));
+    for (; p != nextAligned; ++p)
+        if (RAPIDJSON_UNLIKELY(SimdIsStringStop(*p)))
+            return p;
+
+    // The rest of string using SIMD
+    const __m512i dq = _mm512_set1_epi8('\"');
+    const __m512i bs = _mm512_set1_epi8('\\');
+    const __m512i sp = _mm512_set1_epi8(0x20);
+
+    for (;; p += 64) {
+        const __m512i s = _mm512_load_si512(reinterpret_cast<const void *>(p));
+        const uint64_t r = static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(s, dq) | _mm512_cmpeq_epi8_mask(s, bs) | _mm512_cmplt_epu8_mask(s, sp));
+        if (RAPIDJSON_UNLIKELY(r != 0))     // some of characters is escaped
+            return p + SimdCountTrailingZeros64(r);
+    }
+}
+
+RAPIDJSON_SIMD_TARGET("avx512f,avx512bw")
+inline const char* ScanUnescapedString_AVX512(const char* p, const char* end) {
+    const __m512i dq = _mm512_set1_epi8('\"');
+    const __m512i bs = _mm512_set1_epi8('\\');
+    const __m512i sp = _mm512_set1_epi8(0x20);
+
+    for (; end - p >= 64; p += 64) {
+        const __m512i s = _mm512_loadu_si512(reinterpret_cast<const void *>(p));
+        const uint64_t r = static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(s, dq) | _mm512_cmpeq_epi8_mask(s, bs) | _mm512_cmplt_epu8_mask(s, sp));
+        if (RAPIDJSON_UNLIKELY(r != 0))     // some of characters is escaped
+            return p + SimdCountTrailingZeros64(r);
+    }
+
+    while (p != end && !SimdIsStringStop(*p))
+        ++p;
+    return p;
+}
+//! Classify a 64-byte aligned block with AVX-512BW instructions.
+RAPIDJSON_SIMD_TARGET("avx512f,avx512bw")
+inline void ClassifyBlock_AVX512(const char* p, SimdBlockMasks& m) {
+    const __m512i s = _mm512_load_si512(reinterpret_cast<const void *>(p));
+    const __m512i l = _mm512_or_si512(s, _mm512_set1_epi8(0x20));  // '[' | 0x20 == '{', ']' | 0x20 == '}'
+    m.whitespace = static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8(' ')) | _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\n'))
+                                       | _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\r')) | _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\t')));
+    m.structural = static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(l, _mm512_set1_epi8('{')) | _mm512_cmpeq_epi8_mask(l, _mm512_set1_epi8('}'))
+                                       | _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8(':')) | _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8(',')));
+    m.quote = static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\"')));
+    m.backslash = static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\\')));
+    m.nul = static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(s, _mm512_setzero_si512()));
+    m.control = static_cast<uint64_t>(_mm512_cmplt_epu8_mask(s, _mm512_set1_epi8(0x20)));
+}
+#endif // RAPIDJSON_SIMD_KERNEL_AVX512
+
+} // namespace internal
+
+#ifdef RAPIDJSON_SIMD_DISPATCH
+///////////////////////////////////////////////////////////////////////////////
+// Runtime dispatch
+
+//! Instruction set levels of the SIMD kernels, selectable with \ref RAPIDJSON_SIMD_DISPATCH.
+enum SimdLevel {
+    kSimdLevelNone = 0, //!< Plain C++ loops.
+    kSimdLevelSSE2,     //!< SSE2, 16 bytes per step.
+    kSimdLevelSSE42,    //!< SSE4.2, 16 bytes per step.
+    kSimdLevelAVX2,     //!< AVX2, 32 bytes per step.
+    kSimdLevelAVX512    //!< AVX-512BW, 64 bytes per step.
+};
+
+namespace internal {
+
+//! Query the highest SIMD level supported by both the CPU and the operating system.
+inline SimdLevel DetectSimdLevel() {
+    unsigned ecx1 = 0, edx1 = 0, ebx7 = 0, maxLeaf = 0;
+    uint64_t xcr0 = 0;
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    maxLeaf = static_cast<unsigned>(info[0]);
+    if (maxLeaf >= 1) {
+        __cpuid(info, 1);
+        ecx1 = static_cast<unsigned>(info[2]);
+        edx1 = static_cast<unsigned>(info[3]);
+    }
+    if (maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        ebx7 = static_cast<unsigned>(info[1]);
+    }
+    if (ecx1 & (1u << 27))  // OSXSAVE
+        xcr0 = static_cast<uint64_t>(_xgetbv(0));
+#else
+    unsigned eax, ebx, ecx, edx;
+    maxLeaf = static_cast<unsigned>(__get_cpuid_max(0, 0));
+    if (maxLeaf >= 1 && __get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        ecx1 = ecx;
+        edx1 = edx;
+    }
+    if (maxLeaf >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        ebx7 = ebx;
+    }
+    if (ecx1 & (1u << 27)) {    // OSXSAVE
+        unsigned xcr0Low, xcr0High;
+        __asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0)); // xgetbv
+        xcr0 = (static_cast<uint64_t>(xcr0High) << 32) | xcr0Low;
+    }
+#endif
+    const bool ymmState = (xcr0 & 0x6) == 0x6;     // XMM and YMM state enabled by the OS
+    const bool zmmState = (xcr0 & 0xE6) == 0xE6;   // ... and opmask, ZMM_Hi256, Hi16_ZMM state
+    if (zmmState && (ebx7 & (1u << 16)) && (ebx7 & (1u << 30)))  // AVX512F, AVX512BW
+        return kSimdLevelAVX512;
+    if (ymmState && (ecx1 & (1u << 28)) && (ebx7 & (1u << 5)))   // AVX, AVX2
+        return kSimdLevelAVX2;
+    if (ecx1 & (1u << 20))  // SSE4.2
+        return kSimdLevelSSE42;
+    if (edx1 & (1u << 26))  // SSE2
+        return kSimdLevelSSE2;
+    return kSimdLevelNone;
+}
+
+//! Table of the SIMD kernels in use.
+struct SimdKernels {
+    const char* (*skipWhitespace)(const char*);
+    const char* (*skipWhitespaceBounded)(const char*, const char*);
+    const char* (*scanUnescapedString)(const char*);
+    const char* (*scanUnescapedStringBounded)(const char*, const char*);
+    void (*classifyBlock)(const char*, SimdBlockMasks&);
+    SimdLevel level;
+    SimdLevel supported;
+
+    void Select(SimdLevel l) {
+        level = l;
+        switch (l) {
+        case kSimdLevelAVX512:
+            skipWhitespace = &SkipWhitespace_AVX512;
+            skipWhitespaceBounded = &SkipWhitespace_AVX512;
+            scanUnescapedString = &ScanUnescapedString_AVX512;
+            scanUnescapedStringBounded = &ScanUnescapedString_AVX512;
+            classifyBlock = &ClassifyBlock_AVX512;
+            break;
+        case kSimdLevelAVX2:
+            skipWhitespace = &SkipWhitespace_AVX2;
+            skipWhitespaceBounded = &SkipWhitespace_AVX2;
+            scanUnescapedString = &ScanUnescapedString_AVX2;
+            scanUnescapedStringBounded = &ScanUnescapedString_AVX2;
+            classifyBlock = &ClassifyBlock_AVX2;
+            break;
+        case kSimdLevelSSE42:
+            skipWhitespace = &SkipWhitespace_SSE42;
+            skipWhitespaceBounded = &SkipWhitespace_SSE42;
+            scanUnescapedString = &ScanUnescapedString_SSE2;
+            scanUnescapedStringBounded = &ScanUnescapedString_SSE2;
+            classifyBlock = &ClassifyBlock_SSE2;
+            break;
+        case kSimdLevelSSE2:
+            skipWhitespace = &SkipWhitespace_SSE2;
+            skipWhitespaceBounded = &SkipWhitespace_SSE2;
+            scanUnescapedString = &ScanUnescapedString_SSE2;
+            scanUnescapedStringBounded = &ScanUnescapedString_SSE2;
+            classifyBlock = &ClassifyBlock_SSE2;
+            break;
+        default:
+            RAPIDJSON_ASSERT(l == kSimdLevelNone);
+            skipWhitespace = &SkipWhitespace_Scalar;
+            skipWhitespaceBounded = &SkipWhitespace_Scalar;
+            scanUnescapedString = &ScanUnescapedString_Scalar;
+            scanUnescapedStringBounded = &ScanUnescapedString_Scalar;
+            classifyBlock = &ClassifyBlock_Scalar;
+            break;
+        }
+    }
+};
+
+inline SimdKernels CreateSimdKernels() {
+    SimdKernels kernels;
+    kernels.supported = DetectSimdLevel();
+    kernels.Select(kernels.supported);
+    return kernels;
+}
+
+//! The process-wide kernel table, initialized with the best supported level on first use.
+inline SimdKernels& GetSimdKernels() {
+    static SimdKernels kernels = CreateSimdKernels();
+    return kernels;
+}
+
+inline const char* SimdSkipWhitespace(const char* p) { return GetSimdKernels().skipWhitespace(p); }
+inline const char* SimdSkipWhitespace(const char* p, const char* end) { return GetSimdKernels().skipWhitespaceBounded(p, end); }
+inline const char* SimdScanUnescapedString(const char* p) { return GetSimdKernels().scanUnescapedString(p); }
+inline const char* SimdScanUnescapedString(const char* p, const char* end) { return GetSimdKernels().scanUnescapedStringBounded(p, end); }
+inline void SimdClassifyBlock(const char* p, SimdBlockMasks& m) { GetSimdKernels().classifyBlock(p, m); }
+
+} // namespace internal
+
+//! Get the SIMD level currently used by the parser and writer.
+inline SimdLevel GetSimdLevel() {
+    return internal::GetSimdKernels().level;
+}
+
+//! Get the highest SIMD level supported by the running CPU.
+inline SimdLevel GetSupportedSimdLevel() {
+    return internal::GetSimdKernels().supported;
+}
+
+//! Force the SIMD level used by the parser and writer, e.g. for benchmarking.
+/*! \param level Requested level. It is lowered to the highest supported level if necessary.
+    \return The level actually in use.
+    \note This is not thread-safe with concurrent parsing or writing.
+*/
+inline SimdLevel SetSimdLevel(SimdLevel level) {
+    internal::SimdKernels& kernels = internal::GetSimdKernels();
+    kernels.Select(level < kernels.supported ? level : kernels.supported);
+    return kernels.level;
+}
+
+#else // RAPIDJSON_SIMD_DISPATCH
+
+namespace internal {
+
+#if defined(RAPIDJSON_SIMD_KERNEL_AVX512)
+inline const char* SimdSkipWhitespace(const char* p) { return SkipWhitespace_AVX512(p); }
+inline const char* SimdSkipWhitespace(const char* p, const char* end) { return SkipWhitespace_AVX512(p, end); }
+inline const char* SimdScanUnescapedString(const char* p) { return ScanUnescapedString_AVX512(p); }
+inline const char* SimdScanUnescapedString(const char* p, const char* end) { return ScanUnescapedString_AVX512(p, end); }
+inline void SimdClassifyBlock(const char* p, SimdBlockMasks& m) { ClassifyBlock_AVX512(p, m); }
+#elif defined(RAPIDJSON_SIMD_KERNEL_AVX2)
+inline const char* SimdSkipWhitespace(const char* p) { return SkipWhitespace_AVX2(p); }
+inline const char* SimdSkipWhitespace(const char* p, const char* end) { return SkipWhitespace_AVX2(p, end); }
+inline const char* SimdScanUnescapedString(const char* p) { return ScanUnescapedString_AVX2(p); }
+inline const char* SimdScanUnescapedString(const char* p, const char* end) { return ScanUnescapedString_AVX2(p, end); }
+inline void SimdClassifyBlock(const char* p, SimdBlockMasks& m) { ClassifyBlock_AVX2(p, m); }
+#elif defined(RAPIDJSON_SIMD_KERNEL_SSE42)
+inline const char* SimdSkipWhitespace(const char* p) { return SkipWhitespace_SSE42(p); }
+inline const char* SimdSkipWhitespace(const char* p, const char* end) { return SkipWhitespace_SSE42(p, end); }
+inline const char* SimdScanUnescapedString(const char* p) { return ScanUnescapedString_SSE2(p); }
+inline const char* SimdScanUnescapedString(const char* p, const char* end) { return ScanUnescapedString_SSE2(p, end); }
+inline void SimdClassifyBlock(const char* p, SimdBlockMasks& m) { ClassifyBlock_SSE2(p, m); }
+#else
+inline const char* SimdSkipWhitespace(const char* p) { return SkipWhitespace_SSE2(p); }
+inline const char* SimdSkipWhitespace(const char* p, const char* end) { return SkipWhitespace_SSE2(p, end); }
+inline const char* SimdScanUnescapedString(const char* p) { return ScanUnescapedString_SSE2(p); }
+inline const char* SimdScanUnescapedString(const char* p, const char* end) { return ScanUnescapedString_SSE2(p, end); }
+inline void SimdClassifyBlock(const char* p, SimdBlockMasks& m) { ClassifyBlock_SSE2(p, m); }
+#endif
+
+} // namespace internal
+
+#endif // RAPIDJSON_SIMD_DISPATCH
+
+RAPIDJSON_NAMESPACE_END
+
+#endif // x86 SIMD kernels
+
+#endif // RAPIDJSON_INTERNAL_SIMD_H_
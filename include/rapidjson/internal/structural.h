@@ -0,0 +1,362 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_INTERNAL_STRUCTURAL_H_
+#define RAPIDJSON_INTERNAL_STRUCTURAL_H_
+
+#include "stack.h"
+#include "simd.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#if defined(RAPIDJSON_SIMD_X86) && defined(__PCLMUL__) && defined(__x86_64__)
+#define RAPIDJSON_STRUCTURAL_CLMUL
+#include <wmmintrin.h>
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+namespace internal {
+
+///////////////////////////////////////////////////////////////////////////////
+// Bit manipulation of 64-byte block masks
+
+inline unsigned CountTrailingZeros64(uint64_t x) {
+    RAPIDJSON_ASSERT(x != 0);
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long offset;
+    _BitScanForward64(&offset, x);
+    return static_cast<unsigned>(offset);
+#elif defined(_MSC_VER)
+    unsigned n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#else
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+}
+
+// Characters preceded by an odd number of backslashes. carry is 1 if the first one is.
+inline uint64_t FindEscaped(uint64_t backslash, uint64_t& carry) {
+    uint64_t escaped = carry;
+    carry = 0;
+    backslash &= ~escaped;  // an escaped backslash does not escape the next character
+    while (backslash) {
+        const unsigned i = CountTrailingZeros64(backslash);
+        if (i == 63) {
+            carry = 1;
+            break;
+        }
+        escaped |= static_cast<uint64_t>(2) << i;
+        backslash &= ~(static_cast<uint64_t>(3) << i);
+    }
+    return escaped;
+}
+
+inline uint64_t PrefixXor(uint64_t x) {
+#ifdef RAPIDJSON_STRUCTURAL_CLMUL
+    // Carry-less multiplication by all ones
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<int64_t>(x)), _mm_set1_epi8(-1), 0)));
+#else
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// StructuralIndex
+
+//! Index of the token positions in null-terminated UTF-8 text.
+/*! This is the first stage of parsing with \ref kParseStructuralIndexFlag.
+    The text is classified 64 bytes at a time and the index records where a
+    token begins:
+    - the structural characters <tt>{ } [ ] : ,</tt> outside strings,
+    - the opening and the closing quote of every string,
+    - the first character of every other run of non-whitespace characters
+      outside strings, i.e. numbers, literals and invalid text.
+
+    Unescaped quotes are paired with a prefix xor, so characters inside
+    strings never produce tokens. A closing quote is flagged if the string
+    contains a backslash or a control character, so the reader only needs to
+    decode such strings and can pass the others as they are.
+
+    The text is indexed in chunks ahead of the consumer, from 1 KiB growing to
+    64 KiB, which bounds the memory for large texts and avoids scanning far
+    beyond a root parsed with \ref kParseStopWhenDoneFlag. The entries live at
+    the bottom of the given stack, which may be used in LIFO manner by others
+    (e.g. for decoding strings) between the calls. The owner of the stack
+    is responsible for clearing it afterwards.
+
+    \note With SIMD, 64-byte aligned blocks are loaded, so bytes before the
+          text and after the terminating '\\0' may be read within the same
+          block. Such loads never cross a page boundary.
+*/
+template <typename Allocator>
+class StructuralIndex {
+public:
+    //! Offset of a token from the beginning of the text, shifted left by one. The lowest bit flags a closing quote of a string to be decoded.
+    typedef size_t Entry;
+
+    StructuralIndex(const char* text, Stack<Allocator>& stack) :
+        text_(text),
+        block_(reinterpret_cast<const char*>(reinterpret_cast<size_t>(text) & ~static_cast<size_t>(63))),
+        end_(0), stack_(stack), base_(stack.GetSize()), pos_(0), count_(0), chunkSize_(kInitialChunkSize),
+        inString_(0), escaped_(0), scalar_(0), dirty_(0)
+    {
+        RAPIDJSON_ASSERT(base_ % sizeof(Entry) == 0);
+    }
+
+    //! Position of the current token, or of the terminating '\\0' if there is none.
+    const char* Current() {
+        if (RAPIDJSON_UNLIKELY(pos_ >= count_) && !Fill(1))
+            return end_;
+        return text_ + (Entries()[pos_] >> 1);
+    }
+
+    //! Position of the token after the current one, or of the terminating '\\0' if there is none.
+    /*! This also guarantees that the current token is fully indexed, so
+        the text up to the returned position may be modified (in-situ parsing).
+    */
+    const char* Next() {
+        if (RAPIDJSON_UNLIKELY(pos_ + 1 >= count_) && !Fill(2))
+            return end_;
+        return text_ + (Entries()[pos_ + 1] >> 1);
+    }
+
+    //! Closing quote of the string at the current token, or the terminating '\\0' if it is unterminated.
+    /*! \param plain Set to true if the string contains neither backslashes nor control characters.
+        The string may be modified in place afterwards.
+    */
+    const char* StringEnd(bool& plain) {
+        if (RAPIDJSON_UNLIKELY(pos_ + 1 >= count_) && !Fill(2)) {
+            plain = false;
+            return end_;
+        }
+        const Entry e = Entries()[pos_ + 1];
+        plain = (e & 1) == 0;
+        return text_ + (e >> 1);
+    }
+
+    //! Move to the next token, or skip several.
+    void Advance(size_t n = 1) { pos_ += n; }
+
+    //! Replace the current token by a position which is not indexed, for reporting an error there.
+    void Replace(const char* p) {
+        const Entry e = static_cast<Entry>(p - text_) << 1;
+        if (pos_ >= count_) {
+            Fill(1);
+            if (pos_ >= count_) {
+                *stack_.template Push<Entry>() = e;
+                ++count_;
+                return;
+            }
+        }
+        Entries()[pos_] = e;
+    }
+
+private:
+    static const size_t kInitialChunkSize = 1024;
+    static const size_t kMaxChunkSize = 64 * 1024;
+
+    Entry* Entries() { return reinterpret_cast<Entry*>(stack_.template Bottom<char>() + base_); }
+
+    // Drop the consumed entries and index until at least n entries remain, or the text ends.
+    bool Fill(size_t n) {
+        RAPIDJSON_ASSERT(stack_.GetSize() == base_ + count_ * sizeof(Entry));
+        if (pos_ > 0) {
+            const size_t remain = count_ - (pos_ < count_ ? pos_ : count_);
+            std::memmove(Entries(), Entries() + (count_ - remain), remain * sizeof(Entry));
+            stack_.template Pop<Entry>(count_ - remain);
+            pos_ = 0;
+            count_ = remain;
+        }
+
+        while (count_ < n && !end_) {
+            IndexChunk();
+            if (chunkSize_ < kMaxChunkSize)
+                chunkSize_ *= 2;
+        }
+        return count_ >= n;
+    }
+
+    // Index chunkSize_ bytes, or until the terminating '\0'. The state is kept in
+    // locals so that it is not reloaded after every store of an entry.
+    void IndexChunk() {
+        const char* block = block_;
+        const char* const last = block_ + chunkSize_;
+        uint64_t inString = inString_;
+        uint64_t escaped = escaped_;
+        uint64_t scalar = scalar_;
+        Entry dirty = dirty_;
+        size_t count = count_;
+
+        do {
+            SimdBlockMasks m;
+#ifdef RAPIDJSON_SIMD_X86
+            SimdClassifyBlock(block, m);
+#else
+            // Reads nothing outside the text
+            ClassifyBlock_Scalar(block, block < text_ ? static_cast<unsigned>(text_ - block) : 0u, m);
+#endif
+
+            // Bytes before the text and from the terminating '\0' are treated as whitespace
+            uint64_t outside = 0;
+            if (RAPIDJSON_UNLIKELY(block < text_))
+                outside = (static_cast<uint64_t>(1) << static_cast<unsigned>(text_ - block)) - 1;
+            const uint64_t nul = m.nul & ~outside;
+            if (nul) {
+                const unsigned i = CountTrailingZeros64(nul);
+                end_ = block + i;
+                outside |= ~((static_cast<uint64_t>(1) << i) - 1);
+            }
+            const uint64_t whitespace = m.whitespace | outside;
+            const uint64_t structural = m.structural & ~outside;
+            uint64_t quote = m.quote & ~outside;
+            if (RAPIDJSON_UNLIKELY((m.backslash & ~outside) | escaped))
+                quote &= ~FindEscaped(m.backslash & ~outside, escaped);
+
+            // Bits are set from an opening quote until (not including) its closing quote
+            const uint64_t string = PrefixXor(quote) ^ inString;
+            inString = static_cast<uint64_t>(0) - (string >> 63);
+
+            const uint64_t other = ~(structural | whitespace | quote | string);
+            const uint64_t otherStart = other & ~((other << 1) | scalar);
+            scalar = other >> 63;
+
+            // Backslashes and control characters inside strings
+            uint64_t special = (m.backslash | m.control) & string & ~outside;
+
+            uint64_t tokens = (structural & ~string) | quote | otherStart;
+            if (tokens) {
+                stack_.template Reserve<Entry>(64);
+                Entry* out = stack_.template End<Entry>();
+                Entry* const begin = out;
+                const Entry offset = static_cast<Entry>(block - text_);   // wraps around before the text, which is fine
+                if (RAPIDJSON_LIKELY(!(special | dirty))) {
+                    do {
+                        *out++ = (offset + CountTrailingZeros64(tokens)) << 1;
+                        tokens &= tokens - 1;
+                    } while (tokens);
+                }
+                else {
+                    // Flag the closing quotes of the strings with special characters
+                    const uint64_t closing = quote & ~string;
+                    do {
+                        const unsigned i = CountTrailingZeros64(tokens);
+                        const uint64_t bit = static_cast<uint64_t>(1) << i;
+                        Entry e = (offset + i) << 1;
+                        if (closing & bit) {
+                            e |= dirty | static_cast<Entry>((special & (bit - 1)) != 0);
+                            special &= ~(bit - 1);
+                            dirty = 0;
+                        }
+                        *out++ = e;
+                        tokens &= tokens - 1;
+                    } while (tokens);
+                }
+                stack_.template PushUnsafe<Entry>(static_cast<size_t>(out - begin));
+                count += static_cast<size_t>(out - begin);
+            }
+            dirty |= static_cast<Entry>(special != 0);  // left in the string continuing into the next block
+            block += 64;
+        } while (block != last && !end_);
+
+        block_ = block;
+        inString_ = inString;
+        escaped_ = escaped;
+        scalar_ = scalar;
+        dirty_ = dirty;
+        count_ = count;
+    }
+
+    StructuralIndex(const StructuralIndex&);
+    StructuralIndex& operator=(const StructuralIndex&);
+
+    const char* text_;      //!< Beginning of the text.
+    const char* block_;     //!< Next 64-byte block to be indexed.
+    const char* end_;       //!< Terminating '\0', or null if not reached yet.
+    Stack<Allocator>& stack_;
+    size_t base_;           //!< Offset of the entries in the stack.
+    size_t pos_;            //!< Index of the current entry.
+    size_t count_;          //!< Number of entries.
+    size_t chunkSize_;      //!< Bytes to be indexed by the next Fill().
+    uint64_t inString_;     //!< All ones if the last block ended inside a string.
+    uint64_t escaped_;      //!< 1 if the first character of the next block is escaped.
+    uint64_t scalar_;       //!< 1 if the last block ended with a scalar character.
+    Entry dirty_;           //!< 1 if the string continuing into the next block contains special characters.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// SkipContainer
+
+//! Find the end of the object or array beginning at p in null-terminated UTF-8 text.
+/*! The text is classified 64 bytes at a time, as for StructuralIndex, and only
+    the brackets outside strings are counted. The content is not validated,
+    so a mismatched pair such as <tt>{ ]</tt> is not detected.
+    \param p Position of the opening '{' or '['.
+    \return Position after the matching closing bracket, or null if the text ends before it.
+*/
+inline const char* SkipContainer(const char* p) {
+    RAPIDJSON_ASSERT(*p == '{' || *p == '[');
+    const char* block = reinterpret_cast<const char*>(reinterpret_cast<size_t>(p) & ~static_cast<size_t>(63));
+    const unsigned begin = static_cast<unsigned>(p - block);
+    uint64_t outside = (static_cast<uint64_t>(1) << begin) - 1;  // bytes before p
+    uint64_t inString = 0;
+    uint64_t escaped = 0;
+    size_t depth = 0;
+
+    for (;; block += 64, outside = 0) {
+        SimdBlockMasks m;
+#ifdef RAPIDJSON_SIMD_X86
+        SimdClassifyBlock(block, m);
+#else
+        ClassifyBlock_Scalar(block, block < p ? begin : 0u, m);
+#endif
+
+        const uint64_t nul = m.nul & ~outside;
+        if (nul)
+            outside |= ~((static_cast<uint64_t>(1) << CountTrailingZeros64(nul)) - 1);
+
+        uint64_t quote = m.quote & ~outside;
+        if (RAPIDJSON_UNLIKELY((m.backslash & ~outside) | escaped))
+            quote &= ~FindEscaped(m.backslash & ~outside, escaped);
+        const uint64_t string = PrefixXor(quote) ^ inString;
+        inString = static_cast<uint64_t>(0) - (string >> 63);
+
+        for (uint64_t structural = m.structural & ~(string | outside); structural; structural &= structural - 1) {
+            const unsigned i = CountTrailingZeros64(structural);
+            const char c = block[i];
+            if (c == '{' || c == '[')
+                ++depth;
+            else if ((c == '}' || c == ']') && --depth == 0)
+                return block + i + 1;
+        }
+
+        if (nul)
+            return 0;
+    }
+}
+
+} // namespace internal
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_INTERNAL_STRUCTURAL_H_
@@ -0,0 +1,512 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_LAZYDOCUMENT_H_
+#define RAPIDJSON_LAZYDOCUMENT_H_
+
+/*! \file lazydocument.h
+    Read-only DOM which parses objects and arrays only when they are accessed.
+*/
+
+#include "document.h"
+#include "internal/structural.h"
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(padded)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+template <typename Encoding, typename Allocator, typename StackAllocator>
+class GenericLazyValue;
+
+template <typename Encoding, typename Allocator, typename StackAllocator>
+class GenericLazyDocument;
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericLazyMember
+
+//! Name-value pair in a lazy object.
+template <typename Encoding, typename Allocator, typename StackAllocator>
+struct GenericLazyMember {
+    GenericLazyMember() : name(), value() {}
+
+    GenericValue<Encoding, Allocator> name;                         //!< name of member (must be a string)
+    GenericLazyValue<Encoding, Allocator, StackAllocator> value;    //!< value of member.
+
+private:
+    GenericLazyMember(const GenericLazyMember&);
+    GenericLazyMember& operator=(const GenericLazyMember&);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericLazyValue
+
+//! Value in a GenericLazyDocument.
+/*! Numbers, strings, booleans and null are parsed with their parent, and hold
+    a GenericValue. An object or array only records its range in the source
+    text, which is found with internal::SkipContainer() without parsing the
+    content. It is parsed one level deep on the first access to its members
+    or elements, whose objects and arrays are again left unparsed.
+
+    A lazy value is read-only. Materialize() turns it into a GenericValue for
+    modification or writing.
+
+    \note Accessors of objects and arrays modify the value on first access,
+          so a lazy document must not be accessed by several threads at
+          the same time, even if it is const.
+*/
+template <typename Encoding, typename Allocator, typename StackAllocator>
+class GenericLazyValue {
+public:
+    typedef typename Encoding::Ch Ch;                                           //!< Character type derived from Encoding.
+    typedef GenericValue<Encoding, Allocator> ValueType;                        //!< Value type of scalars and member names.
+    typedef GenericLazyMember<Encoding, Allocator, StackAllocator> Member;      //!< Name-value pair in an object.
+    typedef GenericLazyDocument<Encoding, Allocator, StackAllocator> DocumentType;
+    typedef const Member* ConstMemberIterator;                                  //!< Member iterator for iterating in object.
+    typedef const GenericLazyValue* ConstValueIterator;                         //!< Value iterator for iterating in array.
+
+    //! Default constructor creates a null value.
+    GenericLazyValue() : value_(), begin_(), end_(), document_(), children_(), size_(), expanded_() {}
+
+    //! Destructor.
+    /*! The children of an expanded object or array are freed if Allocator needs it.
+    */
+    ~GenericLazyValue() { Reset(); }
+
+    //!@name Type
+    //@{
+
+    Type GetType() const { return begin_ ? (*begin_ == '{' ? kObjectType : kArrayType) : value_.GetType(); }
+    bool IsNull()   const { return !begin_ && value_.IsNull(); }
+    bool IsFalse()  const { return !begin_ && value_.IsFalse(); }
+    bool IsTrue()   const { return !begin_ && value_.IsTrue(); }
+    bool IsBool()   const { return !begin_ && value_.IsBool(); }
+    bool IsObject() const { return begin_ && *begin_ == '{'; }
+    bool IsArray()  const { return begin_ && *begin_ == '['; }
+    bool IsNumber() const { return !begin_ && value_.IsNumber(); }
+    bool IsInt()    const { return !begin_ && value_.IsInt(); }
+    bool IsUint()   const { return !begin_ && value_.IsUint(); }
+    bool IsInt64()  const { return !begin_ && value_.IsInt64(); }
+    bool IsUint64() const { return !begin_ && value_.IsUint64(); }
+    bool IsDouble() const { return !begin_ && value_.IsDouble(); }
+    bool IsString() const { return !begin_ && value_.IsString(); }
+
+    //! Whether an object or array has been parsed into its members or elements.
+    bool IsExpanded() const { return expanded_; }
+
+    //@}
+
+    //!@name Scalars
+    //@{
+
+    bool GetBool() const { RAPIDJSON_ASSERT(IsBool()); return value_.GetBool(); }
+    int GetInt() const { RAPIDJSON_ASSERT(IsInt()); return value_.GetInt(); }
+    unsigned GetUint() const { RAPIDJSON_ASSERT(IsUint()); return value_.GetUint(); }
+    int64_t GetInt64() const { RAPIDJSON_ASSERT(IsInt64()); return value_.GetInt64(); }
+    uint64_t GetUint64() const { RAPIDJSON_ASSERT(IsUint64()); return value_.GetUint64(); }
+    double GetDouble() const { RAPIDJSON_ASSERT(IsNumber()); return value_.GetDouble(); }
+    const Ch* GetString() const { RAPIDJSON_ASSERT(IsString()); return value_.GetString(); }
+    SizeType GetStringLength() const { RAPIDJSON_ASSERT(IsString()); return value_.GetStringLength(); }
+
+    //@}
+
+    //!@name Object
+    //@{
+
+    //! Get the number of members in the object.
+    SizeType MemberCount() const { RAPIDJSON_ASSERT(IsObject()); Expand(); return size_; }
+
+    //! Check whether the object is empty.
+    bool ObjectEmpty() const { return MemberCount() == 0; }
+
+    //! Const member iterator, expanding the object on first access.
+    ConstMemberIterator MemberBegin() const { RAPIDJSON_ASSERT(IsObject()); Expand(); return static_cast<const Member*>(children_); }
+
+    //! Const past-the-end member iterator, expanding the object on first access.
+    ConstMemberIterator MemberEnd() const { return MemberBegin() + size_; }
+
+    //! Find member by name.
+    /*! \param name Member name to be searched.
+        \return Iterator to member, if it exists. Otherwise returns \ref MemberEnd().
+        \note Linear time complexity.
+    */
+    ConstMemberIterator FindMember(const Ch* name) const {
+        RAPIDJSON_ASSERT(name != 0);
+        return FindMember(name, internal::StrLen(name));
+    }
+
+    //! Find member by name, given as a GenericValue string.
+    ConstMemberIterator FindMember(const ValueType& name) const {
+        RAPIDJSON_ASSERT(name.IsString());
+        return FindMember(name.GetString(), name.GetStringLength());
+    }
+
+    //! Find member by name and its length, which may contain null characters.
+    ConstMemberIterator FindMember(const Ch* name, SizeType length) const {
+        ConstMemberIterator member = MemberBegin();
+        for (const ConstMemberIterator end = MemberEnd(); member != end; ++member)
+            if (member->name.GetStringLength() == length &&
+                (member->name.GetString() == name || std::memcmp(member->name.GetString(), name, length * sizeof(Ch)) == 0))
+                break;
+        return member;
+    }
+
+    //! Check whether a member exists in the object.
+    bool HasMember(const Ch* name) const { return FindMember(name) != MemberEnd(); }
+
+    //! Get the value of a member, which must exist.
+    const GenericLazyValue& operator[](const Ch* name) const {
+        ConstMemberIterator member = FindMember(name);
+        RAPIDJSON_ASSERT(member != MemberEnd());
+        return member->value;
+    }
+
+    //@}
+
+    //!@name Array
+    //@{
+
+    //! Get the number of elements in the array.
+    SizeType Size() const { RAPIDJSON_ASSERT(IsArray()); Expand(); return size_; }
+
+    //! Check whether the array is empty.
+    bool Empty() const { return Size() == 0; }
+
+    //! Element iterator, expanding the array on first access.
+    ConstValueIterator Begin() const { RAPIDJSON_ASSERT(IsArray()); Expand(); return static_cast<const GenericLazyValue*>(children_); }
+
+    //! Past-the-end element iterator, expanding the array on first access.
+    ConstValueIterator End() const { return Begin() + size_; }
+
+    //! Get an element of the array.
+    const GenericLazyValue& operator[](SizeType index) const {
+        RAPIDJSON_ASSERT(index < Size());
+        return Begin()[index];
+    }
+
+    //@}
+
+    //! Parse the value, with all its descendants, into a GenericValue.
+    /*! Unlike the lazy accessors, this validates the whole object or array.
+        \param value Value to be set.
+        \param allocator Allocator for the content of \c value.
+        \return The result of parsing. The error offset is relative to the source text of the document.
+    */
+    ParseResult Materialize(ValueType& value, Allocator& allocator) const {
+        if (!begin_) {
+            value.CopyFrom(value_, allocator);
+            return ParseResult();
+        }
+        GenericDocument<Encoding, Allocator, StackAllocator> d(&allocator);
+        GenericStringStream<Encoding> s(begin_);
+        d.template ParseStream<kParseStopWhenDoneFlag>(s);
+        if (d.HasParseError())
+            return ParseResult(d.GetParseError(), static_cast<size_t>(begin_ - document_->source_) + d.GetErrorOffset());
+        value.Swap(d);
+        return ParseResult();
+    }
+
+private:
+    friend class GenericLazyDocument<Encoding, Allocator, StackAllocator>;
+
+    GenericLazyValue(const GenericLazyValue&);
+    GenericLazyValue& operator=(const GenericLazyValue&);
+
+    void Expand() const {
+        if (!expanded_)
+            document_->Expand(*const_cast<GenericLazyValue*>(this));
+    }
+
+    void Reset() {
+        if (Allocator::kNeedFree && children_) {
+            if (IsObject())
+                for (Member* m = static_cast<Member*>(children_), *end = m + size_; m != end; ++m)
+                    m->~Member();
+            else
+                for (GenericLazyValue* v = static_cast<GenericLazyValue*>(children_), *end = v + size_; v != end; ++v)
+                    v->~GenericLazyValue();
+            Allocator::Free(children_);
+        }
+        value_.SetNull();
+        begin_ = end_ = 0;
+        document_ = 0;
+        children_ = 0;
+        size_ = 0;
+        expanded_ = false;
+    }
+
+    ValueType value_;           //!< Number, string, boolean or null.
+    const Ch* begin_;           //!< Opening bracket of an object or array, or null.
+    const Ch* end_;             //!< Position after the closing bracket.
+    DocumentType* document_;    //!< Document, which parses an object or array.
+    void* children_;            //!< Array of Member or GenericLazyValue after expansion.
+    SizeType size_;             //!< Number of members or elements after expansion.
+    bool expanded_;             //!< Whether the members or elements have been parsed.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericLazyDocument
+
+//! Lazy DOM of a null-terminated UTF-8 text, parsing objects and arrays on first access.
+/*! Parse() finds the end of the root with internal::SkipContainer(), which
+    only pairs the brackets. So it is fast, and the objects and arrays
+    that are never accessed are neither parsed nor allocated. Such a lazy
+    document suits reading a few fields from a large text.
+
+    The text is not copied, so it must outlive the document. Strings are
+    copied into the allocator when their parent is parsed.
+
+    Errors in an object or array are found when it is expanded. The object
+    or array is then empty, and the first such error is reported by
+    GetParseError() of the document. Only standard JSON is supported, as
+    with \ref kParseDefaultFlags.
+
+    \tparam Encoding UTF-8 encoding of the text and of the values.
+    \tparam Allocator Allocator for the values.
+    \tparam StackAllocator Allocator for the stack of the parser.
+*/
+template <typename Encoding, typename Allocator = MemoryPoolAllocator<>, typename StackAllocator = CrtAllocator>
+class GenericLazyDocument : public GenericLazyValue<Encoding, Allocator, StackAllocator> {
+public:
+    typedef typename Encoding::Ch Ch;                                           //!< Character type derived from Encoding.
+    typedef GenericLazyValue<Encoding, Allocator, StackAllocator> LazyValueType; //!< Value type of the document.
+    typedef GenericValue<Encoding, Allocator> ValueType;                        //!< Value type of scalars and member names.
+    typedef Allocator AllocatorType;                                            //!< Allocator type from template parameter.
+
+    //! Constructor
+    /*! \param allocator        Optional allocator for allocating memory.
+        \param stackAllocator   Optional allocator for allocating memory for stack.
+    */
+    GenericLazyDocument(Allocator* allocator = 0, StackAllocator* stackAllocator = 0) :
+        allocator_(allocator), ownAllocator_(0), stack_(stackAllocator, kDefaultStackCapacity), reader_(stackAllocator), source_(), parseResult_()
+    {
+        RAPIDJSON_STATIC_ASSERT(sizeof(Ch) == 1);
+        if (!allocator_)
+            ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator)();
+    }
+
+    ~GenericLazyDocument() {
+        LazyValueType::Reset();
+        RAPIDJSON_DELETE(ownAllocator_);
+    }
+
+    //! Parse the root of a null-terminated text.
+    /*! \param json Text to be parsed, which must outlive the document.
+        \return The document itself for fluent API.
+    */
+    GenericLazyDocument& Parse(const Ch* json) {
+        RAPIDJSON_ASSERT(json != 0);
+        LazyValueType::Reset();
+        parseResult_.Clear();
+        source_ = json;
+
+        const Ch* p = SkipWhitespace(json);
+        if (*p == '\0')
+            SetError(kParseErrorDocumentEmpty, p);
+        else if ((p = ParseValue(p, *this)) != 0) {
+            p = SkipWhitespace(p);
+            if (*p != '\0')
+                SetError(kParseErrorDocumentRootNotSingular, p);
+        }
+        if (HasParseError())
+            LazyValueType::Reset();
+        return *this;
+    }
+
+    //!@name Handling parse errors
+    //!@{
+
+    //! Whether a parse error has occurred in Parse() or in the expansion of an object or array.
+    bool HasParseError() const { return parseResult_.IsError(); }
+
+    //! Get the first \ref ParseErrorCode.
+    ParseErrorCode GetParseError() const { return parseResult_.Code(); }
+
+    //! Get the position of the first error, relative to the text.
+    size_t GetErrorOffset() const { return parseResult_.Offset(); }
+
+    //! Implicit conversion to get the first ParseResult.
+    operator ParseResult() const { return parseResult_; }
+    //!@}
+
+    //! Get the allocator of this document.
+    Allocator& GetAllocator() {
+        RAPIDJSON_ASSERT(allocator_);
+        return *allocator_;
+    }
+
+private:
+    friend class GenericLazyValue<Encoding, Allocator, StackAllocator>;
+    typedef GenericLazyMember<Encoding, Allocator, StackAllocator> Member;
+
+    // Receives the event of a scalar.
+    struct ScalarHandler : BaseReaderHandler<Encoding, ScalarHandler> {
+        ScalarHandler(ValueType& v, Allocator& a) : value(v), allocator(a) {}
+
+        bool Null() { value.SetNull(); return true; }
+        bool Bool(bool b) { value.SetBool(b); return true; }
+        bool Int(int i) { value.SetInt(i); return true; }
+        bool Uint(unsigned u) { value.SetUint(u); return true; }
+        bool Int64(int64_t i) { value.SetInt64(i); return true; }
+        bool Uint64(uint64_t u) { value.SetUint64(u); return true; }
+        bool Double(double d) { value.SetDouble(d); return true; }
+        bool String(const Ch* str, SizeType length, bool) { value.SetString(str, length, allocator); return true; }
+        bool StartObject() { return false; }
+        bool StartArray() { return false; }
+
+        ValueType& value;
+        Allocator& allocator;
+
+    private:
+        ScalarHandler(const ScalarHandler&);
+        ScalarHandler& operator=(const ScalarHandler&);
+    };
+
+    static const size_t kDefaultStackCapacity = 1024;
+
+    static const Ch* SkipWhitespace(const Ch* p) {
+        GenericStringStream<Encoding> s(p);
+        RAPIDJSON_NAMESPACE::SkipWhitespace(s);
+        return s.src_;
+    }
+
+    void SetError(ParseErrorCode code, const Ch* p) {
+        if (!parseResult_.IsError())
+            parseResult_.Set(code, static_cast<size_t>(p - source_));
+    }
+
+    // Parse a scalar at p. Returns the position after it, or null on error.
+    const Ch* ParseScalar(const Ch* p, ValueType& value) {
+        GenericStringStream<Encoding> s(p);
+        ScalarHandler handler(value, *allocator_);
+        if (reader_.template Parse<kParseStopWhenDoneFlag>(s, handler).IsError()) {
+            SetError(reader_.GetParseErrorCode(), p + reader_.GetErrorOffset());
+            return 0;
+        }
+        return s.src_;
+    }
+
+    // Parse a scalar, or find the end of an object or array, at p. Returns the position after it, or null on error.
+    const Ch* ParseValue(const Ch* p, LazyValueType& value) {
+        if (*p != '{' && *p != '[')
+            return ParseScalar(p, value.value_);
+
+        const Ch* end = internal::SkipContainer(p);
+        if (!end) {
+            SetError(*p == '{' ? kParseErrorObjectMissCommaOrCurlyBracket : kParseErrorArrayMissCommaOrSquareBracket, p + internal::StrLen(p));
+            return 0;
+        }
+        value.begin_ = p;
+        value.end_ = end;
+        value.document_ = this;
+        return end;
+    }
+
+    // Parse the members or elements of an object or array, leaving the nested ones unparsed.
+    void Expand(LazyValueType& value) {
+        RAPIDJSON_ASSERT(value.begin_ && !value.expanded_);
+        value.expanded_ = true;
+        if (value.IsObject())
+            ExpandChildren<Member>(value, '}', kParseErrorObjectMissCommaOrCurlyBracket);
+        else
+            ExpandChildren<LazyValueType>(value, ']', kParseErrorArrayMissCommaOrSquareBracket);
+    }
+
+    template <typename T>
+    void ExpandChildren(LazyValueType& value, Ch close, ParseErrorCode missCommaOrBracket) {
+        RAPIDJSON_ASSERT(stack_.Empty());
+        SizeType count = 0;
+        const Ch* p = SkipWhitespace(value.begin_ + 1);
+        bool success = true;
+        if (*p != close) {
+            for (;;) {
+                T* child = new (stack_.template Push<T>()) T();
+                ++count;
+                if ((p = ParseChild(p, *child)) == 0) {
+                    success = false;
+                    break;
+                }
+                p = SkipWhitespace(p);
+                if (*p == ',')
+                    p = SkipWhitespace(p + 1);
+                else if (*p == close)
+                    break;
+                else {
+                    SetError(missCommaOrBracket, p);
+                    success = false;
+                    break;
+                }
+            }
+        }
+        if (success && p + 1 != value.end_) {
+            SetError(missCommaOrBracket, p);
+            success = false;
+        }
+
+        T* children = stack_.template Pop<T>(count);
+        if (success && count > 0) {
+            value.children_ = allocator_->Malloc(count * sizeof(T));
+            std::memcpy(static_cast<void*>(value.children_), static_cast<void*>(children), count * sizeof(T));
+            value.size_ = count;
+        }
+        else
+            for (SizeType i = 0; i < count; i++)
+                children[i].~T();
+    }
+
+    const Ch* ParseChild(const Ch* p, LazyValueType& element) {
+        return ParseValue(p, element);
+    }
+
+    const Ch* ParseChild(const Ch* p, Member& member) {
+        if (*p != '"') {
+            SetError(kParseErrorObjectMissName, p);
+            return 0;
+        }
+        if ((p = ParseScalar(p, member.name)) == 0)
+            return 0;
+        p = SkipWhitespace(p);
+        if (*p != ':') {
+            SetError(kParseErrorObjectMissColon, p);
+            return 0;
+        }
+        return ParseValue(SkipWhitespace(p + 1), member.value);
+    }
+
+    GenericLazyDocument(const GenericLazyDocument&);
+    GenericLazyDocument& operator=(const GenericLazyDocument&);
+
+    Allocator* allocator_;
+    Allocator* ownAllocator_;
+    internal::Stack<StackAllocator> stack_;
+    GenericReader<Encoding, Encoding, StackAllocator> reader_;
+    const Ch* source_;          //!< Text of the document.
+    ParseResult parseResult_;
+};
+
+//! GenericLazyDocument with UTF8 encoding
+typedef GenericLazyDocument<UTF8<> > LazyDocument;
+
+//! GenericLazyValue with UTF8 encoding
+typedef GenericLazyValue<UTF8<>, MemoryPoolAllocator<>, CrtAllocator> LazyValue;
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_LAZYDOCUMENT_H_
@@ -0,0 +1,179 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_MEMORYMAPPEDFILESTREAM_H_
+#define RAPIDJSON_MEMORYMAPPEDFILESTREAM_H_
+
+#include "stream.h"
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#include <unistd.h>
+#if defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+#define RAPIDJSON_MEMORYMAPPED_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+#endif
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(padded)
+#endif
+
+#ifdef _MSC_VER
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(4996) // 'fopen': This function or variable may be unsafe.
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+//! Read-only input byte stream of a memory-mapped file.
+/*! The file is mapped in whole, followed by a zero page, so the content is a
+    null-terminated string without being copied, unlike FileReadStream, which
+    copies the file through a buffer.
+
+    The stream is a StringStream over the content. Pass GetStringStream() to
+    the reader to parse it as a StringStream, with the same SIMD whitespace
+    and string scanning (and \ref kParseStructuralIndexFlag) as for a string
+    in memory. \ref kParseReferenceSourceFlag also applies only through
+    GetStringStream(), and the stream must then outlive the parsed values.
+
+    The kernel is advised that the pages will be read sequentially.
+
+    On platforms without POSIX memory-mapped files, the file is read into
+    memory instead.
+
+    \note The file must not be modified while it is mapped.
+    \note implements Stream concept
+*/
+class MemoryMappedFileStream : public StringStream {
+public:
+    //! Constructor.
+    /*! \param filename Name of the file to be mapped. Check IsOpen() for failure,
+            in which case the stream is an empty string.
+    */
+    explicit MemoryMappedFileStream(const char* filename) : StringStream(""), data_(0), size_(0)
+#ifdef RAPIDJSON_MEMORYMAPPED_POSIX
+        , mapSize_(0)
+#endif
+    {
+        RAPIDJSON_ASSERT(filename != 0);
+        Open(filename);
+    }
+
+    //! Destructor, which unmaps the file.
+    ~MemoryMappedFileStream() { Close(); }
+
+    //! Whether the file was mapped successfully.
+    bool IsOpen() const { return data_ != 0; }
+
+    //! The stream as a StringStream, for parsing with the optimizations of StringStream.
+    /*! The position is shared with this stream.
+    */
+    StringStream& GetStringStream() { return *this; }
+
+    //! Content of the file, terminated by '\\0'.
+    const Ch* GetString() const { return head_; }
+
+    //! Size of the file in bytes.
+    size_t GetSize() const { return size_; }
+
+private:
+    MemoryMappedFileStream(const MemoryMappedFileStream&);
+    MemoryMappedFileStream& operator=(const MemoryMappedFileStream&);
+
+#ifdef RAPIDJSON_MEMORYMAPPED_POSIX
+    void Open(const char* filename) {
+        const int fd = open(filename, O_RDONLY);
+        if (fd == -1)
+            return;
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            const size_t size = static_cast<size_t>(st.st_size);
+            const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            const size_t mapSize = (size / pageSize + 1) * pageSize;   // at least one byte after the file
+
+            // Reserve zero pages, and map the file over their beginning
+            void* p = mmap(0, mapSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p != MAP_FAILED) {
+                if (size == 0 || mmap(p, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) != MAP_FAILED) {
+                    if (size)
+                        posix_madvise(p, size, POSIX_MADV_SEQUENTIAL);
+                    data_ = p;
+                    size_ = size;
+                    mapSize_ = mapSize;
+                    src_ = head_ = static_cast<const Ch*>(p);
+                }
+                else
+                    munmap(p, mapSize);
+            }
+        }
+        close(fd);
+    }
+
+    void Close() {
+        if (data_)
+            munmap(data_, mapSize_);
+    }
+#else
+    void Open(const char* filename) {
+        std::FILE* fp = std::fopen(filename, "rb");
+        if (!fp)
+            return;
+
+        if (std::fseek(fp, 0, SEEK_END) == 0) {
+            const long size = std::ftell(fp);
+            if (size >= 0 && std::fseek(fp, 0, SEEK_SET) == 0) {
+                char* p = static_cast<char*>(std::malloc(static_cast<size_t>(size) + 1));
+                if (p && std::fread(p, 1, static_cast<size_t>(size), fp) == static_cast<size_t>(size)) {
+                    p[size] = '\0';
+                    data_ = p;
+                    size_ = static_cast<size_t>(size);
+                    src_ = head_ = p;
+                }
+                else
+                    std::free(p);
+            }
+        }
+        std::fclose(fp);
+    }
+
+    void Close() { std::free(data_); }
+#endif
+
+    void* data_;        //!< Beginning of the mapping, or null if not open.
+    size_t size_;       //!< Size of the file.
+#ifdef RAPIDJSON_MEMORYMAPPED_POSIX
+    size_t mapSize_;    //!< Size of the mapping, including the zero pages.
+#endif
+};
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef _MSC_VER
+RAPIDJSON_DIAG_POP
+#endif
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_MEMORYMAPPEDFILESTREAM_H_
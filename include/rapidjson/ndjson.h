@@ -0,0 +1,240 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_NDJSON_H_
+#define RAPIDJSON_NDJSON_H_
+
+/*! \file ndjson.h
+    Multi-threaded parsing of newline-delimited JSON (NDJSON), which has one
+    JSON text per line. This requires C++11 (\c RAPIDJSON_HAS_CXX11_THREADS).
+*/
+
+#include "document.h"
+#include "internal/parallelfor.h"
+
+#if RAPIDJSON_HAS_CXX11_THREADS
+
+#include <cstring>
+#include <vector>
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+///////////////////////////////////////////////////////////////////////////////
+// NDJSONRecord
+
+//! Position and parse result of a record in NDJSON text.
+struct NDJSONRecord {
+    NDJSONRecord() : offset(), length(), result() {}
+    NDJSONRecord(size_t o, size_t l) : offset(o), length(l), result() {}
+
+    size_t offset;          //!< Offset of the record in the text, in code units.
+    size_t length;          //!< Length of the record in code units, excluding the newline.
+    ParseResult result;     //!< Result of parsing the record. The error offset is relative to the record.
+};
+
+namespace internal {
+
+template <typename Ch>
+inline const Ch* FindNewline(const Ch* p, const Ch* end) {
+    while (p != end && *p != '\n')
+        ++p;
+    return p;
+}
+
+inline const char* FindNewline(const char* p, const char* end) {
+    const void* q = std::memchr(p, '\n', static_cast<size_t>(end - p));
+    return q ? static_cast<const char*>(q) : end;
+}
+
+template <typename Ch>
+inline bool IsBlank(const Ch* p, const Ch* end) {
+    for (; p != end; ++p)
+        if (*p != ' ' && *p != '\t' && *p != '\r')
+            return false;
+    return true;
+}
+
+} // namespace internal
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericNDJSONReader
+
+//! Parser of newline-delimited JSON text on several threads.
+/*! The text is split into records on '\\n', which cannot occur inside a
+    JSON string. Lines with only whitespace are skipped. The records are then
+    parsed by a pool of worker threads, taking batches of records in turn, and
+    the results are stored in the order of the records.
+
+    Each worker copies a record into a null-terminated buffer of its own before
+    parsing it, so the SIMD and \ref kParseStructuralIndexFlag paths apply, and
+    an incomplete record cannot run into the next line.
+
+    \tparam SourceEncoding Encoding of the input text.
+    \tparam TargetEncoding Encoding passed to the handlers.
+    \tparam StackAllocator Allocator type for the stack of each worker.
+    \note The handlers must not throw exceptions, which would terminate the program in a worker thread.
+*/
+template <typename SourceEncoding, typename TargetEncoding, typename StackAllocator = CrtAllocator>
+class GenericNDJSONReader {
+public:
+    typedef typename SourceEncoding::Ch Ch; //!< SourceEncoding character type
+
+    //! Constructor.
+    /*! \param threadCount Number of threads parsing the records, including the calling one. 0 uses one per hardware thread.
+    */
+    explicit GenericNDJSONReader(unsigned threadCount = 0) : threadCount_(internal::ResolveThreadCount(threadCount)), workers_(), records_(), errorCount_() {}
+
+    //! Destructor.
+    ~GenericNDJSONReader() {
+        for (size_t i = 0; i < workers_.size(); i++)
+            RAPIDJSON_DELETE(workers_[i]);
+    }
+
+    //! Parse records with a SAX handler each.
+    /*! \tparam parseFlags Combination of \ref ParseFlag. \ref kParseInsituFlag and \ref kParseReferenceSourceFlag are not supported, as records are parsed from a reused copy.
+        \tparam Handler Type of handler, implementing Handler concept. It must be default-constructible and movable.
+        \param text NDJSON text, which need not be null-terminated.
+        \param length Length of \c text in code units.
+        \param handlers Cleared and resized to the number of records. handlers[i] receives the events of record i.
+        \return true if all records were parsed successfully.
+    */
+    template <unsigned parseFlags, typename Handler>
+    bool Parse(const Ch* text, size_t length, std::vector<Handler>& handlers) {
+        RAPIDJSON_STATIC_ASSERT(!(parseFlags & (kParseInsituFlag | kParseReferenceSourceFlag)));
+        Split(text, length);
+        handlers.clear();
+        handlers.resize(records_.size());
+        ForEachRecord(text, [&handlers](ReaderType& reader, const Ch* record, NDJSONRecord& r, size_t i) {
+            GenericStringStream<SourceEncoding> is(record);
+            r.result = reader.template Parse<parseFlags>(is, handlers[i]);
+        });
+        return errorCount_ == 0;
+    }
+
+    //! Parse records into documents.
+    /*! Each document owns its allocator, so the documents are independent of
+        each other and of the text.
+        \tparam parseFlags Combination of \ref ParseFlag. \ref kParseInsituFlag and \ref kParseReferenceSourceFlag are not supported, as records are parsed from a reused copy.
+        \param text NDJSON text, which need not be null-terminated.
+        \param length Length of \c text in code units.
+        \param documents Cleared and resized to the number of records. documents[i] holds record i and its parse result.
+        \return true if all records were parsed successfully.
+    */
+    template <unsigned parseFlags, typename Allocator, typename DocumentStackAllocator>
+    bool Parse(const Ch* text, size_t length, std::vector<GenericDocument<TargetEncoding, Allocator, DocumentStackAllocator> >& documents) {
+        RAPIDJSON_STATIC_ASSERT(!(parseFlags & (kParseInsituFlag | kParseReferenceSourceFlag)));
+        typedef GenericDocument<TargetEncoding, Allocator, DocumentStackAllocator> DocumentType;
+        Split(text, length);
+        documents.clear();
+        documents.resize(records_.size());
+        ForEachRecord(text, [&documents](ReaderType&, const Ch* record, NDJSONRecord& r, size_t i) {
+            DocumentType& d = documents[i];
+            d.template Parse<parseFlags, SourceEncoding>(record);
+            r.result = ParseResult(d.GetParseError(), d.GetErrorOffset());
+        });
+        return errorCount_ == 0;
+    }
+
+    //! Records of the last parsing, in input order.
+    const std::vector<NDJSONRecord>& GetRecords() const { return records_; }
+
+    //! Number of records failed in the last parsing.
+    size_t GetErrorCount() const { return errorCount_; }
+
+    //! Number of threads parsing the records.
+    unsigned GetThreadCount() const { return threadCount_; }
+
+private:
+    typedef GenericReader<SourceEncoding, TargetEncoding, StackAllocator> ReaderType;
+    static const size_t kBatchSize = 16;    //!< Number of records taken by a worker at a time.
+
+    // Reader of a thread, with the buffer for the null-terminated copy of a record.
+    struct Worker {
+        Worker() : reader(), buffer() {}
+
+        ReaderType reader;
+        std::vector<Ch> buffer;
+
+    private:
+        Worker(const Worker&);
+        Worker& operator=(const Worker&);
+    };
+
+    GenericNDJSONReader(const GenericNDJSONReader&);
+    GenericNDJSONReader& operator=(const GenericNDJSONReader&);
+
+    void Split(const Ch* text, size_t length) {
+        records_.clear();
+        errorCount_ = 0;
+        const Ch* const end = text + length;
+        for (const Ch* p = text; p != end; ) {
+            const Ch* q = internal::FindNewline(p, end);
+            if (!internal::IsBlank(p, q))
+                records_.push_back(NDJSONRecord(static_cast<size_t>(p - text), static_cast<size_t>(q - p)));
+            p = q == end ? q : q + 1;
+        }
+    }
+
+    // Call f(reader, record, records_[i], i) for each record on the worker threads,
+    // where record is a null-terminated copy and reader belongs to the worker.
+    template <typename Function>
+    void ForEachRecord(const Ch* text, Function f) {
+        const size_t count = records_.size();
+        const size_t threadCount = internal::ParallelForThreadCount(threadCount_, count, kBatchSize);
+        while (workers_.size() < threadCount)
+            workers_.push_back(RAPIDJSON_NEW(Worker)());
+
+        internal::ParallelFor(threadCount, count, kBatchSize, [this, text, &f](size_t thread, size_t i) {
+            Worker& w = *workers_[thread];
+            NDJSONRecord& r = records_[i];
+            w.buffer.resize(r.length + 1);
+            std::memcpy(&w.buffer[0], text + r.offset, r.length * sizeof(Ch));
+            w.buffer[r.length] = '\0';
+            f(w.reader, &w.buffer[0], r, i);
+        });
+
+        for (size_t i = 0; i < count; i++)
+            if (records_[i].result.IsError())
+                ++errorCount_;
+    }
+
+    unsigned threadCount_;
+    std::vector<Worker*> workers_;
+    std::vector<NDJSONRecord> records_;
+    size_t errorCount_;
+};
+
+//! NDJSON reader with UTF8 encoding and default allocator.
+typedef GenericNDJSONReader<UTF8<>, UTF8<> > NDJSONReader;
+
+//! Parse NDJSON text into documents on several threads.
+/*! \tparam parseFlags Combination of \ref ParseFlag. \ref kParseInsituFlag and \ref kParseReferenceSourceFlag are not supported, as records are parsed from a reused copy.
+    \param text NDJSON text, which need not be null-terminated.
+    \param length Length of \c text in code units.
+    \param documents Cleared and resized to the number of records, in input order. Check the parse result of each with GenericDocument::HasParseError().
+    \param threadCount Number of threads, including the calling one. 0 uses one per hardware thread.
+    \return true if all records were parsed successfully.
+    \see GenericNDJSONReader for the positions of the records.
+*/
+template <unsigned parseFlags, typename Encoding, typename Allocator, typename StackAllocator>
+bool ParseNDJSON(const typename Encoding::Ch* text, size_t length, std::vector<GenericDocument<Encoding, Allocator, StackAllocator> >& documents, unsigned threadCount = 0) {
+    GenericNDJSONReader<Encoding, Encoding, StackAllocator> reader(threadCount);
+    return reader.template Parse<parseFlags>(text, length, documents);
+}
+
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_HAS_CXX11_THREADS
+
+#endif // RAPIDJSON_NDJSON_H_
@@ -0,0 +1,236 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_PARALLELSCHEMA_H_
+#define RAPIDJSON_PARALLELSCHEMA_H_
+
+/*! \file parallelschema.h
+    Multi-threaded validation of the elements of an array, or of NDJSON
+    records, against a schema. This requires C++11 (\c RAPIDJSON_HAS_CXX11_THREADS).
+*/
+
+#include "schema.h"
+#include "internal/parallelfor.h"
+
+#if RAPIDJSON_HAS_CXX11_THREADS
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericParallelSchemaValidator
+
+//! Validator of many values against one schema on several threads.
+/*! Each element of a DOM array, or each document of a list such as the
+    records of \ref ParseNDJSON(), is validated against the root schema of
+    the schema document. The schema document is shared by all threads, as it
+    is immutable after construction.
+
+    Each worker thread has its own \c StateAllocator and \c GenericSchemaValidator,
+    which are kept for the next validation. The workers take batches of
+    elements in turn. A \c StateAllocator which does not free, such as
+    \c MemoryPoolAllocator, is cleared at the start of each validation.
+
+    The errors are reported as if the elements were validated through the
+    "items" of the array: the instance reference of each error starts with
+    the index of its element, and the errors are merged in element order.
+
+    \tparam SchemaDocumentType Type of schema document.
+    \tparam StateAllocator Allocator for storing the internal validation states of each worker.
+    \note If \c RAPIDJSON_ASSERT throws, a failed assertion terminates the program in a worker thread.
+*/
+template <typename SchemaDocumentType, typename StateAllocator = CrtAllocator>
+class GenericParallelSchemaValidator {
+public:
+    typedef typename SchemaDocumentType::SchemaType SchemaType;
+    typedef typename SchemaType::EncodingType EncodingType;
+    typedef GenericSchemaValidator<SchemaDocumentType, BaseReaderHandler<EncodingType>, StateAllocator> ValidatorType;
+    typedef typename ValidatorType::ValueType ValueType;
+
+    //! Constructor.
+    /*! \param schemaDocument The schema document to conform to. It must outlive the validator.
+        \param threadCount Number of threads validating the elements, including the calling one. 0 uses one per hardware thread.
+    */
+    explicit GenericParallelSchemaValidator(const SchemaDocumentType& schemaDocument, unsigned threadCount = 0) :
+        schemaDocument_(&schemaDocument), threadCount_(internal::ResolveThreadCount(threadCount)), workers_(), invalid_(), allocator_(), error_(kObjectType) {}
+
+    //! Destructor.
+    ~GenericParallelSchemaValidator() {
+        for (size_t i = 0; i < workers_.size(); i++)
+            RAPIDJSON_DELETE(workers_[i]);
+    }
+
+    //! Validate the elements of an array.
+    /*! \param array Array of the values to validate.
+        \return true if all elements are valid.
+    */
+    template <typename Encoding, typename Allocator>
+    bool Validate(const GenericValue<Encoding, Allocator>& array) {
+        RAPIDJSON_ASSERT(array.IsArray());
+        const GenericValue<Encoding, Allocator>* elements = array.Begin();
+        ForEachElement(array.Size(), [elements](SizeType i) -> const GenericValue<Encoding, Allocator>& { return elements[i]; });
+        return IsValid();
+    }
+
+    //! Validate a list of documents, such as NDJSON records.
+    /*! A document which failed to be parsed holds null, and is validated as such.
+        \param documents Documents to validate.
+        \return true if all documents are valid.
+    */
+    template <typename Encoding, typename Allocator, typename StackAllocator>
+    bool Validate(const std::vector<GenericDocument<Encoding, Allocator, StackAllocator> >& documents) {
+        typedef GenericDocument<Encoding, Allocator, StackAllocator> DocumentType;
+        RAPIDJSON_ASSERT(documents.size() <= static_cast<SizeType>(~SizeType(0)));
+        const DocumentType* elements = documents.empty() ? 0 : &documents[0];
+        ForEachElement(static_cast<SizeType>(documents.size()), [elements](SizeType i) -> const DocumentType& { return elements[i]; });
+        return IsValid();
+    }
+
+    //! Whether all elements of the last validation were valid.
+    bool IsValid() const { return invalid_.empty(); }
+
+    //! Number of invalid elements in the last validation.
+    size_t GetInvalidCount() const { return invalid_.size(); }
+
+    //! Index of an invalid element.
+    /*! \param i Rank of the invalid element, less than \c GetInvalidCount(), in element order.
+    */
+    SizeType GetInvalidIndex(size_t i) const { RAPIDJSON_ASSERT(i < invalid_.size()); return invalid_[i].first; }
+
+    //! Error object of an invalid element.
+    /*! \param i Rank of the invalid element, less than \c GetInvalidCount(), in element order.
+    */
+    const ValueType& GetInvalidError(size_t i) const { RAPIDJSON_ASSERT(i < invalid_.size()); return *invalid_[i].second; }
+
+    //! Errors of all elements, merged in element order.
+    /*! It has the format of \c GenericSchemaValidator::GetError().
+    */
+    const ValueType& GetError() const { return error_; }
+
+    //! Number of threads validating the elements.
+    unsigned GetThreadCount() const { return threadCount_; }
+
+private:
+    static const SizeType kBatchSize = 16;  //!< Number of elements taken by a worker at a time.
+
+    // Validator of a thread, with the errors it found as pairs of the index and the error object.
+    struct Worker {
+        explicit Worker(const SchemaDocumentType& schemaDocument) : allocator(), validator(RAPIDJSON_NEW(ValidatorType)(schemaDocument, &allocator)), errors(kArrayType) {}
+        ~Worker() { RAPIDJSON_DELETE(validator); }
+
+        //! Release the errors and the states of the last validation.
+        void Clear(const SchemaDocumentType& schemaDocument) {
+            errors.SetArray();
+            Clear(schemaDocument, internal::BoolType<StateAllocator::kNeedFree>());
+        }
+
+        void Clear(const SchemaDocumentType&, internal::TrueType) {}
+
+        // The validator keeps its stacks in the allocator, so it is created again.
+        void Clear(const SchemaDocumentType& schemaDocument, internal::FalseType) {
+            RAPIDJSON_DELETE(validator);
+            allocator.Clear();
+            validator = RAPIDJSON_NEW(ValidatorType)(schemaDocument, &allocator);
+        }
+
+        StateAllocator allocator;
+        ValidatorType* validator;
+        ValueType errors;
+
+    private:
+        Worker(const Worker&);
+        Worker& operator=(const Worker&);
+    };
+
+    GenericParallelSchemaValidator(const GenericParallelSchemaValidator&);
+    GenericParallelSchemaValidator& operator=(const GenericParallelSchemaValidator&);
+
+    // Validate get(i) for each i < count on the worker threads.
+    template <typename Function>
+    void ForEachElement(SizeType count, Function get) {
+        const size_t threadCount = internal::ParallelForThreadCount(threadCount_, count, kBatchSize);
+        invalid_.clear();
+        error_.SetObject();
+        ClearAllocator(allocator_, internal::BoolType<StateAllocator::kNeedFree>());
+        for (size_t i = 0; i < workers_.size(); i++)
+            workers_[i]->Clear(*schemaDocument_);
+        while (workers_.size() < threadCount)
+            workers_.push_back(RAPIDJSON_NEW(Worker)(*schemaDocument_));
+
+        internal::ParallelFor(threadCount_, count, kBatchSize, [this, &get](size_t thread, size_t index) {
+            Worker& w = *workers_[thread];
+            const SizeType i = static_cast<SizeType>(index);
+            w.validator->ResetAsElement(i);
+            get(i).Accept(*w.validator);
+            if (!w.validator->IsValid()) {
+                w.errors.PushBack(static_cast<uint64_t>(i), w.allocator);
+                w.errors.PushBack(w.validator->GetError(), w.allocator);
+            }
+        });
+
+        for (size_t i = 0; i < threadCount; i++) {
+            const ValueType& errors = workers_[i]->errors;
+            for (SizeType j = 0; j < errors.Size(); j += 2)
+                invalid_.push_back(std::make_pair(static_cast<SizeType>(errors[j].GetUint64()), &errors[j + 1]));
+        }
+        std::sort(invalid_.begin(), invalid_.end());
+
+        for (size_t i = 0; i < invalid_.size(); i++)
+            MergeError(*invalid_[i].second);
+    }
+
+    // Allocators which do not free, such as MemoryPoolAllocator, would grow with each validation.
+    static void ClearAllocator(StateAllocator&, internal::TrueType) {}
+    static void ClearAllocator(StateAllocator& allocator, internal::FalseType) { allocator.Clear(); }
+
+    // Add each error of an element under its keyword, making an array when there are several.
+    void MergeError(const ValueType& error) {
+        for (typename ValueType::ConstMemberIterator it = error.MemberBegin(); it != error.MemberEnd(); ++it) {
+            typename ValueType::MemberIterator member = error_.FindMember(it->name);
+            if (member == error_.MemberEnd()) {
+                error_.AddMember(ValueType(it->name, allocator_).Move(), ValueType(it->value, allocator_).Move(), allocator_);
+                continue;
+            }
+            if (member->value.IsObject()) {
+                ValueType errors(kArrayType);
+                errors.PushBack(member->value, allocator_);
+                member->value = errors;
+            }
+            if (it->value.IsArray())
+                for (typename ValueType::ConstValueIterator e = it->value.Begin(); e != it->value.End(); ++e)
+                    member->value.PushBack(ValueType(*e, allocator_).Move(), allocator_);
+            else
+                member->value.PushBack(ValueType(it->value, allocator_).Move(), allocator_);
+        }
+    }
+
+    const SchemaDocumentType* schemaDocument_;
+    unsigned threadCount_;
+    std::vector<Worker*> workers_;
+    std::vector<std::pair<SizeType, const ValueType*> > invalid_;  //!< Index and error of the invalid elements, in element order.
+    StateAllocator allocator_;  //!< Allocator of error_.
+    ValueType error_;
+};
+
+//! Parallel validator with the default schema document and allocator.
+typedef GenericParallelSchemaValidator<SchemaDocument> ParallelSchemaValidator;
+
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_HAS_CXX11_THREADS
+
+#endif // RAPIDJSON_PARALLELSCHEMA_H_
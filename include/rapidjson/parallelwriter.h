@@ -0,0 +1,419 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_PARALLELWRITER_H_
+#define RAPIDJSON_PARALLELWRITER_H_
+
+/*! \file parallelwriter.h
+    Multi-threaded serialization of a large DOM, with the same output as
+    \ref Writer. This requires C++11 (\c RAPIDJSON_HAS_CXX11_THREADS).
+*/
+
+#include "document.h"
+#include "stringbuffer.h"
+#include "writer.h"
+#include "internal/parallelfor.h"
+
+#if RAPIDJSON_HAS_CXX11_THREADS
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+namespace internal {
+
+template <typename OutputStream, typename Ch>
+inline void PutChars(OutputStream& os, const Ch* s, size_t length) {
+    PutReserve(os, length);
+    for (size_t i = 0; i < length; i++)
+        PutUnsafe(os, s[i]);
+}
+
+template <typename Encoding, typename Allocator>
+inline void PutChars(GenericStringBuffer<Encoding, Allocator>& os, const typename Encoding::Ch* s, size_t length) {
+    if (length > 0)
+        std::memcpy(os.Push(length), s, length * sizeof(typename Encoding::Ch));
+}
+
+} // namespace internal
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericParallelWriter
+
+//! Writer of a large DOM on several threads.
+/*! The value is split serially into chunks of consecutive elements or
+    members of its arrays and objects, by the estimated output size of their
+    subtrees. A container whose subtree is larger than a chunk is split in
+    turn. The brackets, separators and keys between the chunks are written
+    serially.
+
+    Worker threads take the chunks in turn and write them with a \ref Writer
+    of their own, appending to a string buffer per thread. The pieces are
+    then copied to the output stream in document order, so the output is
+    byte-identical to writing the value with \c Writer with the same flags.
+
+    A value which is not split, such as one smaller than a chunk, is written
+    directly by a \c Writer on the calling thread.
+
+    \tparam SourceEncoding Encoding of the DOM.
+    \tparam TargetEncoding Encoding of the output.
+    \tparam StackAllocator Allocator type of the writers and of the buffer of each thread.
+    \tparam writeFlags Flags of the writers, as \ref Writer.
+    \note The buffers of the threads hold the whole output before it is copied to the stream, and are kept for the next writing.
+*/
+template <typename SourceEncoding = UTF8<>, typename TargetEncoding = UTF8<>, typename StackAllocator = CrtAllocator, unsigned writeFlags = kWriteDefaultFlags>
+class GenericParallelWriter {
+public:
+    typedef typename TargetEncoding::Ch Ch;  //!< TargetEncoding character type
+
+    static const size_t kDefaultChunkSize = 64 * 1024;  //!< Default estimated output size of a chunk, in code units.
+
+    //! Constructor.
+    /*! \param threadCount Number of threads writing the chunks, including the calling one. 0 uses one per hardware thread.
+    */
+    explicit GenericParallelWriter(unsigned threadCount = 0) :
+        threadCount_(internal::ResolveThreadCount(threadCount)), chunkSize_(kDefaultChunkSize), maxDecimalPlaces_(WriterType::kDefaultMaxDecimalPlaces), workers_(), pieces_() {}
+
+    //! Destructor.
+    ~GenericParallelWriter() {
+        for (size_t i = 0; i < workers_.size(); i++)
+            RAPIDJSON_DELETE(workers_[i]);
+    }
+
+    //! Write a value to an output stream.
+    /*! \param value Value to write, usually a document. It must not be modified during the writing.
+        \param os Output stream.
+        \return Whether the writing succeeded, as the return value of \c GenericValue::Accept() with a \c Writer.
+            On failure, the content written to \c os is unspecified.
+    */
+    template <typename Allocator, typename OutputStream>
+    bool Write(const GenericValue<SourceEncoding, Allocator>& value, OutputStream& os) {
+        typedef GenericValue<SourceEncoding, Allocator> ValueType;
+
+        if (threadCount_ == 1 || !(value.IsArray() || value.IsObject()) || Weight(value, chunkSize_) < chunkSize_)
+            return WriteSerial(value, os);
+
+        while (workers_.size() < threadCount_)
+            workers_.push_back(RAPIDJSON_NEW(Worker)());
+        for (size_t i = 0; i < workers_.size(); i++) {
+            workers_[i]->buffer.Clear();
+            workers_[i]->writer.SetMaxDecimalPlaces(maxDecimalPlaces_);
+        }
+
+        // The first worker also holds the text between the chunks, written before the chunks.
+        Worker& glue = *workers_[0];
+        pieces_.clear();
+        std::vector<Frame<ValueType> > frames;
+        size_t weight = 0;
+        bool split = false;
+        if (!Plan(glue, frames, value, weight, split))
+            return false;
+        if (!split)
+            return WriteSerial(value, os);
+
+        std::vector<size_t> chunks;
+        for (size_t i = 0; i < pieces_.size(); i++)
+            if (pieces_[i].container)
+                chunks.push_back(i);
+
+        std::atomic<bool> failed(false);
+        internal::ParallelFor(threadCount_, chunks.size(), 1, [this, &chunks, &failed](size_t thread, size_t i) {
+            if (failed.load(std::memory_order_relaxed))
+                return;
+            Worker& w = *workers_[thread];
+            Piece& p = pieces_[chunks[i]];
+            p.worker = thread;
+            p.offset = w.buffer.GetLength();
+            if (!WriteChunk<ValueType>(w, p))
+                failed.store(true, std::memory_order_relaxed);
+            p.length = w.buffer.GetLength() - p.offset;
+        });
+
+        if (failed.load(std::memory_order_relaxed))
+            return false;
+
+        size_t length = 0;
+        for (size_t i = 0; i < pieces_.size(); i++)
+            length += pieces_[i].length;
+        PutReserve(os, length);
+        for (size_t i = 0; i < pieces_.size(); i++) {
+            const Piece& p = pieces_[i];
+            internal::PutChars(os, workers_[p.worker]->buffer.GetString() + p.offset, p.length);
+        }
+        return true;
+    }
+
+    //! Set the estimated output size of a chunk.
+    /*! Smaller chunks balance the threads better, at the cost of more pieces to copy.
+        \param chunkSize Estimated output size of a chunk in code units, greater than 0.
+    */
+    void SetChunkSize(size_t chunkSize) { RAPIDJSON_ASSERT(chunkSize > 0); chunkSize_ = chunkSize; }
+
+    //! Estimated output size of a chunk, in code units.
+    size_t GetChunkSize() const { return chunkSize_; }
+
+    //! Set the maximum number of decimal places for double output, as \ref Writer::SetMaxDecimalPlaces().
+    void SetMaxDecimalPlaces(int maxDecimalPlaces) { maxDecimalPlaces_ = maxDecimalPlaces; }
+
+    int GetMaxDecimalPlaces() const { return maxDecimalPlaces_; }
+
+    //! Number of threads writing the chunks.
+    unsigned GetThreadCount() const { return threadCount_; }
+
+private:
+    typedef GenericStringBuffer<TargetEncoding, StackAllocator> BufferType;
+    typedef Writer<BufferType, SourceEncoding, TargetEncoding, StackAllocator, writeFlags> WriterType;
+
+    // Writer of a thread, with the buffer holding the chunks it wrote.
+    struct Worker {
+        Worker() : buffer(), writer() {}
+
+        BufferType buffer;
+        WriterType writer;
+
+    private:
+        Worker(const Worker&);
+        Worker& operator=(const Worker&);
+    };
+
+    // Part of the output: elements or members [begin, end) of a container, each
+    // preceded by a comma except the first of the container, or text between
+    // the chunks when container is null. The text is at offset in the buffer of
+    // the worker.
+    struct Piece {
+        Piece() : container(), begin(), end(), worker(), offset(), length() {}
+
+        const void* container;
+        SizeType begin;
+        SizeType end;
+        size_t worker;
+        size_t offset;
+        size_t length;
+    };
+
+    GenericParallelWriter(const GenericParallelWriter&);
+    GenericParallelWriter& operator=(const GenericParallelWriter&);
+
+    template <typename ValueType, typename OutputStream>
+    bool WriteSerial(const ValueType& value, OutputStream& os) const {
+        Writer<OutputStream, SourceEncoding, TargetEncoding, StackAllocator, writeFlags> writer(os);
+        writer.SetMaxDecimalPlaces(maxDecimalPlaces_);
+        return value.Accept(writer);
+    }
+
+    // Estimated output size of a value, in code units. It stops counting once reaching limit.
+    template <typename ValueType>
+    static size_t Weight(const ValueType& v, size_t limit) {
+        switch (v.GetType()) {
+        case kNullType:
+        case kFalseType:
+        case kTrueType:
+            return 5;
+        case kStringType:
+            return v.GetStringLength() + 3;
+        case kNumberType:
+            return v.IsDouble() ? 20 : 10;
+        case kArrayType: {
+            size_t w = 2;
+            for (typename ValueType::ConstValueIterator e = v.Begin(); e != v.End() && w < limit; ++e)
+                w += Weight(*e, limit - w);
+            return w;
+        }
+        default: {
+            RAPIDJSON_ASSERT(v.IsObject());
+            size_t w = 2;
+            for (typename ValueType::ConstMemberIterator m = v.MemberBegin(); m != v.MemberEnd() && w < limit; ++m)
+                w += m->name.GetStringLength() + 4 + Weight(m->value, limit - w);
+            return w;
+        }
+        }
+    }
+
+    // Container being planned, with the child being planned and the first child not in a piece yet.
+    // The container is opened once the text before its first piece is added.
+    template <typename ValueType>
+    struct Frame {
+        explicit Frame(const ValueType& v) : container(&v), index(), begin(), opened() {}
+
+        const ValueType* container;
+        SizeType index;
+        SizeType begin;
+        bool opened;
+    };
+
+    void AddChunk(const void* container, SizeType begin, SizeType end) {
+        if (begin == end)
+            return;
+        Piece p;
+        p.container = container;
+        p.begin = begin;
+        p.end = end;
+        pieces_.push_back(p);
+    }
+
+    // Add the text written by f to the glue buffer as a piece, merged with the previous piece of text.
+    template <typename Function>
+    bool AddText(Worker& glue, Function f) {
+        const size_t offset = glue.buffer.GetLength();
+        if (!f(glue))
+            return false;
+        if (!pieces_.empty() && !pieces_.back().container)
+            pieces_.back().length += glue.buffer.GetLength() - offset;
+        else {
+            Piece p;
+            p.offset = offset;
+            p.length = glue.buffer.GetLength() - offset;
+            pieces_.push_back(p);
+        }
+        return true;
+    }
+
+    static bool PutChar(Worker& w, Ch c) { w.buffer.Put(c); return true; }
+
+    // Write a key and the colon following it.
+    template <typename ValueType>
+    static bool WriteKey(Worker& w, const ValueType& name) {
+        w.writer.Reset(w.buffer);
+        if (!w.writer.Key(name.GetString(), name.GetStringLength()))
+            return false;
+        w.buffer.Put(':');
+        return true;
+    }
+
+    // Open frames[k], opening the containers around it first.
+    template <typename ValueType>
+    bool Open(Worker& glue, std::vector<Frame<ValueType> >& frames, size_t k) {
+        if (frames[k].opened)
+            return true;
+        if (k > 0 && !OpenChild(glue, frames, k - 1))
+            return false;
+        frames[k].opened = true;
+        const Ch bracket = frames[k].container->IsArray() ? '[' : '{';
+        return AddText(glue, [bracket](Worker& g) { return PutChar(g, bracket); });
+    }
+
+    // Add the children of frames[k] before end as a chunk.
+    template <typename ValueType>
+    bool Flush(Worker& glue, std::vector<Frame<ValueType> >& frames, size_t k, SizeType end) {
+        if (!Open(glue, frames, k))
+            return false;
+        AddChunk(frames[k].container, frames[k].begin, end);
+        frames[k].begin = end;
+        return true;
+    }
+
+    // Add the pieces before the current child of frames[k], for the child to be split.
+    template <typename ValueType>
+    bool OpenChild(Worker& glue, std::vector<Frame<ValueType> >& frames, size_t k) {
+        const SizeType i = frames[k].index;
+        if (!Flush(glue, frames, k, i))
+            return false;
+        frames[k].begin = i + 1;
+        const ValueType& v = *frames[k].container;
+        if (v.IsArray())
+            return i == 0 || AddText(glue, [](Worker& g) { return PutChar(g, ','); });
+        const ValueType& name = (v.MemberBegin() + i)->name;
+        return AddText(glue, [i, &name](Worker& g) { return (i == 0 || PutChar(g, ',')) && WriteKey(g, name); });
+    }
+
+    // Split a container into pieces, once a chunk of its subtree is complete.
+    // A container which is not split gets its estimated output size in weight, and adds no piece.
+    template <typename ValueType>
+    bool Plan(Worker& glue, std::vector<Frame<ValueType> >& frames, const ValueType& v, size_t& weight, bool& split) {
+        const size_t k = frames.size();
+        frames.push_back(Frame<ValueType>(v));
+        const SizeType count = v.IsArray() ? v.Size() : v.MemberCount();
+        size_t w = 2;
+        for (SizeType i = 0; i < count; i++) {
+            frames[k].index = i;
+            const ValueType& child = v.IsArray() ? v[i] : (v.MemberBegin() + i)->value;
+            size_t wi = v.IsArray() ? 1 : (v.MemberBegin() + i)->name.GetStringLength() + 4;
+            bool childSplit = false;
+            if (child.IsArray() || child.IsObject()) {
+                size_t childWeight = 0;
+                if (!Plan(glue, frames, child, childWeight, childSplit))
+                    return false;
+                wi += childWeight;
+            }
+            else
+                wi += Weight(child, chunkSize_);
+
+            if (childSplit)
+                w = 0;
+            else if ((w += wi) >= chunkSize_) {
+                if (!Flush(glue, frames, k, i + 1))
+                    return false;
+                w = 0;
+            }
+        }
+
+        split = frames[k].opened;
+        weight = w;
+        if (split) {
+            if (!Flush(glue, frames, k, count))
+                return false;
+            const Ch bracket = v.IsArray() ? ']' : '}';
+            if (!AddText(glue, [bracket](Worker& g) { return PutChar(g, bracket); }))
+                return false;
+        }
+        frames.pop_back();
+        return true;
+    }
+
+    // Write the elements or members of a chunk.
+    template <typename ValueType>
+    static bool WriteChunk(Worker& w, const Piece& p) {
+        const ValueType& v = *static_cast<const ValueType*>(p.container);
+        if (v.IsArray()) {
+            const ValueType* e = v.Begin();
+            for (SizeType i = p.begin; i < p.end; i++) {
+                if (i != 0)
+                    w.buffer.Put(',');
+                w.writer.Reset(w.buffer);
+                if (!e[i].Accept(w.writer))
+                    return false;
+            }
+        }
+        else {
+            typename ValueType::ConstMemberIterator m = v.MemberBegin() + p.begin;
+            for (SizeType i = p.begin; i < p.end; i++, ++m) {
+                if (i != 0)
+                    w.buffer.Put(',');
+                if (!WriteKey(w, m->name))
+                    return false;
+                w.writer.Reset(w.buffer);
+                if (!m->value.Accept(w.writer))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    unsigned threadCount_;
+    size_t chunkSize_;
+    int maxDecimalPlaces_;
+    std::vector<Worker*> workers_;
+    std::vector<Piece> pieces_;  //!< Chunks and text between them, in document order.
+};
+
+//! Parallel writer with UTF8 encoding and default allocator.
+typedef GenericParallelWriter<> ParallelWriter;
+
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_HAS_CXX11_THREADS
+
+#endif // RAPIDJSON_PARALLELWRITER_H_
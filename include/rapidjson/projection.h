@@ -0,0 +1,386 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_PROJECTION_H_
+#define RAPIDJSON_PROJECTION_H_
+
+/*! \file projection.h
+    Reader which parses only the values selected by a set of JSON Pointers.
+*/
+
+#include "document.h"
+#include "pointer.h"
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(padded)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericProjectionReader
+
+//! Reader which generates SAX events only for the values selected by JSON Pointers.
+/*! The text is walked without parsing: the values which are not on the path
+    of any pointer are skipped with GenericReader::SkipValue(), which only
+    tracks quotes and brackets. A value selected by a pointer is parsed by
+    GenericReader::Parse() and all its events are sent to the handler.
+
+    The objects and arrays enclosing the selected values are reported with
+    only the members or elements leading to them, so the events still form
+    a single JSON value. For example, projecting
+    \code
+    { "id": 1, "user": { "name": "a", "tags": [1, 2] }, "items": [3, 4] }
+    \endcode
+    on \c /user/name and \c /items/1 generates the events of
+    \code
+    { "user": { "name": "a" }, "items": [4] }
+    \endcode
+    An element of an array is kept with its index, so the indices of the
+    projected array are not those of the source.
+
+    A root which is not an object or array generates no events unless a
+    pointer selects the root itself.
+
+    \tparam PointerType Type of JSON Pointers, e.g. \ref Pointer.
+    \tparam StackAllocator Allocator for the stack of the reader.
+    \note The pointers are referenced, not copied, and must outlive the reader.
+*/
+template <typename PointerType, typename StackAllocator = CrtAllocator>
+class GenericProjectionReader {
+public:
+    typedef typename PointerType::EncodingType Encoding;    //!< Encoding of the text, from the pointer type.
+    typedef typename PointerType::Ch Ch;                    //!< Character type derived from Encoding.
+    typedef typename PointerType::Token Token;              //!< Token of the pointers.
+
+    //! Constructor
+    /*! \param paths            Array of pointers selecting the values to be parsed.
+        \param pathCount        Number of pointers in \c paths.
+        \param stackAllocator   Optional allocator for allocating memory for stack.
+    */
+    GenericProjectionReader(const PointerType* paths, SizeType pathCount, StackAllocator* stackAllocator = 0) :
+        paths_(paths), pathCount_(pathCount), stack_(stackAllocator, kDefaultStackCapacity), reader_(stackAllocator), source_(), parseResult_(), projected_()
+    {
+        RAPIDJSON_ASSERT(paths_ != 0 || pathCount_ == 0);
+        for (SizeType i = 0; i < pathCount_; i++)
+            RAPIDJSON_ASSERT(paths_[i].IsValid());
+    }
+
+    //! Parse the values of a null-terminated text selected by the pointers.
+    /*! \tparam parseFlags Combination of \ref ParseFlag. \ref kParseInsituFlag and \ref kParseCommentsFlag are not supported.
+        \tparam Handler Type of handler, implementing Handler concept.
+        \param json Text to be parsed.
+        \param handler The handler to receive events.
+        \return Whether the parsing is successful.
+    */
+    template <unsigned parseFlags, typename Handler>
+    ParseResult Parse(const Ch* json, Handler& handler) {
+        return Project<parseFlags>(json, handler);
+    }
+
+    //! Parse the values of a null-terminated text selected by the pointers into a document.
+    /*! The document is null if the root is neither selected nor an object or array.
+        \tparam parseFlags Combination of \ref ParseFlag. \ref kParseInsituFlag and \ref kParseCommentsFlag are not supported.
+        \param json Text to be parsed.
+        \param document Document receiving the projected value. It is left unchanged on error.
+        \return Whether the parsing is successful.
+    */
+    template <unsigned parseFlags, typename DocumentEncoding, typename Allocator, typename DocumentStackAllocator>
+    ParseResult Parse(const Ch* json, GenericDocument<DocumentEncoding, Allocator, DocumentStackAllocator>& document) {
+        typedef GenericDocument<DocumentEncoding, Allocator, DocumentStackAllocator> DocumentType;
+        DocumentGenerator<parseFlags, DocumentType> generator(*this, json);
+        document.Populate(generator);
+        return parseResult_;
+    }
+
+    //! Parse with \ref kParseDefaultFlags.
+    template <typename Handler>
+    ParseResult Parse(const Ch* json, Handler& handler) {
+        return Parse<kParseDefaultFlags>(json, handler);
+    }
+
+    //!@name Handling parse errors
+    //!@{
+
+    //! Whether a parse error has occurred in the last parsing.
+    bool HasParseError() const { return parseResult_.IsError(); }
+
+    //! Get the \ref ParseErrorCode of last parsing.
+    ParseErrorCode GetParseErrorCode() const { return parseResult_.Code(); }
+
+    //! Get the position of last parsing error in input, 0 otherwise.
+    size_t GetErrorOffset() const { return parseResult_.Offset(); }
+
+    //!@}
+
+private:
+    static const size_t kDefaultStackCapacity = 256;
+
+    template <unsigned parseFlags, typename Handler>
+    ParseResult Project(const Ch* json, Handler& handler) {
+        RAPIDJSON_STATIC_ASSERT(!(parseFlags & (kParseInsituFlag | kParseCommentsFlag)));
+        RAPIDJSON_ASSERT(json != 0);
+        parseResult_.Clear();
+        source_ = json;
+        projected_ = false;
+
+        const Ch* p = SkipWhitespace(json);
+        if (*p == '\0')
+            SetError(kParseErrorDocumentEmpty, p);
+        else {
+            bool root = false;
+            for (SizeType i = 0; i < pathCount_ && !root; i++)
+                root = paths_[i].GetTokenCount() == 0;
+
+            if (root) {
+                projected_ = true;
+                p = ParseValue<parseFlags>(p, handler);
+            }
+            else if (*p == '{' || *p == '[') {
+                projected_ = true;
+                for (SizeType i = 0; i < pathCount_; i++)
+                    *stack_.template Push<SizeType>() = i;
+                p = ProjectContainer<parseFlags>(p, handler, 0, pathCount_, 0);
+            }
+            else
+                p = SkipValue(p);
+
+            if (p && !(parseFlags & kParseStopWhenDoneFlag)) {
+                p = SkipWhitespace(p);
+                if (*p != '\0')
+                    SetError(kParseErrorDocumentRootNotSingular, p);
+            }
+        }
+        stack_.Clear();
+        return parseResult_;
+    }
+
+    template <unsigned parseFlags, typename DocumentType>
+    struct DocumentGenerator {
+        DocumentGenerator(GenericProjectionReader& r, const Ch* j) : reader(r), json(j) {}
+
+        bool operator()(DocumentType& document) {
+            if (reader.template Project<parseFlags>(json, document).IsError())
+                return false;
+            if (!reader.projected_)
+                document.SetNull();
+            return reader.projected_;
+        }
+
+        GenericProjectionReader& reader;
+        const Ch* json;
+    };
+
+    // Selects the paths continuing with a member name, and forwards the name
+    // to the user handler if the value is to be projected.
+    template <typename Handler>
+    struct KeyHandler : BaseReaderHandler<Encoding, KeyHandler<Handler> > {
+        KeyHandler(GenericProjectionReader& r, Handler& h, size_t o, SizeType c, SizeType d, bool container) :
+            reader(r), handler(h), offset(o), count(c), depth(d), isContainer(container), matched(), full() {}
+
+        bool String(const Ch* str, SizeType length, bool) {
+            for (SizeType i = 0; i < count; i++) {
+                const SizeType index = reader.stack_.template Bottom<SizeType>()[offset + i];
+                const PointerType& path = reader.paths_[index];
+                const Token& token = path.GetTokens()[depth];
+                if (token.length == length && std::memcmp(token.name, str, length * sizeof(Ch)) == 0) {
+                    if (path.GetTokenCount() == depth + 1)
+                        full = true;
+                    *reader.stack_.template Push<SizeType>() = index;
+                    ++matched;
+                }
+            }
+            if (full || (matched > 0 && isContainer))
+                return handler.Key(str, length, true);
+            return true;
+        }
+
+        GenericProjectionReader& reader;
+        Handler& handler;
+        size_t offset;
+        SizeType count;
+        SizeType depth;
+        bool isContainer;
+        SizeType matched;
+        bool full;
+    };
+
+    static const Ch* SkipWhitespace(const Ch* p) {
+        GenericStringStream<Encoding> s(p);
+        RAPIDJSON_NAMESPACE::SkipWhitespace(s);
+        return s.src_;
+    }
+
+    void SetError(ParseErrorCode code, const Ch* p) {
+        if (!parseResult_.IsError())
+            parseResult_.Set(code, static_cast<size_t>(p - source_));
+    }
+
+    // Parse the value at p with the handler. Returns the position after it, or null on error.
+    template <unsigned parseFlags, typename Handler>
+    const Ch* ParseValue(const Ch* p, Handler& handler) {
+        GenericStringStream<Encoding> s(p);
+        if (reader_.template Parse<parseFlags | kParseStopWhenDoneFlag>(s, handler).IsError()) {
+            SetError(reader_.GetParseErrorCode(), p + reader_.GetErrorOffset());
+            return 0;
+        }
+        return s.src_;
+    }
+
+    // Skip the value at p. Returns the position after it, or null on error.
+    const Ch* SkipValue(const Ch* p) {
+        GenericStringStream<Encoding> s(p);
+        if (reader_.template SkipValue<kParseNoFlags>(s).IsError()) {
+            SetError(reader_.GetParseErrorCode(), p + reader_.GetErrorOffset());
+            return 0;
+        }
+        return s.src_;
+    }
+
+    // Generate the events of the object or array at p, keeping only the children
+    // selected by the paths stack_[offset, offset + count) at the given depth.
+    // Returns the position after it, or null on error.
+    template <unsigned parseFlags, typename Handler>
+    const Ch* ProjectContainer(const Ch* p, Handler& handler, size_t offset, SizeType count, SizeType depth) {
+        const bool isObject = *p == '{';
+        const Ch close = isObject ? '}' : ']';
+        const ParseErrorCode missCommaOrBracket = isObject ? kParseErrorObjectMissCommaOrCurlyBracket : kParseErrorArrayMissCommaOrSquareBracket;
+        if (!(isObject ? handler.StartObject() : handler.StartArray())) {
+            SetError(kParseErrorTermination, p);
+            return 0;
+        }
+
+        SizeType projectedCount = 0;
+        p = SkipWhitespace(p + 1);
+        if (*p != close) {
+            for (SizeType index = 0;; index++) {
+                bool projected = false;
+                p = isObject ?
+                    ProjectMember<parseFlags>(p, handler, offset, count, depth, projected) :
+                    ProjectElement<parseFlags>(p, handler, offset, count, depth, index, projected);
+                if (!p)
+                    return 0;
+                if (projected)
+                    ++projectedCount;
+
+                p = SkipWhitespace(p);
+                if (*p == ',') {
+                    p = SkipWhitespace(p + 1);
+                    if ((parseFlags & kParseTrailingCommasFlag) && *p == close)
+                        break;
+                }
+                else if (*p == close)
+                    break;
+                else {
+                    SetError(missCommaOrBracket, p);
+                    return 0;
+                }
+            }
+        }
+
+        if (!(isObject ? handler.EndObject(projectedCount) : handler.EndArray(projectedCount))) {
+            SetError(kParseErrorTermination, p);
+            return 0;
+        }
+        return p + 1;
+    }
+
+    template <unsigned parseFlags, typename Handler>
+    const Ch* ProjectMember(const Ch* p, Handler& handler, size_t offset, SizeType count, SizeType depth, bool& projected) {
+        if (*p != '"') {
+            SetError(kParseErrorObjectMissName, p);
+            return 0;
+        }
+        const Ch* name = p;
+        if ((p = SkipValue(p)) == 0)
+            return 0;
+        p = SkipWhitespace(p);
+        if (*p != ':') {
+            SetError(kParseErrorObjectMissColon, p);
+            return 0;
+        }
+        const Ch* value = SkipWhitespace(p + 1);
+        const bool isContainer = *value == '{' || *value == '[';
+
+        // The name is parsed only now that the type of the value is known.
+        const size_t childOffset = stack_.GetSize() / sizeof(SizeType);
+        KeyHandler<Handler> keyHandler(*this, handler, offset, count, depth, isContainer);
+        GenericStringStream<Encoding> s(name);
+        if (reader_.template Parse<kParseStopWhenDoneFlag | (parseFlags & kParseValidateEncodingFlag)>(s, keyHandler).IsError()) {
+            SetError(reader_.GetParseErrorCode(), name + reader_.GetErrorOffset());
+            return 0;
+        }
+
+        p = ProjectChild<parseFlags>(value, handler, childOffset, keyHandler.matched, keyHandler.full, depth, projected);
+        stack_.template Pop<SizeType>(keyHandler.matched);
+        return p;
+    }
+
+    template <unsigned parseFlags, typename Handler>
+    const Ch* ProjectElement(const Ch* p, Handler& handler, size_t offset, SizeType count, SizeType depth, SizeType index, bool& projected) {
+        const size_t childOffset = stack_.GetSize() / sizeof(SizeType);
+        SizeType matched = 0;
+        bool full = false;
+        for (SizeType i = 0; i < count; i++) {
+            const SizeType pathIndex = stack_.template Bottom<SizeType>()[offset + i];
+            const PointerType& path = paths_[pathIndex];
+            if (path.GetTokens()[depth].index == index) {
+                if (path.GetTokenCount() == depth + 1)
+                    full = true;
+                *stack_.template Push<SizeType>() = pathIndex;
+                ++matched;
+            }
+        }
+
+        p = ProjectChild<parseFlags>(p, handler, childOffset, matched, full, depth, projected);
+        stack_.template Pop<SizeType>(matched);
+        return p;
+    }
+
+    template <unsigned parseFlags, typename Handler>
+    const Ch* ProjectChild(const Ch* p, Handler& handler, size_t offset, SizeType count, bool full, SizeType depth, bool& projected) {
+        if (full) {
+            projected = true;
+            return ParseValue<parseFlags>(p, handler);
+        }
+        if (count > 0 && (*p == '{' || *p == '[')) {
+            projected = true;
+            return ProjectContainer<parseFlags>(p, handler, offset, count, depth + 1);
+        }
+        return SkipValue(p);
+    }
+
+    GenericProjectionReader(const GenericProjectionReader&);
+    GenericProjectionReader& operator=(const GenericProjectionReader&);
+
+    const PointerType* paths_;
+    SizeType pathCount_;
+    internal::Stack<StackAllocator> stack_;     //!< Indices of the paths selecting each level being projected.
+    GenericReader<Encoding, Encoding, StackAllocator> reader_;
+    const Ch* source_;                          //!< Text being parsed.
+    ParseResult parseResult_;
+    bool projected_;                            //!< Whether the root generated events.
+};
+
+//! GenericProjectionReader with UTF8 encoding
+typedef GenericProjectionReader<Pointer> ProjectionReader;
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_PROJECTION_H_
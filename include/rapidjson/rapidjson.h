@@ -325,39 +325,110 @@
 #endif
 
 ///////////////////////////////////////////////////////////////////////////////
-// RAPIDJSON_SSE2/RAPIDJSON_SSE42/RAPIDJSON_NEON/RAPIDJSON_SIMD
+// RAPIDJSON_MEMBER_HASH_INDEX
+
+//! Find the members of large objects with a hash index.
+/*!
+    \ingroup RAPIDJSON_CONFIG
+
+    By default, \c GenericValue::FindMember() compares the name with every member.
+    If this macro is defined to 1, the members of an object with a capacity of at least
+    \ref RAPIDJSON_MEMBER_HASH_INDEX_THRESHOLD are preceded by a small header. The first
+    lookup in such an object with at least as many members builds a hash index of the
+    names with the object's allocator. AddMember(), RemoveMember(), EraseMember() and
+    RemoveAllMembers() maintain the index afterwards.
+
+    \note As the first lookup builds the index, a large object shared by several
+          threads must be looked up once before the threads do so concurrently.
+          Renaming a member through an iterator does not update the index.
+*/
+#ifndef RAPIDJSON_MEMBER_HASH_INDEX
+#define RAPIDJSON_MEMBER_HASH_INDEX 0
+#endif
+
+//! Minimum number of members of an object to be indexed with \ref RAPIDJSON_MEMBER_HASH_INDEX.
+/*! \ingroup RAPIDJSON_CONFIG
+*/
+#ifndef RAPIDJSON_MEMBER_HASH_INDEX_THRESHOLD
+#define RAPIDJSON_MEMBER_HASH_INDEX_THRESHOLD 32
+#endif
+
+#if RAPIDJSON_MEMBER_HASH_INDEX_THRESHOLD < 1
+#error RAPIDJSON_MEMBER_HASH_INDEX_THRESHOLD must be positive
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// RAPIDJSON_DTOA_SHORTEST
+
+//! Write doubles with the shortest digits which round-trip.
+/*!
+    \ingroup RAPIDJSON_CONFIG
+
+    By default, \c Writer formats a double with the Grisu2 algorithm, which
+    round-trips, but may give more digits than needed (e.g. "4.1752050594835008e78"
+    for 4.1752050594835e78) or not the closest of the shortest ones.
+    If this macro is defined to 1, the Ryu algorithm is used instead. It always
+    gives the shortest digits which round-trip, and of those the closest to the
+    value. It is also faster, with tables of 10.7 KB.
+*/
+#ifndef RAPIDJSON_DTOA_SHORTEST
+#define RAPIDJSON_DTOA_SHORTEST 0
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// RAPIDJSON_SSE2/RAPIDJSON_SSE42/RAPIDJSON_AVX2/RAPIDJSON_AVX512/RAPIDJSON_NEON/RAPIDJSON_SIMD_DISPATCH/RAPIDJSON_SIMD
 
 /*! \def RAPIDJSON_SIMD
     \ingroup RAPIDJSON_CONFIG
-    \brief Enable SSE2/SSE4.2/Neon optimization.
+    \brief Enable SSE2/SSE4.2/AVX2/AVX-512/Neon optimization.
 
     RapidJSON supports optimized implementations for some parsing operations
-    based on the SSE2, SSE4.2 or NEon SIMD extensions on modern Intel
+    based on the SSE2, SSE4.2, AVX2, AVX-512 or NEon SIMD extensions on modern Intel
     or ARM compatible processors.
 
-    To enable these optimizations, three different symbols can be defined;
+    To enable these optimizations, five different symbols can be defined;
     \code
     // Enable SSE2 optimization.
     #define RAPIDJSON_SSE2
 
     // Enable SSE4.2 optimization.
     #define RAPIDJSON_SSE42
-    \endcode
+
+    // Enable AVX2 optimization (32 bytes per step).
+    #define RAPIDJSON_AVX2
+
+    // Enable AVX-512 optimization (64 bytes per step, requires AVX-512BW).
+    #define RAPIDJSON_AVX512
 
     // Enable ARM Neon optimization.
     #define RAPIDJSON_NEON
     \endcode
 
-    \c RAPIDJSON_SSE42 takes precedence over SSE2, if both are defined.
+    \c RAPIDJSON_AVX512 takes precedence over AVX2, which takes precedence over
+    SSE4.2, which in turn takes precedence over SSE2, if several are defined.
+
+    On x86 and x86-64, \c RAPIDJSON_SIMD_DISPATCH may be defined instead. All of
+    the SSE2/SSE4.2/AVX2/AVX-512 code paths are then compiled into the binary
+    (with per-function target attributes on gcc and clang) and the best one
+    supported by the running processor is selected once, on first use. This
+    allows a single binary to be deployed on machines of different generations.
+    The selected level can be queried with \c GetSimdLevel() and forced with
+    \c SetSimdLevel(), e.g. for benchmarking.
 
     If any of these symbols is defined, RapidJSON defines the macro
     \c RAPIDJSON_SIMD to indicate the availability of the optimized code.
 */
 #if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42) \
-    || defined(RAPIDJSON_NEON) || defined(RAPIDJSON_DOXYGEN_RUNNING)
+    || defined(RAPIDJSON_AVX2) || defined(RAPIDJSON_AVX512) \
+    || defined(RAPIDJSON_NEON) || defined(RAPIDJSON_SIMD_DISPATCH) \
+    || defined(RAPIDJSON_DOXYGEN_RUNNING)
 #define RAPIDJSON_SIMD
 #endif
 
+#if defined(RAPIDJSON_SIMD_DISPATCH) && !(defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64))
+#error RAPIDJSON_SIMD_DISPATCH is only supported on x86 and x86-64
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // RAPIDJSON_NO_SIZETYPEDEFINE
 
@@ -596,6 +667,16 @@ RAPIDJSON_NAMESPACE_END
 #endif
 #endif // RAPIDJSON_HAS_CXX11_RANGE_FOR
 
+// <atomic>, <thread> and thread_local
+#ifndef RAPIDJSON_HAS_CXX11_THREADS
+#if (defined(__cplusplus) && __cplusplus >= 201103L) || \
+    (defined(_MSC_VER) && _MSC_VER >= 1900)
+#define RAPIDJSON_HAS_CXX11_THREADS 1
+#else
+#define RAPIDJSON_HAS_CXX11_THREADS 0
+#endif
+#endif // RAPIDJSON_HAS_CXX11_THREADS
+
 //!@endcond
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -23,17 +23,11 @@
 #include "internal/meta.h"
 #include "internal/stack.h"
 #include "internal/strtod.h"
+#include "internal/simd.h"
+#include "internal/structural.h"
 #include <limits>
 
-#if defined(RAPIDJSON_SIMD) && defined(_MSC_VER)
-#include <intrin.h>
-#pragma intrinsic(_BitScanForward)
-#endif
-#ifdef RAPIDJSON_SSE42
-#include <nmmintrin.h>
-#elif defined(RAPIDJSON_SSE2)
-#include <emmintrin.h>
-#elif defined(RAPIDJSON_NEON)
+#if defined(RAPIDJSON_NEON)
 #include <arm_neon.h>
 #endif
 
@@ -153,6 +147,8 @@ enum ParseFlag {
     kParseNumbersAsStringsFlag = 64,    //!< Parse all numbers (ints/doubles) as strings.
     kParseTrailingCommasFlag = 128, //!< Allow trailing commas at the end of objects and arrays.
     kParseNanAndInfFlag = 256,      //!< Allow parsing NaN, Inf, Infinity, -Inf and -Infinity as doubles.
+    kParseStructuralIndexFlag = 512,    //!< Index the structural characters of (insitu) string streams with SIMD first, then parse from the index. Ignored with kParseIterativeFlag and kParseCommentsFlag.
+    kParseReferenceSourceFlag = 1024,   //!< Pass strings without escapes of a (non-insitu) string stream as references into the source (copy = false). They are not null-terminated. The source must outlive the parsed values. Streams derived from a string stream, such as MemoryMappedFileStream, ignore it unless passed as the string stream (GetStringStream()).
     kParseDefaultFlags = RAPIDJSON_PARSE_DEFAULT_FLAGS  //!< Default parse flags. Can be customized by defining RAPIDJSON_PARSE_DEFAULT_FLAGS
 };
 
@@ -258,7 +254,7 @@ private:
 
 //! Skip the JSON white spaces in a stream.
 /*! \param is A input stream for skipping white spaces.
-    \note This function has SSE2/SSE4.2 specialization.
+    \note This function has SSE2/SSE4.2/AVX2/AVX-512 specialization.
 */
 template<typename InputStream>
 void SkipWhitespace(InputStream& is) {
@@ -276,139 +272,15 @@ inline const char* SkipWhitespace(const char* p, const char* end) {
     return p;
 }
 
-#ifdef RAPIDJSON_SSE42
-//! Skip whitespace with SSE 4.2 pcmpistrm instruction, testing 16 8-byte characters at once.
-inline const char *SkipWhitespace_SIMD(const char* p) {
-    // Fast return for single non-whitespace
-    if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
-        ++p;
-    else
-        return p;
-
-    // 16-byte align to the next boundary
-    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
-    while (p != nextAligned)
-        if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
-            ++p;
-        else
-            return p;
-
-    // The rest of string using SIMD
-    static const char whitespace[16] = " \n\r\t";
-    const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespace[0]));
-
-    for (;; p += 16) {
-        const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
-        const int r = _mm_cmpistri(w, s, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT | _SIDD_NEGATIVE_POLARITY);
-        if (r != 16)    // some of characters is non-whitespace
-            return p + r;
-    }
-}
+#if defined(RAPIDJSON_SIMD_X86)
 
-inline const char *SkipWhitespace_SIMD(const char* p, const char* end) {
-    // Fast return for single non-whitespace
-    if (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
-        ++p;
-    else
-        return p;
-
-    // The middle of string using SIMD
-    static const char whitespace[16] = " \n\r\t";
-    const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespace[0]));
-
-    for (; p <= end - 16; p += 16) {
-        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
-        const int r = _mm_cmpistri(w, s, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT | _SIDD_NEGATIVE_POLARITY);
-        if (r != 16)    // some of characters is non-whitespace
-            return p + r;
-    }
-
-    return SkipWhitespace(p, end);
-}
-
-#elif defined(RAPIDJSON_SSE2)
-
-//! Skip whitespace with SSE2 instructions, testing 16 8-byte characters at once.
+//! Skip whitespace with the x86 SIMD kernel chosen at compile time, or at runtime with RAPIDJSON_SIMD_DISPATCH.
 inline const char *SkipWhitespace_SIMD(const char* p) {
-    // Fast return for single non-whitespace
-    if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
-        ++p;
-    else
-        return p;
-
-    // 16-byte align to the next boundary
-    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
-    while (p != nextAligned)
-        if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
-            ++p;
-        else
-            return p;
-
-    // The rest of string
-    #define C16(c) { c, c, c, c, c, c, c, c, c, c, c, c, c, c, c, c }
-    static const char whitespaces[4][16] = { C16(' '), C16('\n'), C16('\r'), C16('\t') };
-    #undef C16
-
-    const __m128i w0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespaces[0][0]));
-    const __m128i w1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespaces[1][0]));
-    const __m128i w2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespaces[2][0]));
-    const __m128i w3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespaces[3][0]));
-
-    for (;; p += 16) {
-        const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
-        __m128i x = _mm_cmpeq_epi8(s, w0);
-        x = _mm_or_si128(x, _mm_cmpeq_epi8(s, w1));
-        x = _mm_or_si128(x, _mm_cmpeq_epi8(s, w2));
-        x = _mm_or_si128(x, _mm_cmpeq_epi8(s, w3));
-        unsigned short r = static_cast<unsigned short>(~_mm_movemask_epi8(x));
-        if (r != 0) {   // some of characters may be non-whitespace
-#ifdef _MSC_VER         // Find the index of first non-whitespace
-            unsigned long offset;
-            _BitScanForward(&offset, r);
-            return p + offset;
-#else
-            return p + __builtin_ffs(r) - 1;
-#endif
-        }
-    }
+    return internal::SimdSkipWhitespace(p);
 }
 
 inline const char *SkipWhitespace_SIMD(const char* p, const char* end) {
-    // Fast return for single non-whitespace
-    if (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
-        ++p;
-    else
-        return p;
-
-    // The rest of string
-    #define C16(c) { c, c, c, c, c, c, c, c, c, c, c, c, c, c, c, c }
-    static const char whitespaces[4][16] = { C16(' '), C16('\n'), C16('\r'), C16('\t') };
-    #undef C16
-
-    const __m128i w0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespaces[0][0]));
-    const __m128i w1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespaces[1][0]));
-    const __m128i w2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespaces[2][0]));
-    const __m128i w3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespaces[3][0]));
-
-    for (; p <= end - 16; p += 16) {
-        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
-        __m128i x = _mm_cmpeq_epi8(s, w0);
-        x = _mm_or_si128(x, _mm_cmpeq_epi8(s, w1));
-        x = _mm_or_si128(x, _mm_cmpeq_epi8(s, w2));
-        x = _mm_or_si128(x, _mm_cmpeq_epi8(s, w3));
-        unsigned short r = static_cast<unsigned short>(~_mm_movemask_epi8(x));
-        if (r != 0) {   // some of characters may be non-whitespace
-#ifdef _MSC_VER         // Find the index of first non-whitespace
-            unsigned long offset;
-            _BitScanForward(&offset, r);
-            return p + offset;
-#else
-            return p + __builtin_ffs(r) - 1;
-#endif
-        }
-    }
-
-    return SkipWhitespace(p, end);
+    return internal::SimdSkipWhitespace(p, end);
 }
 
 #elif defined(RAPIDJSON_NEON)
@@ -558,6 +430,9 @@ public:
         if (parseFlags & kParseIterativeFlag)
             return IterativeParse<parseFlags>(is, handler);
 
+        if (parseFlags & kParseStructuralIndexFlag)
+            return StructuralParse<parseFlags>(is, handler);
+
         parseResult_.Clear();
 
         ClearStackOnExit scope(*this);
@@ -599,6 +474,30 @@ public:
         return Parse<kParseDefaultFlags>(is, handler);
     }
 
+    //! Skip a JSON value without generating events.
+    /*! Only the quotes of strings and the brackets of objects and arrays are
+        tracked, so this is much faster than parsing, but the content of the
+        value is not validated. A string stream is scanned with SIMD.
+        \tparam parseFlags Combination of \ref ParseFlag. Only \ref kParseCommentsFlag matters,
+                before the value.
+        \tparam InputStream Type of input stream, implementing Stream concept
+        \param is Input stream, positioned after the value on success.
+        \return Whether a complete value is found.
+    */
+    template <unsigned parseFlags, typename InputStream>
+    ParseResult SkipValue(InputStream& is) {
+        parseResult_.Clear();
+        SkipWhitespaceAndComments<parseFlags>(is);
+        RAPIDJSON_PARSE_ERROR_EARLY_RETURN(parseResult_);
+        switch (is.Peek()) {
+            case '{':
+            case '[': SkipContainer(is); break;
+            case '"': SkipString(is); break;
+            default: SkipScalar(is); break;
+        }
+        return parseResult_;
+    }
+
     //! Initialize JSON text token-by-token parsing
     /*!
      */
@@ -705,6 +604,92 @@ private:
         ClearStackOnExit& operator=(const ClearStackOnExit&);
     };
 
+    // Skip an object or array by counting the brackets outside strings.
+    template<typename InputStream>
+    void SkipContainer(InputStream& is) {
+        const Ch open = is.Peek();
+        size_t depth = 0;
+        for (;;) {
+            const Ch c = is.Peek();
+            if (c == '{' || c == '[')
+                ++depth;
+            else if (c == '}' || c == ']') {
+                if (--depth == 0) {
+                    is.Take();
+                    return;
+                }
+            }
+            else if (c == '"') {
+                SkipString(is);
+                RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+                continue;
+            }
+            else if (c == '\0')
+                RAPIDJSON_PARSE_ERROR(open == '{' ? kParseErrorObjectMissCommaOrCurlyBracket : kParseErrorArrayMissCommaOrSquareBracket, is.Tell());
+            is.Take();
+        }
+    }
+
+    void SkipContainer(StringStream& is) {
+        const char* end = internal::SkipContainer(is.src_);
+        if (RAPIDJSON_UNLIKELY(!end)) {
+            const bool object = *is.src_ == '{';
+            is.src_ += std::strlen(is.src_);
+            RAPIDJSON_PARSE_ERROR(object ? kParseErrorObjectMissCommaOrCurlyBracket : kParseErrorArrayMissCommaOrSquareBracket, is.Tell());
+        }
+        is.src_ = end;
+    }
+
+    // Skip a string, including the quotes, without decoding or validating it.
+    template<typename InputStream>
+    void SkipString(InputStream& is) {
+        RAPIDJSON_ASSERT(is.Peek() == '\"');
+        is.Take();
+        for (;;) {
+            const Ch c = is.Peek();
+            if (c == '\"') {
+                is.Take();
+                return;
+            }
+            if (RAPIDJSON_UNLIKELY(c == '\0'))
+                RAPIDJSON_PARSE_ERROR(kParseErrorStringMissQuotationMark, is.Tell());
+            is.Take();
+            if (c == '\\' && is.Peek() != '\0')
+                is.Take();
+        }
+    }
+
+    void SkipString(StringStream& is) {
+        RAPIDJSON_ASSERT(*is.src_ == '\"');
+        const char* p = is.src_ + 1;
+        for (;;) {
+            p = ScanUnescapedString(p);
+            if (*p == '\"')
+                break;
+            if (RAPIDJSON_UNLIKELY(*p == '\0')) {
+                is.src_ = p;
+                RAPIDJSON_PARSE_ERROR(kParseErrorStringMissQuotationMark, is.Tell());
+            }
+            p += (*p == '\\' && p[1] != '\0') ? 2 : 1;
+        }
+        is.src_ = p + 1;
+    }
+
+    // Skip a number or literal up to the next whitespace or structural character.
+    template<typename InputStream>
+    void SkipScalar(InputStream& is) {
+        const size_t begin = is.Tell();
+        for (;;) {
+            const Ch c = is.Peek();
+            if (c == '\0' || c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == ',' || c == ':' ||
+                c == ']' || c == '}' || c == '[' || c == '{' || c == '\"')
+                break;
+            is.Take();
+        }
+        if (RAPIDJSON_UNLIKELY(is.Tell() == begin))
+            RAPIDJSON_PARSE_ERROR(is.Peek() == '\0' ? kParseErrorDocumentEmpty : kParseErrorValueInvalid, begin);
+    }
+
     template<unsigned parseFlags, typename InputStream>
     void SkipWhitespaceAndComments(InputStream& is) {
         SkipWhitespace(is);
@@ -971,6 +956,10 @@ private:
             const typename TargetEncoding::Ch* const str = reinterpret_cast<typename TargetEncoding::Ch*>(head);
             success = (isKey ? handler.Key(str, SizeType(length), false) : handler.String(str, SizeType(length), false));
         }
+        else if ((parseFlags & kParseReferenceSourceFlag) &&
+                 ParseStringReference<parseFlags>(s, handler, isKey, success, typename internal::IsSame<SourceEncoding, TargetEncoding>::Type())) {
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+        }
         else {
             StackStream<typename TargetEncoding::Ch> stackStream(stack_);
             ParseStringToStream<parseFlags, SourceEncoding, TargetEncoding>(s, stackStream);
@@ -983,6 +972,48 @@ private:
             RAPIDJSON_PARSE_ERROR(kParseErrorTermination, s.Tell());
     }
 
+    // Pass a string without escapes as a reference into the source (kParseReferenceSourceFlag).
+    // Returns false, with the stream unchanged, if the string needs to be unescaped (or validated) into a copy.
+    template<unsigned parseFlags, typename Handler>
+    bool ParseStringReference(GenericStringStream<SourceEncoding>& is, Handler& handler, bool isKey, bool& success, internal::TrueType) {
+        const Ch* const head = is.src_;
+        const Ch* p = head;
+        if (parseFlags & kParseValidateEncodingFlag) {
+            // ASCII is valid in any encoding, leave the rest to validation
+            while (*p != '\"' && *p != '\\' && static_cast<unsigned>(*p) >= 0x20 && static_cast<unsigned>(*p) < 0x80)
+                ++p;
+        }
+        else
+            p = ScanUnescapedString(p);
+
+        if (RAPIDJSON_UNLIKELY(*p != '\"'))
+            return false;
+
+        is.src_ = p + 1;    // Skip '\"'
+        const SizeType length = static_cast<SizeType>(p - head);
+        success = (isKey ? handler.Key(head, length, false) : handler.String(head, length, false));
+        return true;
+    }
+
+    template<unsigned parseFlags, typename InputStream, typename Handler, typename SameEncoding>
+    bool ParseStringReference(InputStream&, Handler&, bool, bool&, SameEncoding) {
+        return false;
+    }
+
+    // Find the end of the unescaped characters from p, i.e. the first '\"', '\\' or control character.
+    template<typename CharType>
+    static RAPIDJSON_FORCEINLINE const CharType* ScanUnescapedString(const CharType* p) {
+        while (*p != '\"' && *p != '\\' && static_cast<unsigned>(*p) >= 0x20)
+            ++p;
+        return p;
+    }
+
+#if defined(RAPIDJSON_SIMD_X86)
+    static RAPIDJSON_FORCEINLINE const char* ScanUnescapedString(const char* p) {
+        return internal::SimdScanUnescapedString(p);
+    }
+#endif
+
     // Parse string to an output is
     // This function handles the prefix/suffix double quotes, escaping, and optional encoding validation.
     template<unsigned parseFlags, typename SEncoding, typename TEncoding, typename InputStream, typename OutputStream>
@@ -1058,58 +1089,15 @@ private:
             // Do nothing for generic version
     }
 
-#if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
+#if defined(RAPIDJSON_SIMD_X86)
     // StringStream -> StackStream<char>
     static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(StringStream& is, StackStream<char>& os) {
         const char* p = is.src_;
-
-        // Scan one by one until alignment (unaligned load may cross page boundary and cause crash)
-        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
-        while (p != nextAligned)
-            if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20)) {
-                is.src_ = p;
-                return;
-            }
-            else
-                os.Put(*p++);
-
-        // The rest of string using SIMD
-        static const char dquote[16] = { '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"' };
-        static const char bslash[16] = { '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\' };
-        static const char space[16]  = { 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F };
-        const __m128i dq = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&dquote[0]));
-        const __m128i bs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&bslash[0]));
-        const __m128i sp = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&space[0]));
-
-        for (;; p += 16) {
-            const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
-            const __m128i t1 = _mm_cmpeq_epi8(s, dq);
-            const __m128i t2 = _mm_cmpeq_epi8(s, bs);
-            const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
-            const __m128i x = _mm_or_si128(_mm_or_si128(t1, t2), t3);
-            unsigned short r = static_cast<unsigned short>(_mm_movemask_epi8(x));
-            if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
-                SizeType length;
-    #ifdef _MSC_VER         // Find the index of first escaped
-                unsigned long offset;
-                _BitScanForward(&offset, r);
-                length = offset;
-    #else
-                length = static_cast<SizeType>(__builtin_ffs(r) - 1);
-    #endif
-                if (length != 0) {
-                    char* q = reinterpret_cast<char*>(os.Push(length));
-                    for (size_t i = 0; i < length; i++)
-                        q[i] = p[i];
-
-                    p += length;
-                }
-                break;
-            }
-            _mm_storeu_si128(reinterpret_cast<__m128i *>(os.Push(16)), s);
-        }
-
-        is.src_ = p;
+        const char* end = internal::SimdScanUnescapedString(p);
+        const SizeType length = static_cast<SizeType>(end - p);
+        if (length != 0)
+            std::memcpy(os.Push(length), p, length);
+        is.src_ = end;
     }
 
     // InsituStringStream -> InsituStringStream
@@ -1123,97 +1111,17 @@ private:
         }
 
         char* p = is.src_;
-        char *q = is.dst_;
-
-        // Scan one by one until alignment (unaligned load may cross page boundary and cause crash)
-        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
-        while (p != nextAligned)
-            if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20)) {
-                is.src_ = p;
-                is.dst_ = q;
-                return;
-            }
-            else
-                *q++ = *p++;
-
-        // The rest of string using SIMD
-        static const char dquote[16] = { '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"' };
-        static const char bslash[16] = { '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\' };
-        static const char space[16] = { 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F };
-        const __m128i dq = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&dquote[0]));
-        const __m128i bs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&bslash[0]));
-        const __m128i sp = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&space[0]));
-
-        for (;; p += 16, q += 16) {
-            const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
-            const __m128i t1 = _mm_cmpeq_epi8(s, dq);
-            const __m128i t2 = _mm_cmpeq_epi8(s, bs);
-            const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
-            const __m128i x = _mm_or_si128(_mm_or_si128(t1, t2), t3);
-            unsigned short r = static_cast<unsigned short>(_mm_movemask_epi8(x));
-            if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
-                size_t length;
-#ifdef _MSC_VER         // Find the index of first escaped
-                unsigned long offset;
-                _BitScanForward(&offset, r);
-                length = offset;
-#else
-                length = static_cast<size_t>(__builtin_ffs(r) - 1);
-#endif
-                for (const char* pend = p + length; p != pend; )
-                    *q++ = *p++;
-                break;
-            }
-            _mm_storeu_si128(reinterpret_cast<__m128i *>(q), s);
-        }
-
-        is.src_ = p;
-        is.dst_ = q;
+        char* end = const_cast<char*>(internal::SimdScanUnescapedString(p));
+        const size_t length = static_cast<size_t>(end - p);
+        std::memmove(is.dst_, p, length);   // dst_ is behind src_, ranges may overlap
+        is.src_ = end;
+        is.dst_ += length;
     }
 
     // When read/write pointers are the same for insitu stream, just skip unescaped characters
     static RAPIDJSON_FORCEINLINE void SkipUnescapedString(InsituStringStream& is) {
         RAPIDJSON_ASSERT(is.src_ == is.dst_);
-        char* p = is.src_;
-
-        // Scan one by one until alignment (unaligned load may cross page boundary and cause crash)
-        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
-        for (; p != nextAligned; p++)
-            if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20)) {
-                is.src_ = is.dst_ = p;
-                return;
-            }
-
-        // The rest of string using SIMD
-        static const char dquote[16] = { '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"' };
-        static const char bslash[16] = { '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\' };
-        static const char space[16] = { 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F };
-        const __m128i dq = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&dquote[0]));
-        const __m128i bs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&bslash[0]));
-        const __m128i sp = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&space[0]));
-
-        for (;; p += 16) {
-            const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
-            const __m128i t1 = _mm_cmpeq_epi8(s, dq);
-            const __m128i t2 = _mm_cmpeq_epi8(s, bs);
-            const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
-            const __m128i x = _mm_or_si128(_mm_or_si128(t1, t2), t3);
-            unsigned short r = static_cast<unsigned short>(_mm_movemask_epi8(x));
-            if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
-                size_t length;
-#ifdef _MSC_VER         // Find the index of first escaped
-                unsigned long offset;
-                _BitScanForward(&offset, r);
-                length = offset;
-#else
-                length = static_cast<size_t>(__builtin_ffs(r) - 1);
-#endif
-                p += length;
-                break;
-            }
-        }
-
-        is.src_ = is.dst_ = p;
+        is.src_ = is.dst_ = const_cast<char*>(internal::SimdScanUnescapedString(is.src_));
     }
 #elif defined(RAPIDJSON_NEON)
     // StringStream -> StackStream<char>
@@ -1390,6 +1298,26 @@ private:
     }
 #endif // RAPIDJSON_NEON
 
+    // Take up to 8 digits at once, for streams of contiguous characters.
+    template<typename InputStream>
+    static RAPIDJSON_FORCEINLINE unsigned ParseDigits(InputStream&, uint32_t*) {
+        return 0;   // Do nothing for generic version
+    }
+
+#if defined(RAPIDJSON_SIMD) && defined(RAPIDJSON_SIMD_SWAR_DIGITS)
+    static RAPIDJSON_FORCEINLINE unsigned ParseDigits(StringStream& is, uint32_t* value) {
+        const unsigned n = internal::SimdParseDigits8(is.src_, value);
+        is.src_ += n;
+        return n;
+    }
+
+    static RAPIDJSON_FORCEINLINE unsigned ParseDigits(InsituStringStream& is, uint32_t* value) {
+        const unsigned n = internal::SimdParseDigits8(is.src_, value);
+        is.src_ += n;
+        return n;
+    }
+#endif
+
     template<typename InputStream, bool backup, bool pushOnTake>
     class NumberStream;
 
@@ -1405,6 +1333,8 @@ private:
         RAPIDJSON_FORCEINLINE Ch Take() { return is.Take(); }
 		  RAPIDJSON_FORCEINLINE void Push(char) {}
 
+        RAPIDJSON_FORCEINLINE unsigned TakeDigits(uint32_t* value) { return ParseDigits(is, value); }
+
         size_t Tell() { return is.Tell(); }
         size_t Length() { return 0; }
         const char* Pop() { return 0; }
@@ -1430,6 +1360,8 @@ private:
             stackStream.Put(c);
         }
 
+        RAPIDJSON_FORCEINLINE unsigned TakeDigits(uint32_t*) { return 0; }  // Digits are pushed one by one
+
         size_t Length() { return stackStream.Length(); }
 
         const char* Pop() {
@@ -1468,10 +1400,13 @@ private:
         bool minus = Consume(s, '-');
 
         // Parse int: zero / ( digit1-9 *DIGIT )
+        static const unsigned kPow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
         unsigned i = 0;
         uint64_t i64 = 0;
         bool use64bit = false;
         int significandDigit = 0;
+        uint32_t digits;
+        unsigned digitCount;
         if (RAPIDJSON_UNLIKELY(s.Peek() == '0')) {
             i = 0;
             s.TakePush();
@@ -1479,6 +1414,12 @@ private:
         else if (RAPIDJSON_LIKELY(s.Peek() >= '1' && s.Peek() <= '9')) {
             i = static_cast<unsigned>(s.TakePush() - '0');
 
+            // 9 digits cannot overflow
+            if ((digitCount = s.TakeDigits(&digits)) != 0) {
+                i = i * kPow10[digitCount] + digits;
+                significandDigit += static_cast<int>(digitCount);
+            }
+
             if (minus)
                 while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
                     if (RAPIDJSON_UNLIKELY(i >= 214748364)) { // 2^31 = 2147483648
@@ -1534,6 +1475,11 @@ private:
         // Parse 64bit int
         bool useDouble = false;
         if (use64bit) {
+            // i64 has at most 10 digits, 18 cannot overflow
+            if ((digitCount = s.TakeDigits(&digits)) != 0) {
+                i64 = i64 * kPow10[digitCount] + digits;
+                significandDigit += static_cast<int>(digitCount);
+            }
             if (minus)
                 while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
                      if (RAPIDJSON_UNLIKELY(i64 >= RAPIDJSON_UINT64_C2(0x0CCCCCCC, 0xCCCCCCCC))) // 2^63 = 9223372036854775808
@@ -1748,6 +1694,300 @@ private:
         }
     }
 
+    // Structural index parsing (kParseStructuralIndexFlag)
+    //
+    // internal::StructuralIndex finds the beginning of every token with SIMD,
+    // then objects and arrays are parsed by walking through the index.
+    // Strings without escapes or control characters are passed to the handler
+    // directly from their indexed quotes. Other strings, numbers and literals
+    // are parsed by the usual routines from their indexed positions. Every
+    // such token must end at the next indexed position, possibly followed by
+    // whitespace, otherwise the text in between is reported as an error of
+    // the enclosing value.
+
+    // Only null-terminated UTF-8 text in memory can be indexed.
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    ParseResult StructuralParse(InputStream& is, Handler& handler) {
+        return Parse<parseFlags & ~static_cast<unsigned>(kParseStructuralIndexFlag)>(is, handler);
+    }
+
+    template<unsigned parseFlags, typename Handler>
+    ParseResult StructuralParse(StringStream& is, Handler& handler) {
+        return StructuralParseRoot<parseFlags>(is, handler, internal::IsSame<SourceEncoding, UTF8<> >());
+    }
+
+    template<unsigned parseFlags, typename Handler>
+    ParseResult StructuralParse(InsituStringStream& is, Handler& handler) {
+        return StructuralParseRoot<parseFlags>(is, handler, internal::IsSame<SourceEncoding, UTF8<> >());
+    }
+
+    typedef internal::StructuralIndex<StackAllocator> StructuralIndex;
+
+    template<typename InputStream>
+    static void StructuralSeek(InputStream& is, const char* p) {
+        is.src_ = const_cast<typename InputStream::Ch*>(p);
+    }
+
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    ParseResult StructuralParseRoot(InputStream& is, Handler& handler, internal::FalseType) {
+        return Parse<parseFlags & ~static_cast<unsigned>(kParseStructuralIndexFlag)>(is, handler);
+    }
+
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    ParseResult StructuralParseRoot(InputStream& is, Handler& handler, internal::TrueType) {
+        if (parseFlags & kParseCommentsFlag)
+            return Parse<parseFlags & ~static_cast<unsigned>(kParseStructuralIndexFlag)>(is, handler);
+
+        parseResult_.Clear();
+
+        ClearStackOnExit scope(*this);
+        StructuralIndex index(is.src_, stack_);
+
+        const char* p = index.Current();
+        if (RAPIDJSON_UNLIKELY(*p == '\0')) {
+            StructuralSeek(is, p);
+            RAPIDJSON_PARSE_ERROR_NORETURN(kParseErrorDocumentEmpty, is.Tell());
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN(parseResult_);
+        }
+        else if ((parseFlags & kParseStopWhenDoneFlag) && *p != '{' && *p != '[') {
+            // Nothing after a single root value needs to be checked (or indexed)
+            StructuralSeek(is, p);
+            ParseValue<parseFlags>(is, handler);
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN(parseResult_);
+        }
+        else {
+            StructuralParseValue<parseFlags>(is, index, handler);
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN(parseResult_);
+
+            if (!(parseFlags & kParseStopWhenDoneFlag)) {
+                p = index.Current();
+                StructuralSeek(is, p);
+                if (RAPIDJSON_UNLIKELY(*p != '\0')) {
+                    RAPIDJSON_PARSE_ERROR_NORETURN(kParseErrorDocumentRootNotSingular, is.Tell());
+                    RAPIDJSON_PARSE_ERROR_EARLY_RETURN(parseResult_);
+                }
+            }
+        }
+
+        return parseResult_;
+    }
+
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    void StructuralParseValue(InputStream& is, StructuralIndex& index, Handler& handler) {
+        switch (*index.Current()) {
+            case '{': StructuralParseObject<parseFlags>(is, index, handler); break;
+            case '[': StructuralParseArray <parseFlags>(is, index, handler); break;
+            case '"': StructuralParseString<parseFlags>(is, index, handler, false); break;
+            default : StructuralParseScalar<parseFlags>(is, index, handler); break;
+        }
+    }
+
+    // Parse a string from its opening quote at the current token to the closing quote at the next one.
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    void StructuralParseString(InputStream& is, StructuralIndex& index, Handler& handler, bool isKey) {
+        const char* p = index.Current();
+        bool plain;
+        const char* q = index.StringEnd(plain);
+
+        if (!(plain && !(parseFlags & kParseValidateEncodingFlag) &&
+              StructuralParsePlainString<parseFlags>(is, handler, p, q, isKey, internal::IsSame<SourceEncoding, TargetEncoding>()))) {
+            StructuralSeek(is, p);
+            ParseString<parseFlags>(is, handler, isKey);
+        }
+        RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+        RAPIDJSON_ASSERT(is.src_ == q + 1);
+
+        index.Advance(2);
+        StructuralCheckEnd(is, index);
+    }
+
+    // Pass a string without escapes between the quotes p and q as it is. Returns false if it needs transcoding.
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    bool StructuralParsePlainString(InputStream& is, Handler& handler, const char* p, const char* q, bool isKey, internal::TrueType) {
+        const SizeType length = static_cast<SizeType>(q - p - 1);
+        bool success;
+        if (parseFlags & kParseInsituFlag) {
+            Ch* str = const_cast<Ch*>(p + 1);
+            str[length] = '\0';
+            success = (isKey ? handler.Key(str, length, false) : handler.String(str, length, false));
+        }
+        else if (parseFlags & kParseReferenceSourceFlag) {
+            const Ch* str = p + 1;
+            success = (isKey ? handler.Key(str, length, false) : handler.String(str, length, false));
+        }
+        else {
+            Ch* str = stack_.template Push<Ch>(length + 1);
+            std::memcpy(str, p + 1, length);
+            str[length] = '\0';
+            stack_.template Pop<Ch>(length + 1);
+            success = (isKey ? handler.Key(str, length, true) : handler.String(str, length, true));
+        }
+        StructuralSeek(is, q + 1);
+        if (RAPIDJSON_UNLIKELY(!success))
+            RAPIDJSON_PARSE_ERROR_NORETURN(kParseErrorTermination, is.Tell());
+        return true;
+    }
+
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    bool StructuralParsePlainString(InputStream&, Handler&, const char*, const char*, bool, internal::FalseType) {
+        return false;
+    }
+
+    // Parse a number or literal at the current token.
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    void StructuralParseScalar(InputStream& is, StructuralIndex& index, Handler& handler) {
+        index.Next();   // index the token before it is modified by in-situ parsing
+        StructuralSeek(is, index.Current());
+        index.Advance();
+        ParseValue<parseFlags>(is, handler);
+        RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+        StructuralCheckEnd(is, index);
+    }
+
+    // Make the text after a scalar the current token, unless it is whitespace up to the current token.
+    template<typename InputStream>
+    static void StructuralCheckEnd(InputStream& is, StructuralIndex& index) {
+        const char* p = is.src_;
+        const char* next = index.Current();
+        if (RAPIDJSON_UNLIKELY(p != next)) {
+            while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+                ++p;
+            if (RAPIDJSON_UNLIKELY(p != next))
+                index.Replace(p);
+        }
+    }
+
+    // Parse object: { string : value, ... }
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    void StructuralParseObject(InputStream& is, StructuralIndex& index, Handler& handler) {
+        const char* p = index.Current();
+        RAPIDJSON_ASSERT(*p == '{');
+        index.Advance();
+
+        if (RAPIDJSON_UNLIKELY(!handler.StartObject())) {
+            StructuralSeek(is, p + 1);
+            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+        }
+
+        p = index.Current();
+        if (*p == '}') {
+            index.Advance();
+            StructuralSeek(is, p + 1);
+            if (RAPIDJSON_UNLIKELY(!handler.EndObject(0)))  // empty object
+                RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+            return;
+        }
+
+        for (SizeType memberCount = 0;;) {
+            if (RAPIDJSON_UNLIKELY(*p != '"')) {
+                StructuralSeek(is, p);
+                RAPIDJSON_PARSE_ERROR(kParseErrorObjectMissName, is.Tell());
+            }
+
+            StructuralParseString<parseFlags>(is, index, handler, true);
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+
+            p = index.Current();
+            if (RAPIDJSON_UNLIKELY(*p != ':')) {
+                StructuralSeek(is, p);
+                RAPIDJSON_PARSE_ERROR(kParseErrorObjectMissColon, is.Tell());
+            }
+            index.Advance();
+
+            StructuralParseValue<parseFlags>(is, index, handler);
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+
+            ++memberCount;
+
+            p = index.Current();
+            switch (*p) {
+                case ',':
+                    index.Advance();
+                    p = index.Current();
+                    break;
+                case '}':
+                    index.Advance();
+                    StructuralSeek(is, p + 1);
+                    if (RAPIDJSON_UNLIKELY(!handler.EndObject(memberCount)))
+                        RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+                    return;
+                default:
+                    StructuralSeek(is, p);
+                    RAPIDJSON_PARSE_ERROR(kParseErrorObjectMissCommaOrCurlyBracket, is.Tell()); break; // This useless break is only for making warning and coverage happy
+            }
+
+            if (parseFlags & kParseTrailingCommasFlag) {
+                if (*p == '}') {
+                    if (RAPIDJSON_UNLIKELY(!handler.EndObject(memberCount))) {
+                        StructuralSeek(is, p);
+                        RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+                    }
+                    index.Advance();
+                    StructuralSeek(is, p + 1);
+                    return;
+                }
+            }
+        }
+    }
+
+    // Parse array: [ value, ... ]
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    void StructuralParseArray(InputStream& is, StructuralIndex& index, Handler& handler) {
+        const char* p = index.Current();
+        RAPIDJSON_ASSERT(*p == '[');
+        index.Advance();
+
+        if (RAPIDJSON_UNLIKELY(!handler.StartArray())) {
+            StructuralSeek(is, p + 1);
+            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+        }
+
+        p = index.Current();
+        if (*p == ']') {
+            index.Advance();
+            StructuralSeek(is, p + 1);
+            if (RAPIDJSON_UNLIKELY(!handler.EndArray(0))) // empty array
+                RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+            return;
+        }
+
+        for (SizeType elementCount = 0;;) {
+            StructuralParseValue<parseFlags>(is, index, handler);
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+
+            ++elementCount;
+
+            p = index.Current();
+            if (*p == ',') {
+                index.Advance();
+                p = index.Current();
+            }
+            else if (*p == ']') {
+                index.Advance();
+                StructuralSeek(is, p + 1);
+                if (RAPIDJSON_UNLIKELY(!handler.EndArray(elementCount)))
+                    RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+                return;
+            }
+            else {
+                StructuralSeek(is, p);
+                RAPIDJSON_PARSE_ERROR(kParseErrorArrayMissCommaOrSquareBracket, is.Tell());
+            }
+
+            if (parseFlags & kParseTrailingCommasFlag) {
+                if (*p == ']') {
+                    if (RAPIDJSON_UNLIKELY(!handler.EndArray(elementCount))) {
+                        StructuralSeek(is, p);
+                        RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+                    }
+                    index.Advance();
+                    StructuralSeek(is, p + 1);
+                    return;
+                }
+            }
+        }
+    }
+
     // Iterative Parsing
 
     // States
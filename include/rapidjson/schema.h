@@ -270,6 +270,8 @@ public:
 
     bool IsValid() const { return stack_.GetSize() == sizeof(uint64_t); }
 
+    void Reset() { stack_.Clear(); }
+
     uint64_t GetHashCode() const {
         RAPIDJSON_ASSERT(IsValid());
         return *stack_.template Top<uint64_t>();
@@ -309,6 +311,430 @@ private:
     Stack<Allocator> stack_;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// HashCodeSet
+
+//! Open-addressed hash set of Hasher codes, for uniqueItems and enum.
+/*! Each code is inserted with the index of its element, so that the first
+    element of a duplicate pair can be reported.
+*/
+template <typename Allocator>
+class HashCodeSet {
+public:
+    HashCodeSet(Allocator& allocator) : allocator_(allocator), entries_(), capacity_(), size_() {}
+    ~HashCodeSet() { Allocator::Free(entries_); }
+
+    //! Insert the hash code of the next element.
+    /*! \param code Hash code of the element.
+        \param[out] index Index of the previous element with the same code, if any.
+        \return Whether the code was not in the set.
+    */
+    bool Insert(uint64_t code, SizeType& index) {
+        if ((size_ + 1) * 2 > capacity_)
+            Grow();
+        Entry* e = Find(code);
+        if (e->index != 0) {
+            index = e->index - 1;
+            return false;
+        }
+        e->code = code;
+        e->index = ++size_;
+        return true;
+    }
+
+    //! Whether a hash code is in the set.
+    bool Contains(uint64_t code) const { return capacity_ != 0 && Find(code)->index != 0; }
+
+    //! Number of elements inserted.
+    SizeType Size() const { return size_; }
+
+    //! Copy the codes in the set, in the order of insertion.
+    void GetCodes(uint64_t* codes) const {
+        for (SizeType i = 0; i < capacity_; i++)
+            if (entries_[i].index != 0)
+                codes[entries_[i].index - 1] = entries_[i].code;
+    }
+
+private:
+    static const SizeType kInitialCapacity = 16;
+
+    struct Entry {
+        uint64_t code;
+        SizeType index; // index of element + 1, or 0 for an empty entry
+    };
+
+    Entry* Find(uint64_t code) const {
+        const SizeType mask = capacity_ - 1;
+        for (SizeType i = static_cast<SizeType>(code ^ (code >> 32)) & mask;; i = (i + 1) & mask)
+            if (entries_[i].index == 0 || entries_[i].code == code)
+                return &entries_[i];
+    }
+
+    void Grow() {
+        Entry* old = entries_;
+        const SizeType oldCapacity = capacity_;
+        capacity_ = capacity_ ? capacity_ * 2 : kInitialCapacity;
+        entries_ = static_cast<Entry*>(allocator_.Malloc(capacity_ * sizeof(Entry)));
+        std::memset(static_cast<void*>(entries_), 0, capacity_ * sizeof(Entry));
+        for (SizeType i = 0; i < oldCapacity; i++)
+            if (old[i].index != 0)
+                *Find(old[i].code) = old[i];
+        Allocator::Free(old);
+    }
+
+    HashCodeSet(const HashCodeSet&);
+    HashCodeSet& operator=(const HashCodeSet&);
+
+    Allocator& allocator_;
+    Entry* entries_;
+    SizeType capacity_;     //!< Number of entries, a power of two.
+    SizeType size_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// SchemaImageWriter
+
+enum SchemaImageValueType {
+    kSchemaImageNull,
+    kSchemaImageString,
+    kSchemaImageInt64,
+    kSchemaImageUint64,
+    kSchemaImageDouble
+};
+
+//! Writes schemas into a binary image.
+/*! Unsigned integers are written in LEB128, so that most take one byte, and other numbers in
+    native byte order. A schema is written as its index in the table of schemas of the image,
+    which grows as new schemas are written. Without an output stream, schemas are only added
+    to the table.
+*/
+template <typename SchemaType, typename OutputByteStream>
+class SchemaImageWriter {
+public:
+    typedef typename SchemaType::Ch Ch;
+    typedef typename SchemaType::SValue SValue;
+    typedef typename SchemaType::PointerType PointerType;
+    typedef typename SchemaType::EncodingType EncodingType;
+
+    SchemaImageWriter(const SchemaType* typeless) :
+        allocator_(), os_(), size_(), typeless_(typeless), schemas_(&allocator_, kDefaultSize), schemaSet_(allocator_), pointer_(&allocator_, kDefaultSize) {}
+
+    void SetOutputStream(OutputByteStream* os) {
+        os_ = os;
+        size_ = 0;
+        pointer_.Clear();
+    }
+
+    //! Add a schema to the table if it is not yet, and returns its index.
+    SizeType AddSchema(const SchemaType* schema) {
+        // Scramble the address, so that aligned addresses spread over the hash set
+        SizeType index;
+        if (schemaSet_.Insert(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(schema)) * RAPIDJSON_UINT64_C2(0x9E3779B9, 0x7F4A7C15), index)) {
+            *schemas_.template Push<const SchemaType*>() = schema;
+            index = GetSchemaCount() - 1;
+        }
+        return index;
+    }
+
+    SizeType GetSchemaCount() const { return static_cast<SizeType>(schemas_.GetSize() / sizeof(const SchemaType*)); }
+    const SchemaType* GetSchema(SizeType index) const { return schemas_.template Bottom<const SchemaType*>()[index]; }
+
+    void Put(uint32_t value) {
+        for (; value >= 0x80; value >>= 7)
+            PutByte(static_cast<char>((value & 0x7F) | 0x80));
+        PutByte(static_cast<char>(value));
+    }
+
+    void Put64(uint64_t value) { PutBytes(&value, sizeof(value)); }
+
+    //! Write 0 for a null schema, 1 for the typeless schema, or the index of another schema + 2.
+    void PutSchema(const SchemaType* schema) {
+        Put(schema == 0 ? 0 : schema == typeless_ ? 1 : AddSchema(schema) + 2);
+    }
+
+    //! Write a string, whose characters are aligned to the size of Ch from the start of the image.
+    void PutString(const Ch* str, SizeType length) {
+        Put(length);
+        while (size_ % sizeof(Ch) != 0)
+            PutByte(0);
+        PutBytes(str, length * sizeof(Ch));
+    }
+
+    //! Write a null, string or number value.
+    void PutValue(const SValue& value) {
+        if (value.IsString()) {
+            Put(kSchemaImageString);
+            PutString(value.GetString(), value.GetStringLength());
+        }
+        else if (value.IsDouble()) {
+            Put(kSchemaImageDouble);
+            double d = value.GetDouble();
+            PutBytes(&d, sizeof(d));
+        }
+        else if (value.IsInt64()) {
+            Put(kSchemaImageInt64);
+            Put64(static_cast<uint64_t>(value.GetInt64()));
+        }
+        else if (value.IsUint64()) {
+            Put(kSchemaImageUint64);
+            Put64(value.GetUint64());
+        }
+        else {
+            RAPIDJSON_ASSERT(value.IsNull());
+            Put(kSchemaImageNull);
+        }
+    }
+
+    //! Write a pointer as the length of its prefix in common with the previous pointer, and the rest.
+    void PutPointer(const PointerType& pointer) {
+        GenericStringBuffer<EncodingType, CrtAllocator> sb;
+        pointer.Stringify(sb);
+        const Ch* str = sb.GetString();
+        const SizeType length = static_cast<SizeType>(sb.GetSize() / sizeof(Ch));
+        const SizeType previousLength = static_cast<SizeType>(pointer_.GetSize() / sizeof(Ch));
+        const Ch* previous = pointer_.template Bottom<Ch>();
+        SizeType prefixLength = 0;
+        while (prefixLength < length && prefixLength < previousLength && str[prefixLength] == previous[prefixLength])
+            prefixLength++;
+        Put(prefixLength);
+        PutString(str + prefixLength, length - prefixLength);
+
+        pointer_.Clear();
+        if (length)
+            std::memcpy(pointer_.template Push<Ch>(length), str, length * sizeof(Ch));
+    }
+
+private:
+    static const size_t kDefaultSize = 256;
+
+    void PutByte(char byte) {
+        if (os_)
+            os_->Put(byte);
+        size_++;
+    }
+
+    void PutBytes(const void* data, size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        for (size_t i = 0; i < size; i++)
+            PutByte(bytes[i]);
+    }
+
+    SchemaImageWriter(const SchemaImageWriter&);
+    SchemaImageWriter& operator=(const SchemaImageWriter&);
+
+    CrtAllocator allocator_;
+    OutputByteStream* os_;
+    size_t size_;
+    const SchemaType* typeless_;
+    Stack<CrtAllocator> schemas_;
+    HashCodeSet<CrtAllocator> schemaSet_;
+    Stack<CrtAllocator> pointer_;   //!< Previous pointer written
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// SchemaImageReader
+
+//! Reads schemas from a binary image written by SchemaImageWriter.
+/*! Reading past the end or a malformed item sets the error, after which zeros, empty strings
+    and null schemas are read, so that the schemas being read are still consistent.
+*/
+template <typename SchemaType>
+class SchemaImageReader {
+public:
+    typedef typename SchemaType::EncodingType EncodingType;
+    typedef typename SchemaType::Ch Ch;
+    typedef typename SchemaType::SValue SValue;
+    typedef typename SchemaType::PointerType PointerType;
+    typedef typename SchemaType::AllocatorType AllocatorType;
+
+    SchemaImageReader(const void* image, size_t size) :
+        begin_(static_cast<const char*>(image)), cur_(begin_), end_(begin_ + size), typeless_(), schemas_(), schemaCount_(),
+        pointer_(0, kDefaultSize), error_(reinterpret_cast<uintptr_t>(image) % sizeof(Ch) != 0) {}
+
+    void SetSchemas(const SchemaType* typeless, SchemaType* const* schemas, SizeType schemaCount) {
+        typeless_ = typeless;
+        schemas_ = schemas;
+        schemaCount_ = schemaCount;
+    }
+
+    bool HasError() const { return error_; }
+    bool IsEnd() const { return cur_ == end_; }
+
+    uint32_t Take() {
+        uint32_t value = 0;
+        for (unsigned shift = 0; !error_ && cur_ != end_ && shift < 32; shift += 7) {
+            const unsigned char byte = static_cast<unsigned char>(*cur_++);
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        error_ = true;
+        return 0;
+    }
+
+    uint64_t Take64() { uint64_t value = 0; TakeBytes(&value, sizeof(value)); return value; }
+    bool TakeBool() { return Take() != 0; }
+
+    //! Read the number of the items which follow, each of at least one byte.
+    SizeType TakeCount() {
+        SizeType count = Take();
+        if (count > static_cast<size_t>(end_ - cur_)) {
+            error_ = true;
+            return 0;
+        }
+        return count;
+    }
+
+    const SchemaType* TakeSchema() {
+        SizeType index = Take();
+        if (index < 2)
+            return index == 0 ? 0 : typeless_;
+        if (index - 2 >= schemaCount_) {
+            error_ = true;
+            return 0;
+        }
+        return schemas_[index - 2];
+    }
+
+    //! Read a schema which must not be null, such as a subschema of allOf or of a property.
+    /*! A null schema sets the error, and the typeless schema is returned instead.
+    */
+    const SchemaType* TakeRequiredSchema() {
+        const SchemaType* schema = TakeSchema();
+        if (!schema) {
+            error_ = true;
+            return typeless_;
+        }
+        return schema;
+    }
+
+    //! Read a bitmask, where only the lowest bitCount bits may be set.
+    unsigned TakeBits(unsigned bitCount) {
+        const unsigned bits = Take();
+        if (bits >> bitCount) {
+            error_ = true;
+            return 0;
+        }
+        return bits;
+    }
+
+    const Ch* TakeString(SizeType& length) {
+        static const Ch kEmpty[1] = { '\0' };
+        length = Take();
+        while (!error_ && cur_ != end_ && static_cast<size_t>(cur_ - begin_) % sizeof(Ch) != 0)
+            cur_++;
+        if (error_ || length > static_cast<size_t>(end_ - cur_) / sizeof(Ch)) {
+            error_ = true;
+            length = 0;
+            return kEmpty;
+        }
+        const Ch* str = reinterpret_cast<const Ch*>(cur_);
+        cur_ += length * sizeof(Ch);
+        if (!IsValidString(str, length)) {
+            error_ = true;
+            length = 0;
+            return kEmpty;
+        }
+        return str;
+    }
+
+    //! Read a string value, or a null value if nullable, or sets the error for a value of another type.
+    void TakeString(SValue& value, AllocatorType& allocator, bool nullable = false) {
+        const uint32_t type = Take();
+        if (nullable && type == kSchemaImageNull) {
+            value.SetNull();
+            return;
+        }
+        if (type != kSchemaImageString)
+            error_ = true;
+        SizeType length;
+        const Ch* str = TakeString(length);
+        value.SetString(str, length, allocator);
+    }
+
+    //! Read a null or number value, or sets the error for a value of another type.
+    void TakeNumber(SValue& value) {
+        switch (Take()) {
+        case kSchemaImageNull: value.SetNull(); break;
+        case kSchemaImageInt64: value.SetInt64(static_cast<int64_t>(Take64())); break;
+        case kSchemaImageUint64: value.SetUint64(Take64()); break;
+        case kSchemaImageDouble: { double d = 0.0; TakeBytes(&d, sizeof(d)); value.SetDouble(d); break; }
+        default: error_ = true; value.SetNull(); break;
+        }
+    }
+
+    PointerType TakePointer(AllocatorType* allocator) {
+        const SizeType prefixLength = Take();
+        if (prefixLength > pointer_.GetSize() / sizeof(Ch))
+            error_ = true;
+        else
+            pointer_.template Pop<Ch>(pointer_.GetSize() / sizeof(Ch) - prefixLength);
+        SizeType length;
+        const Ch* str = TakeString(length);
+        if (length)
+            std::memcpy(pointer_.template Push<Ch>(length), str, length * sizeof(Ch));
+
+        *pointer_.template Push<Ch>() = '\0'; // Also allocates the stack for an empty pointer
+        PointerType pointer(pointer_.template Bottom<Ch>(), pointer_.GetSize() / sizeof(Ch) - 1, allocator);
+        pointer_.template Pop<Ch>(1);
+        if (!pointer.IsValid()) {
+            error_ = true;
+            return PointerType(allocator);
+        }
+        return pointer;
+    }
+
+private:
+    // Input stream of a string which is not null-terminated, reading zeros past its end.
+    struct BoundedStream {
+        typedef typename EncodingType::Ch Ch;
+        BoundedStream(const Ch* str, SizeType length) : str_(str), length_(length), pos_() {}
+        Ch Peek() const { return pos_ < length_ ? str_[pos_] : Ch(); }
+        Ch Take() { return pos_ < length_ ? str_[pos_++] : Ch(); }
+        size_t Tell() const { return pos_; }
+
+        const Ch* str_;
+        SizeType length_;
+        SizeType pos_;
+    };
+
+    // Output stream which drops the characters.
+    struct NullStream {
+        void Put(Ch) {}
+    };
+
+    // Whether a string is valid in the encoding, as pointers and error messages rely on it.
+    static bool IsValidString(const Ch* str, SizeType length) {
+        BoundedStream is(str, length);
+        NullStream os;
+        while (is.Tell() < length)
+            if (!EncodingType::Validate(is, os))
+                return false;
+        return true;
+    }
+
+    void TakeBytes(void* data, size_t size) {
+        if (error_ || size > static_cast<size_t>(end_ - cur_)) {
+            error_ = true;
+            cur_ = end_;
+            return;
+        }
+        std::memcpy(data, cur_, size);
+        cur_ += size;
+    }
+
+    static const size_t kDefaultSize = 256;
+
+    const char* begin_;
+    const char* cur_;
+    const char* end_;
+    const SchemaType* typeless_;
+    SchemaType* const* schemas_;
+    SizeType schemaCount_;
+    Stack<CrtAllocator> pointer_;   //!< Previous pointer read
+    bool error_;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // SchemaValidationContext
 
@@ -336,6 +762,8 @@ struct SchemaValidationContext {
         arrayElementHashCodes(),
         validators(),
         validatorCount(),
+        activeValidators(),
+        activeValidatorCount(),
         patternPropertiesValidators(),
         patternPropertiesValidatorCount(),
         patternPropertiesSchemas(),
@@ -351,14 +779,15 @@ struct SchemaValidationContext {
     ~SchemaValidationContext() {
         if (hasher)
             factory.DestroryHasher(hasher);
+        // Destroy in reverse order, so that a recycling factory hands them out again in creation order
         if (validators) {
-            for (SizeType i = 0; i < validatorCount; i++)
-                factory.DestroySchemaValidator(validators[i]);
+            for (SizeType i = validatorCount; i > 0; i--)
+                factory.DestroySchemaValidator(validators[i - 1]);
             factory.FreeState(validators);
         }
         if (patternPropertiesValidators) {
-            for (SizeType i = 0; i < patternPropertiesValidatorCount; i++)
-                factory.DestroySchemaValidator(patternPropertiesValidators[i]);
+            for (SizeType i = patternPropertiesValidatorCount; i > 0; i--)
+                factory.DestroySchemaValidator(patternPropertiesValidators[i - 1]);
             factory.FreeState(patternPropertiesValidators);
         }
         if (patternPropertiesSchemas)
@@ -376,6 +805,8 @@ struct SchemaValidationContext {
     void* arrayElementHashCodes; // Only validator access this
     ISchemaValidator** validators;
     SizeType validatorCount;
+    ISchemaValidator** activeValidators; // Validators still valid, which are fed with the events
+    SizeType activeValidatorCount;
     ISchemaValidator** patternPropertiesValidators;
     SizeType patternPropertiesValidatorCount;
     const SchemaType** patternPropertiesSchemas;
@@ -412,7 +843,6 @@ public:
         pointer_(p),
         typeless_(schemaDocument->GetTypeless()),
         enum_(),
-        enumCount_(),
         not_(),
         type_((1 << kTotalSchemaType) - 1), // typeless
         validatorCount_(),
@@ -421,7 +851,10 @@ public:
         additionalPropertiesSchema_(),
         patternProperties_(),
         patternPropertyCount_(),
+        patternPropertiesSet_(),
         propertyCount_(),
+        propertyTable_(),
+        propertyTableMask_(),
         minProperties_(),
         maxProperties_(SizeType(~0)),
         additionalProperties_(true),
@@ -461,14 +894,15 @@ public:
 
         if (const ValueType* v = GetMember(value, GetEnumString()))
             if (v->IsArray() && v->Size() > 0) {
-                enum_ = static_cast<uint64_t*>(allocator_->Malloc(sizeof(uint64_t) * v->Size()));
+                enum_ = new (allocator_->Malloc(sizeof(EnumSet))) EnumSet(*allocator_);
                 for (ConstValueIterator itr = v->Begin(); itr != v->End(); ++itr) {
                     typedef Hasher<EncodingType, MemoryPoolAllocator<> > EnumHasherType;
                     char buffer[256 + 24];
                     MemoryPoolAllocator<> hasherAllocator(buffer, sizeof(buffer));
                     EnumHasherType h(&hasherAllocator, 256);
                     itr->Accept(h);
-                    enum_[enumCount_++] = h.GetHashCode();
+                    SizeType index;
+                    enum_->Insert(h.GetHashCode(), index); // duplicated values are harmless
                 }
             }
 
@@ -519,6 +953,7 @@ public:
                     properties_[i].name = allProperties[i];
                     properties_[i].schema = typeless_;
                 }
+                CreatePropertyTable();
             }
         }
 
@@ -538,10 +973,12 @@ public:
 
             for (ConstMemberIterator itr = v->MemberBegin(); itr != v->MemberEnd(); ++itr) {
                 new (&patternProperties_[patternPropertyCount_]) PatternProperty();
+                patternProperties_[patternPropertyCount_].source.CopyFrom(itr->name, *allocator_);
                 patternProperties_[patternPropertyCount_].pattern = CreatePattern(itr->name);
                 schemaDocument->CreateSchema(&patternProperties_[patternPropertyCount_].schema, q.Append(itr->name, allocator_), itr->value, document);
                 patternPropertyCount_++;
             }
+            patternPropertiesSet_ = CreatePatternSet();
         }
 
         if (required && required->IsArray())
@@ -618,8 +1055,11 @@ public:
         AssignIfExist(minLength_, value, GetMinLengthString());
         AssignIfExist(maxLength_, value, GetMaxLengthString());
 
-        if (const ValueType* v = GetMember(value, GetPatternString()))
+        if (const ValueType* v = GetMember(value, GetPatternString())) {
             pattern_ = CreatePattern(*v);
+            if (v->IsString())
+                patternSource_.CopyFrom(*v, *allocator_);
+        }
 
         // Number
         if (const ValueType* v = GetMember(value, GetMinimumString()))
@@ -645,12 +1085,20 @@ public:
     }
 
     ~Schema() {
-        AllocatorType::Free(enum_);
+        if (enum_) {
+            enum_->~EnumSet();
+            AllocatorType::Free(enum_);
+        }
         if (properties_) {
             for (SizeType i = 0; i < propertyCount_; i++)
                 properties_[i].~Property();
             AllocatorType::Free(properties_);
         }
+        AllocatorType::Free(propertyTable_);
+        if (patternPropertiesSet_) {
+            patternPropertiesSet_->~RegexSetType();
+            AllocatorType::Free(patternPropertiesSet_);
+        }
         if (patternProperties_) {
             for (SizeType i = 0; i < patternPropertyCount_; i++)
                 patternProperties_[i].~PatternProperty();
@@ -673,6 +1121,172 @@ public:
         return pointer_;
     }
 
+    //! Write the compiled schema with SchemaImageWriter.
+    template <typename Writer>
+    void Serialize(Writer& w) const {
+        w.PutValue(uri_);
+        w.PutPointer(pointer_);
+        w.Put(type_);
+
+        const SizeType enumCount = enum_ ? enum_->Size() : 0;
+        w.Put(enumCount);
+        if (enumCount) {
+            uint64_t* codes = static_cast<uint64_t*>(allocator_->Malloc(sizeof(uint64_t) * enumCount));
+            enum_->GetCodes(codes);
+            for (SizeType i = 0; i < enumCount; i++)
+                w.Put64(codes[i]);
+            AllocatorType::Free(codes);
+        }
+
+        SerializeSchemaArray(w, allOf_);
+        SerializeSchemaArray(w, anyOf_);
+        SerializeSchemaArray(w, oneOf_);
+        w.PutSchema(not_);
+
+        // Object
+        w.Put(propertyCount_);
+        for (SizeType i = 0; i < propertyCount_; i++) {
+            const Property& property = properties_[i];
+            w.PutValue(property.name);
+            w.PutSchema(property.schema);
+            w.PutSchema(property.dependenciesSchema);
+            w.Put(property.dependencies != 0);
+            if (property.dependencies)
+                for (SizeType j = 0; j < propertyCount_; j++)
+                    w.Put(property.dependencies[j]);
+            w.Put(property.required);
+        }
+        w.PutSchema(additionalPropertiesSchema_);
+        w.Put(patternProperties_ ? patternPropertyCount_ + 1 : 0);
+        for (SizeType i = 0; i < patternPropertyCount_; i++) {
+            w.PutValue(patternProperties_[i].source);
+            w.PutSchema(patternProperties_[i].schema);
+        }
+        w.Put(minProperties_);
+        w.Put(maxProperties_);
+        w.Put(additionalProperties_);
+        w.Put(hasDependencies_);
+
+        // Array
+        w.PutSchema(additionalItemsSchema_);
+        w.PutSchema(itemsList_);
+        w.Put(itemsTuple_ ? itemsTupleCount_ + 1 : 0);
+        for (SizeType i = 0; i < itemsTupleCount_; i++)
+            w.PutSchema(itemsTuple_[i]);
+        w.Put(minItems_);
+        w.Put(maxItems_);
+        w.Put(additionalItems_);
+        w.Put(uniqueItems_);
+
+        // String
+        w.PutValue(patternSource_);
+        w.Put(minLength_);
+        w.Put(maxLength_);
+
+        // Number
+        w.PutValue(minimum_);
+        w.PutValue(maximum_);
+        w.PutValue(multipleOf_);
+        w.Put(exclusiveMinimum_);
+        w.Put(exclusiveMaximum_);
+
+        w.Put(defaultValueLength_);
+    }
+
+    //! Read the compiled schema with SchemaImageReader, into a typeless schema.
+    /*! Regular expressions are compiled again, and the indices of validators are assigned in the
+        order of their schemas, which does not change the validation.
+    */
+    template <typename Reader>
+    void Deserialize(Reader& r) {
+        r.TakeString(uri_, *allocator_);
+        pointer_ = r.TakePointer(allocator_);
+        type_ = r.TakeBits(kTotalSchemaType);
+
+        if (SizeType enumCount = r.TakeCount()) {
+            enum_ = new (allocator_->Malloc(sizeof(EnumSet))) EnumSet(*allocator_);
+            for (SizeType i = 0; i < enumCount; i++) {
+                SizeType index;
+                enum_->Insert(r.Take64(), index);
+            }
+        }
+
+        DeserializeSchemaArray(r, allOf_);
+        DeserializeSchemaArray(r, anyOf_);
+        DeserializeSchemaArray(r, oneOf_);
+        if ((not_ = r.TakeSchema()) != 0) {
+            notValidatorIndex_ = validatorCount_;
+            validatorCount_++;
+        }
+
+        // Object
+        if ((propertyCount_ = r.TakeCount()) != 0) {
+            properties_ = static_cast<Property*>(allocator_->Malloc(sizeof(Property) * propertyCount_));
+            for (SizeType i = 0; i < propertyCount_; i++) {
+                Property& property = *new (&properties_[i]) Property();
+                r.TakeString(property.name, *allocator_);
+                property.schema = r.TakeRequiredSchema();
+                if ((property.dependenciesSchema = r.TakeSchema()) != 0) {
+                    hasSchemaDependencies_ = true;
+                    property.dependenciesValidatorIndex = validatorCount_;
+                    validatorCount_++;
+                }
+                if (r.TakeBool()) {
+                    property.dependencies = static_cast<bool*>(allocator_->Malloc(sizeof(bool) * propertyCount_));
+                    for (SizeType j = 0; j < propertyCount_; j++)
+                        property.dependencies[j] = r.TakeBool();
+                }
+                if ((property.required = r.TakeBool()) != false)
+                    hasRequired_ = true;
+            }
+            CreatePropertyTable();
+        }
+        additionalPropertiesSchema_ = r.TakeSchema();
+        if (SizeType patternPropertyCount = r.TakeCount()) {
+            patternProperties_ = static_cast<PatternProperty*>(allocator_->Malloc(sizeof(PatternProperty) * (patternPropertyCount - 1)));
+            for (; patternPropertyCount_ < patternPropertyCount - 1; patternPropertyCount_++) {
+                PatternProperty& patternProperty = *new (&patternProperties_[patternPropertyCount_]) PatternProperty();
+                r.TakeString(patternProperty.source, *allocator_);
+                patternProperty.pattern = CreatePattern(patternProperty.source);
+                patternProperty.schema = r.TakeRequiredSchema();
+            }
+            patternPropertiesSet_ = CreatePatternSet();
+        }
+        minProperties_ = r.Take();
+        maxProperties_ = r.Take();
+        additionalProperties_ = r.TakeBool();
+        hasDependencies_ = r.TakeBool();
+
+        // Array
+        additionalItemsSchema_ = r.TakeSchema();
+        itemsList_ = r.TakeSchema();
+        if (SizeType itemsTupleCount = r.TakeCount()) {
+            itemsTuple_ = static_cast<const Schema**>(allocator_->Malloc(sizeof(const Schema*) * (itemsTupleCount - 1)));
+            for (; itemsTupleCount_ < itemsTupleCount - 1; itemsTupleCount_++)
+                itemsTuple_[itemsTupleCount_] = r.TakeRequiredSchema();
+        }
+        minItems_ = r.Take();
+        maxItems_ = r.Take();
+        additionalItems_ = r.TakeBool();
+        uniqueItems_ = r.TakeBool();
+
+        // String
+        r.TakeString(patternSource_, *allocator_, true);
+        if (patternSource_.IsString())
+            pattern_ = CreatePattern(patternSource_);
+        minLength_ = r.Take();
+        maxLength_ = r.Take();
+
+        // Number
+        r.TakeNumber(minimum_);
+        r.TakeNumber(maximum_);
+        r.TakeNumber(multipleOf_);
+        exclusiveMinimum_ = r.TakeBool();
+        exclusiveMaximum_ = r.TakeBool();
+
+        defaultValueLength_ = r.Take();
+    }
+
     bool BeginValue(Context& context) const {
         if (context.inArray) {
             if (uniqueItems_)
@@ -732,14 +1346,9 @@ public:
             }
         }
 
-        if (enum_) {
-            const uint64_t h = context.factory.GetHashCode(context.hasher);
-            for (SizeType i = 0; i < enumCount_; i++)
-                if (enum_[i] == h)
-                    goto foundEnum;
+        if (enum_ && !enum_->Contains(context.factory.GetHashCode(context.hasher))) {
             context.error_handler.DisallowedValue();
             RAPIDJSON_INVALID_KEYWORD_RETURN(GetEnumString());
-            foundEnum:;
         }
 
         if (allOf_.schemas)
@@ -892,11 +1501,12 @@ public:
     bool Key(Context& context, const Ch* str, SizeType len, bool) const {
         if (patternProperties_) {
             context.patternPropertiesSchemaCount = 0;
-            for (SizeType i = 0; i < patternPropertyCount_; i++)
-                if (patternProperties_[i].pattern && IsPatternMatch(patternProperties_[i].pattern, str, len)) {
-                    context.patternPropertiesSchemas[context.patternPropertiesSchemaCount++] = patternProperties_[i].schema;
-                    context.valueSchema = typeless_;
-                }
+            if (patternPropertiesSet_)
+                SearchPatternSet(context, str);
+            else
+                for (SizeType i = 0; i < patternPropertyCount_; i++)
+                    if (patternProperties_[i].pattern && IsPatternMatch(patternProperties_[i].pattern, str, len))
+                        AddPatternPropertySchema(context, i);
         }
 
         SizeType index;
@@ -1072,12 +1682,17 @@ private:
 
 #if RAPIDJSON_SCHEMA_USE_INTERNALREGEX
         typedef internal::GenericRegex<EncodingType, AllocatorType> RegexType;
+        typedef internal::GenericRegexSet<RegexType, AllocatorType> RegexSetType;
 #elif RAPIDJSON_SCHEMA_USE_STDREGEX
         typedef std::basic_regex<Ch> RegexType;
+        typedef char RegexSetType;
 #else
         typedef char RegexType;
+        typedef char RegexSetType;
 #endif
 
+    typedef HashCodeSet<AllocatorType> EnumSet;
+
     struct SchemaArray {
         SchemaArray() : schemas(), count() {}
         ~SchemaArray() { AllocatorType::Free(schemas); }
@@ -1146,6 +1761,30 @@ private:
         GenericRegexSearch<RegexType> rs(*pattern);
         return rs.Search(str);
     }
+
+    // Several patternProperties are searched together in one pass over the names.
+    RegexSetType* CreatePatternSet() {
+        if (patternPropertyCount_ < 2)
+            return 0;
+        const RegexType** patterns = static_cast<const RegexType**>(allocator_->Malloc(sizeof(const RegexType*) * patternPropertyCount_));
+        for (SizeType i = 0; i < patternPropertyCount_; i++)
+            patterns[i] = patternProperties_[i].pattern;
+        RegexSetType* set = new (allocator_->Malloc(sizeof(RegexSetType))) RegexSetType(patterns, patternPropertyCount_, allocator_);
+        AllocatorType::Free(patterns);
+        return set;
+    }
+
+    struct PatternSetHandler {
+        PatternSetHandler(const Schema& s, Context& c) : schema(s), context(c) {}
+        void Found(SizeType index) { schema.AddPatternPropertySchema(context, index); }
+        const Schema& schema;
+        Context& context;
+    };
+
+    void SearchPatternSet(Context& context, const Ch* str) const {
+        PatternSetHandler handler(*this, context);
+        patternPropertiesSet_->Search(str, handler);
+    }
 #elif RAPIDJSON_SCHEMA_USE_STDREGEX
     template <typename ValueType>
     RegexType* CreatePattern(const ValueType& value) {
@@ -1169,6 +1808,16 @@ private:
     static bool IsPatternMatch(const RegexType*, const Ch *, SizeType) { return true; }
 #endif // RAPIDJSON_SCHEMA_USE_STDREGEX
 
+#if !RAPIDJSON_SCHEMA_USE_INTERNALREGEX
+    RegexSetType* CreatePatternSet() { return 0; }
+    void SearchPatternSet(Context&, const Ch*) const {}
+#endif
+
+    void AddPatternPropertySchema(Context& context, SizeType index) const {
+        context.patternPropertiesSchemas[context.patternPropertiesSchemaCount++] = patternProperties_[index].schema;
+        context.valueSchema = typeless_;
+    }
+
     void AddType(const ValueType& type) {
         if      (type == GetNullString()   ) type_ |= 1 << kNullSchemaType;
         else if (type == GetBooleanString()) type_ |= 1 << kBooleanSchemaType;
@@ -1185,7 +1834,8 @@ private:
 
         if (validatorCount_) {
             RAPIDJSON_ASSERT(context.validators == 0);
-            context.validators = static_cast<ISchemaValidator**>(context.factory.MallocState(sizeof(ISchemaValidator*) * validatorCount_));
+            // The active validators share the allocation, after all validators
+            context.validators = static_cast<ISchemaValidator**>(context.factory.MallocState(sizeof(ISchemaValidator*) * validatorCount_ * 2));
             context.validatorCount = validatorCount_;
 
             if (allOf_.schemas)
@@ -1205,27 +1855,93 @@ private:
                     if (properties_[i].dependenciesSchema)
                         context.validators[properties_[i].dependenciesValidatorIndex] = context.factory.CreateSchemaValidator(*properties_[i].dependenciesSchema);
             }
+
+            context.activeValidators = context.validators + validatorCount_;
+            context.activeValidatorCount = validatorCount_;
+            std::memcpy(context.activeValidators, context.validators, sizeof(ISchemaValidator*) * validatorCount_);
         }
 
         return true;
     }
 
+    template <typename Writer>
+    static void SerializeSchemaArray(Writer& w, const SchemaArray& schemas) {
+        w.Put(schemas.count);
+        for (SizeType i = 0; i < schemas.count; i++)
+            w.PutSchema(schemas.schemas[i]);
+    }
+
+    template <typename Reader>
+    void DeserializeSchemaArray(Reader& r, SchemaArray& schemas) {
+        if ((schemas.count = r.TakeCount()) != 0) {
+            schemas.schemas = static_cast<const Schema**>(allocator_->Malloc(schemas.count * sizeof(const Schema*)));
+            for (SizeType i = 0; i < schemas.count; i++)
+                schemas.schemas[i] = r.TakeRequiredSchema();
+            schemas.begin = validatorCount_;
+            validatorCount_ += schemas.count;
+        }
+    }
+
+    //! Subschema of the validator at an index of context.validators, which validates the same value as this schema.
+    const Schema* GetParallelSchema(SizeType index) const {
+        const SchemaArray* arrays[] = { &allOf_, &anyOf_, &oneOf_ };
+        for (SizeType i = 0; i < 3; i++)
+            if (arrays[i]->count && index >= arrays[i]->begin && index - arrays[i]->begin < arrays[i]->count)
+                return arrays[i]->schemas[index - arrays[i]->begin];
+        if (not_ && index == notValidatorIndex_)
+            return not_;
+        for (SizeType i = 0; i < propertyCount_; i++)
+            if (properties_[i].dependenciesSchema && index == properties_[i].dependenciesValidatorIndex)
+                return properties_[i].dependenciesSchema;
+        return 0;
+    }
+
     void CreateSchemaValidators(Context& context, const SchemaArray& schemas) const {
         for (SizeType i = 0; i < schemas.count; i++)
             context.validators[schemas.begin + i] = context.factory.CreateSchemaValidator(*schemas.schemas[i]);
     }
 
-    // O(n)
+    // Build an open-addressed table of property indices, hashed by name, with a load factor below 1/2.
+    void CreatePropertyTable() {
+        SizeType capacity = 4;
+        while (capacity < propertyCount_ * 2)
+            capacity *= 2;
+        propertyTable_ = static_cast<SizeType*>(allocator_->Malloc(sizeof(SizeType) * capacity));
+        std::memset(propertyTable_, 0, sizeof(SizeType) * capacity);
+        propertyTableMask_ = capacity - 1;
+        for (SizeType index = 0; index < propertyCount_; index++) {
+            const SValue& name = properties_[index].name;
+            SizeType i = HashPropertyName(name.GetString(), name.GetStringLength()) & propertyTableMask_;
+            while (propertyTable_[i] != 0)
+                i = (i + 1) & propertyTableMask_;
+            propertyTable_[i] = index + 1;
+        }
+    }
+
+    static SizeType HashPropertyName(const Ch* str, SizeType len) {
+        // FNV-1a from http://isthe.com/chongo/tech/comp/fnv/
+        uint32_t h = 2166136261u;
+        const unsigned char* d = reinterpret_cast<const unsigned char*>(str);
+        for (size_t i = 0; i < len * sizeof(Ch); i++)
+            h = (h ^ d[i]) * 16777619u;
+        return h;
+    }
+
+    // O(1)
     bool FindPropertyIndex(const ValueType& name, SizeType* outIndex) const {
+        if (!propertyTable_)
+            return false;
         SizeType len = name.GetStringLength();
         const Ch* str = name.GetString();
-        for (SizeType index = 0; index < propertyCount_; index++)
+        for (SizeType i = HashPropertyName(str, len) & propertyTableMask_; propertyTable_[i] != 0; i = (i + 1) & propertyTableMask_) {
+            const SizeType index = propertyTable_[i] - 1;
             if (properties_[index].name.GetStringLength() == len && 
                 (std::memcmp(properties_[index].name.GetString(), str, sizeof(Ch) * len) == 0))
             {
                 *outIndex = index;
                 return true;
             }
+        }
         return false;
     }
 
@@ -1380,7 +2096,7 @@ private:
     };
 
     struct PatternProperty {
-        PatternProperty() : schema(), pattern() {}
+        PatternProperty() : schema(), pattern(), source() {}
         ~PatternProperty() { 
             if (pattern) {
                 pattern->~RegexType();
@@ -1389,14 +2105,14 @@ private:
         }
         const SchemaType* schema;
         RegexType* pattern;
+        SValue source;
     };
 
     AllocatorType* allocator_;
     SValue uri_;
     PointerType pointer_;
     const SchemaType* typeless_;
-    uint64_t* enum_;
-    SizeType enumCount_;
+    EnumSet* enum_;
     SchemaArray allOf_;
     SchemaArray anyOf_;
     SchemaArray oneOf_;
@@ -1409,7 +2125,10 @@ private:
     const SchemaType* additionalPropertiesSchema_;
     PatternProperty* patternProperties_;
     SizeType patternPropertyCount_;
+    RegexSetType* patternPropertiesSet_;
     SizeType propertyCount_;
+    SizeType* propertyTable_; // property index + 1 hashed by name, or 0 for an empty slot
+    SizeType propertyTableMask_; // number of slots - 1
     SizeType minProperties_;
     SizeType maxProperties_;
     bool additionalProperties_;
@@ -1427,6 +2146,7 @@ private:
     bool uniqueItems_;
 
     RegexType* pattern_;
+    SValue patternSource_;
     SizeType minLength_;
     SizeType maxLength_;
 
@@ -1439,36 +2159,6 @@ private:
     SizeType defaultValueLength_;
 };
 
-template<typename Stack, typename Ch>
-struct TokenHelper {
-    RAPIDJSON_FORCEINLINE static void AppendIndexToken(Stack& documentStack, SizeType index) {
-        *documentStack.template Push<Ch>() = '/';
-        char buffer[21];
-        size_t length = static_cast<size_t>((sizeof(SizeType) == 4 ? u32toa(index, buffer) : u64toa(index, buffer)) - buffer);
-        for (size_t i = 0; i < length; i++)
-            *documentStack.template Push<Ch>() = static_cast<Ch>(buffer[i]);
-    }
-};
-
-// Partial specialized version for char to prevent buffer copying.
-template <typename Stack>
-struct TokenHelper<Stack, char> {
-    RAPIDJSON_FORCEINLINE static void AppendIndexToken(Stack& documentStack, SizeType index) {
-        if (sizeof(SizeType) == 4) {
-            char *buffer = documentStack.template Push<char>(1 + 10); // '/' + uint
-            *buffer++ = '/';
-            const char* end = internal::u32toa(index, buffer);
-             documentStack.template Pop<char>(static_cast<size_t>(10 - (end - buffer)));
-        }
-        else {
-            char *buffer = documentStack.template Push<char>(1 + 20); // '/' + uint64
-            *buffer++ = '/';
-            const char* end = internal::u64toa(index, buffer);
-            documentStack.template Pop<char>(static_cast<size_t>(20 - (end - buffer)));
-        }
-    }
-};
-
 } // namespace internal
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1528,7 +2218,8 @@ public:
         root_(),
         typeless_(),
         schemaMap_(allocator, kInitialSchemaMapSize),
-        schemaRef_(allocator, kInitialSchemaRefSize)
+        schemaRef_(allocator, kInitialSchemaRefSize),
+        valid_(true)
     {
         if (!allocator_)
             ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator)();
@@ -1566,6 +2257,51 @@ public:
         schemaRef_.ShrinkToFit(); // Deallocate all memory for ref
     }
 
+    //! Constructor from a binary image.
+    /*!
+        Load a schema document written by Serialize(), without parsing and compiling the schema again.
+        Only the regular expressions are compiled again.
+
+        \param image The image, e.g. read or memory-mapped from a file. It must be aligned to the size of
+            \c Ch, and is not referenced after construction.
+        \param size Size of the image in bytes.
+        \param allocator An optional allocator instance for allocating memory. Can be null.
+        \note If the image is malformed, IsValid() returns false and the root schema accepts any value.
+    */
+    GenericSchemaDocument(const void* image, size_t size, Allocator* allocator = 0) :
+        remoteProvider_(),
+        allocator_(allocator),
+        ownAllocator_(),
+        root_(),
+        typeless_(),
+        schemaMap_(allocator, kInitialSchemaMapSize),
+        schemaRef_(allocator, 0),
+        valid_()
+    {
+        if (!allocator_)
+            ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator)();
+
+        internal::SchemaImageReader<SchemaType> reader(image, size);
+        const bool header = reader.Take() == kImageMagic && reader.Take() == kImageVersion && reader.Take() == sizeof(Ch) && reader.Take() == sizeof(SizeType);
+        if (header)
+            reader.TakeString(uri_, *allocator_);
+        else {
+            Ch noUri[1] = {0};
+            uri_.SetString(noUri, 0, *allocator_);
+        }
+
+        typeless_ = static_cast<SchemaType*>(allocator_->Malloc(sizeof(SchemaType)));
+        new (typeless_) SchemaType(this, PointerType(), ValueType(kObjectType).Move(), ValueType(kObjectType).Move(), allocator_);
+
+        valid_ = header && Load(reader);
+        if (!valid_) {
+            while (!schemaMap_.Empty())
+                schemaMap_.template Pop<SchemaEntry>(1)->~SchemaEntry();
+            root_ = typeless_;
+        }
+        schemaMap_.ShrinkToFit();
+    }
+
 #if RAPIDJSON_HAS_CXX11_RVALUE_REFS
     //! Move constructor in C++11
     GenericSchemaDocument(GenericSchemaDocument&& rhs) RAPIDJSON_NOEXCEPT :
@@ -1576,7 +2312,8 @@ public:
         typeless_(rhs.typeless_),
         schemaMap_(std::move(rhs.schemaMap_)),
         schemaRef_(std::move(rhs.schemaRef_)),
-        uri_(std::move(rhs.uri_))
+        uri_(std::move(rhs.uri_)),
+        valid_(rhs.valid_)
     {
         rhs.remoteProvider_ = 0;
         rhs.allocator_ = 0;
@@ -1603,6 +2340,56 @@ public:
     //! Get the root schema.
     const SchemaType& GetRoot() const { return *root_; }
 
+    //! Whether the document was constructed successfully, which fails only for a malformed image.
+    bool IsValid() const { return valid_; }
+
+    //! Write the compiled schema document as a binary image.
+    /*!
+        The image can be loaded by the constructor from an image, so that the schema is not parsed
+        and compiled again. Schemas referenced from remote documents are included in the image, so
+        the loaded document needs no remote provider. References within the image are indices,
+        so the image can be loaded from any address.
+
+        \tparam OutputByteStream Type of output stream of bytes, e.g. \c MemoryBuffer or \c FileWriteStream.
+        \note The image is in native byte order, for the same \c Ch and \c SizeType.
+        It is about the size of the JSON text of the schemas.
+    */
+    template <typename OutputByteStream>
+    void Serialize(OutputByteStream& os) const {
+        internal::SchemaImageWriter<SchemaType, OutputByteStream> w(typeless_);
+
+        // Schemas owned by this document come first, in the order of the map, then schemas of remote documents
+        for (const SchemaEntry* entry = schemaMap_.template Bottom<SchemaEntry>(); entry != schemaMap_.template End<SchemaEntry>(); ++entry)
+            if (entry->owned)
+                w.AddSchema(entry->schema);
+        w.PutSchema(root_);
+        for (const SchemaEntry* entry = schemaMap_.template Bottom<SchemaEntry>(); entry != schemaMap_.template End<SchemaEntry>(); ++entry)
+            w.PutSchema(entry->schema);
+        for (SizeType i = 0; i < w.GetSchemaCount(); i++)
+            w.GetSchema(i)->Serialize(w);
+
+        w.SetOutputStream(&os);
+        w.Put(kImageMagic);
+        w.Put(kImageVersion);
+        w.Put(static_cast<uint32_t>(sizeof(Ch)));
+        w.Put(static_cast<uint32_t>(sizeof(SizeType)));
+        w.PutValue(uri_);
+        w.Put(w.GetSchemaCount());
+        w.PutSchema(root_);
+        for (SizeType i = 0; i < w.GetSchemaCount(); i++)
+            w.GetSchema(i)->Serialize(w);
+
+        // Owned entries take the schemas in order, other entries are references
+        w.Put(static_cast<SizeType>(schemaMap_.GetSize() / sizeof(SchemaEntry)));
+        for (const SchemaEntry* entry = schemaMap_.template Bottom<SchemaEntry>(); entry != schemaMap_.template End<SchemaEntry>(); ++entry) {
+            w.Put(entry->owned);
+            if (!entry->owned) {
+                w.PutPointer(entry->pointer);
+                w.PutSchema(entry->schema);
+            }
+        }
+    }
+
 private:
     //! Prohibit copying
     GenericSchemaDocument(const GenericSchemaDocument&);
@@ -1721,6 +2508,98 @@ private:
 
     const SchemaType* GetTypeless() const { return typeless_; }
 
+    bool Load(internal::SchemaImageReader<SchemaType>& reader) {
+        const SizeType schemaCount = reader.TakeCount();
+        SchemaType** schemas = static_cast<SchemaType**>(allocator_->Malloc(sizeof(SchemaType*) * schemaCount));
+        for (SizeType i = 0; i < schemaCount; i++)
+            schemas[i] = static_cast<SchemaType*>(allocator_->Malloc(sizeof(SchemaType)));
+        reader.SetSchemas(typeless_, schemas, schemaCount);
+        root_ = reader.TakeSchema();
+
+        for (SizeType i = 0; i < schemaCount; i++) {
+            new (schemas[i]) SchemaType(this, PointerType(allocator_), ValueType(kObjectType).Move(), ValueType(kObjectType).Move(), allocator_);
+            schemas[i]->Deserialize(reader);
+        }
+
+        bool valid = true;
+        SizeType ownedCount = 0;
+        const SizeType entryCount = reader.TakeCount();
+        for (SizeType i = 0; i < entryCount; i++) {
+            if (reader.TakeBool()) {
+                if (ownedCount < schemaCount) {
+                    new (schemaMap_.template Push<SchemaEntry>()) SchemaEntry(schemas[ownedCount]->GetPointer(), schemas[ownedCount], true, allocator_);
+                    ownedCount++;
+                }
+                else
+                    valid = false;
+            }
+            else {
+                PointerType pointer = reader.TakePointer(allocator_);
+                if (const SchemaType* s = reader.TakeSchema())
+                    new (schemaMap_.template Push<SchemaEntry>()) SchemaEntry(pointer, const_cast<SchemaType*>(s), false, allocator_);
+            }
+        }
+
+        // Schemas of remote documents are owned under an invalid pointer, which GetSchema() never finds
+        static const Ch kInvalidPointer[] = { '!', '\0' };
+        for (; ownedCount < schemaCount; ownedCount++)
+            new (schemaMap_.template Push<SchemaEntry>()) SchemaEntry(PointerType(kInvalidPointer, 1, allocator_), schemas[ownedCount], true, allocator_);
+
+        valid = valid && !reader.HasError() && !HasParallelCycle(schemas, schemaCount);
+        Allocator::Free(schemas);
+        return valid && root_ && reader.IsEnd();
+    }
+
+    //! Whether a schema reaches itself through the subschemas which validate the same value.
+    /*! Such as {"not": {"$ref": "#"}}, whose validators would be created without end. */
+    bool HasParallelCycle(SchemaType* const* schemas, SizeType schemaCount) const {
+        // Find the index of a schema from its address, as SchemaImageWriter does
+        internal::HashCodeSet<Allocator> indices(*allocator_);
+        SizeType index;
+        for (SizeType i = 0; i < schemaCount; i++)
+            indices.Insert(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(schemas[i])) * RAPIDJSON_UINT64_C2(0x9E3779B9, 0x7F4A7C15), index);
+
+        // Depth-first search without recursion, where a schema on the path is 1 and a finished one 2
+        char* states = static_cast<char*>(allocator_->Malloc(schemaCount));
+        SizeType* path = static_cast<SizeType*>(allocator_->Malloc(sizeof(SizeType) * schemaCount * 2));
+        std::memset(states, 0, schemaCount);
+        bool cycle = false;
+        for (SizeType root = 0; root < schemaCount && !cycle; root++) {
+            if (states[root] != 0)
+                continue;
+            SizeType depth = 1;
+            path[0] = root;     // schema
+            path[1] = 0;        // next validator index
+            states[root] = 1;
+            while (depth > 0 && !cycle) {
+                SizeType* top = &path[(depth - 1) * 2];
+                const SchemaType* schema = schemas[top[0]];
+                if (top[1] == schema->validatorCount_) {
+                    states[top[0]] = 2;
+                    depth--;
+                    continue;
+                }
+                const SchemaType* sub = schema->GetParallelSchema(top[1]++);
+                if (!sub || indices.Insert(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(sub)) * RAPIDJSON_UINT64_C2(0x9E3779B9, 0x7F4A7C15), index) || index >= schemaCount)
+                    continue; // typeless
+                if (states[index] == 1)
+                    cycle = true;
+                else if (states[index] == 0) {
+                    states[index] = 1;
+                    path[depth * 2] = index;
+                    path[depth * 2 + 1] = 0;
+                    depth++;
+                }
+            }
+        }
+        Allocator::Free(path);
+        Allocator::Free(states);
+        return cycle;
+    }
+
+    static const uint32_t kImageMagic = 0x43534A52u; // "RJSC" in little endian
+    static const uint32_t kImageVersion = 1;
+
     static const size_t kInitialSchemaMapSize = 64;
     static const size_t kInitialSchemaRefSize = 64;
 
@@ -1732,6 +2611,7 @@ private:
     internal::Stack<Allocator> schemaMap_;  // Stores created Pointer -> Schemas
     internal::Stack<Allocator> schemaRef_;  // Stores Pointer from $ref and schema which holds the $ref
     URIType uri_;
+    bool valid_;
 };
 
 //! GenericSchemaDocument using Value type.
@@ -1791,11 +2671,15 @@ public:
         ownStateAllocator_(0),
         schemaStack_(allocator, schemaStackCapacity),
         documentStack_(allocator, documentStackCapacity),
+        basePathSize_(),
+        validatorPool_(allocator, kDefaultPoolCapacity),
+        hasherPool_(allocator, kDefaultPoolCapacity),
         outputHandler_(0),
         error_(kObjectType),
         currentError_(),
         missingDependents_(),
-        valid_(true)
+        valid_(true),
+        topLevel_(true)
 #if RAPIDJSON_SCHEMA_VERBOSE
         , depth_(0)
 #endif
@@ -1822,11 +2706,15 @@ public:
         ownStateAllocator_(0),
         schemaStack_(allocator, schemaStackCapacity),
         documentStack_(allocator, documentStackCapacity),
+        basePathSize_(),
+        validatorPool_(allocator, kDefaultPoolCapacity),
+        hasherPool_(allocator, kDefaultPoolCapacity),
         outputHandler_(&outputHandler),
         error_(kObjectType),
         currentError_(),
         missingDependents_(),
-        valid_(true)
+        valid_(true),
+        topLevel_(true)
 #if RAPIDJSON_SCHEMA_VERBOSE
         , depth_(0)
 #endif
@@ -1836,20 +2724,37 @@ public:
     //! Destructor.
     ~GenericSchemaValidator() {
         Reset();
+        ClearPools();
         RAPIDJSON_DELETE(ownStateAllocator_);
     }
 
     //! Reset the internal states.
+    /*! The recycled sub-validators and hashers are released, as at the end of each validated value,
+        so the state allocator may then be cleared.
+    */
     void Reset() {
         while (!schemaStack_.Empty())
             PopSchema();
-        documentStack_.Clear();
+        if (topLevel_)
+            ClearPools();
+        documentStack_.template Pop<char>(documentStack_.GetSize() - basePathSize_);
         error_.SetObject();
         currentError_.SetNull();
         missingDependents_.SetNull();
         valid_ = true;
     }
 
+    //! Reset the internal states, and validate the next value as an element of an array.
+    /*! The instance references of the errors then start with the index of the element,
+        as if the value were validated through "items". \c Reset() keeps the index.
+        \param index Index of the next value in its array.
+    */
+    void ResetAsElement(SizeType index) {
+        Reset();
+        const SizeType token[2] = { index, kIndexTokenLength };
+        SetBasePath(reinterpret_cast<const char*>(token), sizeof(token));
+    }
+
     //! Checks whether the current state is valid.
     // Implementation of ISchemaValidator
     virtual bool IsValid() const { return valid_; }
@@ -1874,7 +2779,9 @@ public:
             return PointerType();
         }
         else {
-            return PointerType(documentStack_.template Bottom<Ch>(), documentStack_.GetSize() / sizeof(Ch));
+            GenericStringBuffer<EncodingType> sb;
+            GetDocumentPath(sb);
+            return PointerType(sb.GetString(), sb.GetSize() / sizeof(Ch));
         }
     }
 
@@ -2063,9 +2970,9 @@ public:
 #if RAPIDJSON_SCHEMA_VERBOSE
 #define RAPIDJSON_SCHEMA_HANDLE_BEGIN_VERBOSE_() \
 RAPIDJSON_MULTILINEMACRO_BEGIN\
-    *documentStack_.template Push<Ch>() = '\0';\
-    documentStack_.template Pop<Ch>(1);\
-    internal::PrintInvalidDocument(documentStack_.template Bottom<Ch>());\
+    GenericStringBuffer<EncodingType> sb;\
+    GetDocumentPath(sb);\
+    internal::PrintInvalidDocument(sb.GetString());\
 RAPIDJSON_MULTILINEMACRO_END
 #else
 #define RAPIDJSON_SCHEMA_HANDLE_BEGIN_VERBOSE_()
@@ -2082,9 +2989,11 @@ RAPIDJSON_MULTILINEMACRO_END
     for (Context* context = schemaStack_.template Bottom<Context>(); context != schemaStack_.template End<Context>(); context++) {\
         if (context->hasher)\
             static_cast<HasherType*>(context->hasher)->method arg2;\
-        if (context->validators)\
-            for (SizeType i_ = 0; i_ < context->validatorCount; i_++)\
-                static_cast<GenericSchemaValidator*>(context->validators[i_])->method arg2;\
+        for (SizeType i_ = 0; i_ < context->activeValidatorCount;)\
+            if (static_cast<GenericSchemaValidator*>(context->activeValidators[i_])->method arg2)\
+                i_++;\
+            else /* An invalid validator stays invalid, so stop feeding it */\
+                context->activeValidators[i_] = context->activeValidators[--context->activeValidatorCount];\
         if (context->patternPropertiesValidators)\
             for (SizeType i_ = 0; i_ < context->patternPropertiesValidatorCount; i_++)\
                 static_cast<GenericSchemaValidator*>(context->patternPropertiesValidators[i_])->method arg2;\
@@ -2151,6 +3060,19 @@ RAPIDJSON_MULTILINEMACRO_END
 
     // Implementation of ISchemaStateFactory<SchemaType>
     virtual ISchemaValidator* CreateSchemaValidator(const SchemaType& root) {
+        // Recycle a validator of the same schema released earlier, searching from the most recent one
+        GenericSchemaValidator** pool = validatorPool_.template Bottom<GenericSchemaValidator*>();
+        size_t count = validatorPool_.GetSize() / sizeof(GenericSchemaValidator*);
+        for (size_t i = count; i > 0; i--) {
+            GenericSchemaValidator* v = pool[i - 1];
+            if (&v->root_ == &root) {
+                std::memmove(pool + i - 1, pool + i, (count - i) * sizeof(GenericSchemaValidator*));
+                validatorPool_.template Pop<GenericSchemaValidator*>(1);
+                v->SetBasePath(documentStack_.template Bottom<char>(), documentStack_.GetSize());
+                return v;
+            }
+        }
+
         return new (GetStateAllocator().Malloc(sizeof(GenericSchemaValidator))) GenericSchemaValidator(*schemaDocument_, root, documentStack_.template Bottom<char>(), documentStack_.GetSize(),
 #if RAPIDJSON_SCHEMA_VERBOSE
         depth_ + 1,
@@ -2160,11 +3082,13 @@ RAPIDJSON_MULTILINEMACRO_END
 
     virtual void DestroySchemaValidator(ISchemaValidator* validator) {
         GenericSchemaValidator* v = static_cast<GenericSchemaValidator*>(validator);
-        v->~GenericSchemaValidator();
-        StateAllocator::Free(v);
+        v->Reset();
+        *validatorPool_.template Push<GenericSchemaValidator*>() = v;
     }
 
     virtual void* CreateHasher() {
+        if (!hasherPool_.Empty())
+            return *hasherPool_.template Pop<HasherType*>(1);
         return new (GetStateAllocator().Malloc(sizeof(HasherType))) HasherType(&GetStateAllocator());
     }
 
@@ -2174,8 +3098,8 @@ RAPIDJSON_MULTILINEMACRO_END
 
     virtual void DestroryHasher(void* hasher) {
         HasherType* h = static_cast<HasherType*>(hasher);
-        h->~HasherType();
-        StateAllocator::Free(h);
+        h->Reset();
+        *hasherPool_.template Push<HasherType*>() = h;
     }
 
     virtual void* MallocState(size_t size) {
@@ -2188,7 +3112,7 @@ RAPIDJSON_MULTILINEMACRO_END
 
 private:
     typedef typename SchemaType::Context Context;
-    typedef GenericValue<UTF8<>, StateAllocator> HashCodeArray;
+    typedef internal::HashCodeSet<StateAllocator> HashCodeSet;
     typedef internal::Hasher<EncodingType, StateAllocator> HasherType;
 
     GenericSchemaValidator( 
@@ -2208,17 +3132,45 @@ private:
         ownStateAllocator_(0),
         schemaStack_(allocator, schemaStackCapacity),
         documentStack_(allocator, documentStackCapacity),
+        basePathSize_(),
+        validatorPool_(allocator, kDefaultPoolCapacity),
+        hasherPool_(allocator, kDefaultPoolCapacity),
         outputHandler_(0),
         error_(kObjectType),
         currentError_(),
         missingDependents_(),
-        valid_(true)
+        valid_(true),
+        topLevel_(false)
 #if RAPIDJSON_SCHEMA_VERBOSE
         , depth_(depth)
 #endif
     {
+        if (basePath && basePathSize) {
+            memcpy(documentStack_.template Push<char>(basePathSize), basePath, basePathSize);
+            basePathSize_ = basePathSize;
+        }
+    }
+
+    void SetBasePath(const char* basePath, size_t basePathSize) {
+        RAPIDJSON_ASSERT(schemaStack_.Empty());
+        documentStack_.Clear();
         if (basePath && basePathSize)
             memcpy(documentStack_.template Push<char>(basePathSize), basePath, basePathSize);
+        basePathSize_ = basePathSize;
+    }
+
+    //! Destroys the recycled sub-validators and hashers.
+    void ClearPools() {
+        while (!validatorPool_.Empty()) {
+            GenericSchemaValidator* v = *validatorPool_.template Pop<GenericSchemaValidator*>(1);
+            v->~GenericSchemaValidator();
+            StateAllocator::Free(v);
+        }
+        while (!hasherPool_.Empty()) {
+            HasherType* h = *hasherPool_.template Pop<HasherType*>(1);
+            h->~HasherType();
+            StateAllocator::Free(h);
+        }
     }
 
     StateAllocator& GetStateAllocator() {
@@ -2232,7 +3184,7 @@ private:
             PushSchema(root_);
         else {
             if (CurrentContext().inArray)
-                internal::TokenHelper<internal::Stack<StateAllocator>, Ch>::AppendIndexToken(documentStack_, CurrentContext().arrayElementIndex);
+                AppendIndexToken(CurrentContext().arrayElementIndex);
 
             if (!CurrentSchema().BeginValue(CurrentContext()))
                 return false;
@@ -2265,52 +3217,96 @@ private:
 #if RAPIDJSON_SCHEMA_VERBOSE
         GenericStringBuffer<EncodingType> sb;
         schemaDocument_->GetPointer(&CurrentSchema()).Stringify(sb);
-
-        *documentStack_.template Push<Ch>() = '\0';
-        documentStack_.template Pop<Ch>(1);
-        internal::PrintValidatorPointers(depth_, sb.GetString(), documentStack_.template Bottom<Ch>());
+        GenericStringBuffer<EncodingType> documentPath;
+        GetDocumentPath(documentPath);
+        internal::PrintValidatorPointers(depth_, sb.GetString(), documentPath.GetString());
 #endif
 
         uint64_t h = CurrentContext().arrayUniqueness ? static_cast<HasherType*>(CurrentContext().hasher)->GetHashCode() : 0;
         
         PopSchema();
 
+        // Release the recycled objects after the root value, so that none is left in the state allocator between validations
+        if (schemaStack_.Empty() && topLevel_)
+            ClearPools();
+
         if (!schemaStack_.Empty()) {
             Context& context = CurrentContext();
             if (context.valueUniqueness) {
-                HashCodeArray* a = static_cast<HashCodeArray*>(context.arrayElementHashCodes);
+                HashCodeSet* a = static_cast<HashCodeSet*>(context.arrayElementHashCodes);
                 if (!a)
-                    CurrentContext().arrayElementHashCodes = a = new (GetStateAllocator().Malloc(sizeof(HashCodeArray))) HashCodeArray(kArrayType);
-                for (typename HashCodeArray::ConstValueIterator itr = a->Begin(); itr != a->End(); ++itr)
-                    if (itr->GetUint64() == h) {
-                        DuplicateItems(static_cast<SizeType>(itr - a->Begin()), a->Size());
-                        RAPIDJSON_INVALID_KEYWORD_RETURN(SchemaType::GetUniqueItemsString());
-                    }
-                a->PushBack(h, GetStateAllocator());
+                    CurrentContext().arrayElementHashCodes = a = new (GetStateAllocator().Malloc(sizeof(HashCodeSet))) HashCodeSet(GetStateAllocator());
+                SizeType index;
+                if (!a->Insert(h, index)) {
+                    DuplicateItems(index, a->Size());
+                    RAPIDJSON_INVALID_KEYWORD_RETURN(SchemaType::GetUniqueItemsString());
+                }
             }
         }
 
         // Remove the last token of document pointer
-        while (!documentStack_.Empty() && *documentStack_.template Pop<Ch>(1) != '/')
-            ;
+        if (documentStack_.GetSize() > basePathSize_)
+            documentStack_.template Pop<SizeType>(TokenSize(*documentStack_.template Top<SizeType>()) + 1);
 
         return true;
     }
 
+    // The path of the current value is kept in documentStack_ as raw tokens, and is only
+    // escaped and formatted as a JSON pointer when it is reported. A name is stored in
+    // whole SizeType units followed by its length in Ch, and an index is followed by
+    // kIndexTokenLength.
+    static const SizeType kIndexTokenLength = ~SizeType(0);
+
+    static size_t TokenSize(SizeType length) {
+        return length == kIndexTokenLength ? 1 : (length * sizeof(Ch) + sizeof(SizeType) - 1) / sizeof(SizeType);
+    }
+
     void AppendToken(const Ch* str, SizeType len) {
-        documentStack_.template Reserve<Ch>(1 + len * 2); // worst case all characters are escaped as two characters
-        *documentStack_.template PushUnsafe<Ch>() = '/';
-        for (SizeType i = 0; i < len; i++) {
-            if (str[i] == '~') {
-                *documentStack_.template PushUnsafe<Ch>() = '~';
-                *documentStack_.template PushUnsafe<Ch>() = '0';
-            }
-            else if (str[i] == '/') {
-                *documentStack_.template PushUnsafe<Ch>() = '~';
-                *documentStack_.template PushUnsafe<Ch>() = '1';
+        const size_t size = TokenSize(len);
+        SizeType* token = documentStack_.template Push<SizeType>(size + 1);
+        std::memcpy(token, str, len * sizeof(Ch));
+        token[size] = len;
+    }
+
+    void AppendIndexToken(SizeType index) {
+        SizeType* token = documentStack_.template Push<SizeType>(2);
+        token[0] = index;
+        token[1] = kIndexTokenLength;
+    }
+
+    void GetDocumentPath(GenericStringBuffer<EncodingType>& sb) const {
+        GetDocumentPath(sb, documentStack_.template End<SizeType>());
+    }
+
+    // Write the tokens below end, from the bottom.
+    void GetDocumentPath(GenericStringBuffer<EncodingType>& sb, const SizeType* end) const {
+        if (end == documentStack_.template Bottom<SizeType>())
+            return;
+        const SizeType length = end[-1];
+        const SizeType* token = end - 1 - TokenSize(length);
+        GetDocumentPath(sb, token);
+
+        sb.Put('/');
+        if (length == kIndexTokenLength) {
+            char buffer[21];
+            const char* last = sizeof(SizeType) == 4 ? internal::u32toa(*token, buffer) : internal::u64toa(*token, buffer);
+            for (const char* c = buffer; c != last; c++)
+                sb.Put(static_cast<Ch>(*c));
+        }
+        else {
+            const Ch* str = reinterpret_cast<const Ch*>(token);
+            for (SizeType i = 0; i < length; i++) {
+                if (str[i] == '~') {
+                    sb.Put('~');
+                    sb.Put('0');
+                }
+                else if (str[i] == '/') {
+                    sb.Put('~');
+                    sb.Put('1');
+                }
+                else
+                    sb.Put(str[i]);
             }
-            else
-                *documentStack_.template PushUnsafe<Ch>() = str[i];
         }
     }
 
@@ -2318,8 +3314,8 @@ private:
     
     RAPIDJSON_FORCEINLINE void PopSchema() {
         Context* c = schemaStack_.template Pop<Context>(1);
-        if (HashCodeArray* a = static_cast<HashCodeArray*>(c->arrayElementHashCodes)) {
-            a->~HashCodeArray();
+        if (HashCodeSet* a = static_cast<HashCodeSet*>(c->arrayElementHashCodes)) {
+            a->~HashCodeSet();
             StateAllocator::Free(a);
         }
         c->~Context();
@@ -2327,10 +3323,19 @@ private:
 
     void AddErrorLocation(ValueType& result, bool parent) {
         GenericStringBuffer<EncodingType> sb;
-        PointerType instancePointer = GetInvalidDocumentPointer();
-        ((parent && instancePointer.GetTokenCount() > 0)
-            ? PointerType(instancePointer.GetTokens(), instancePointer.GetTokenCount() - 1)
-            : instancePointer).StringifyUriFragment(sb);
+        const SizeType* end = documentStack_.template End<SizeType>();
+        if (parent && !documentStack_.Empty())
+            end -= 1 + TokenSize(end[-1]);
+        sb.Put('#');
+        GetDocumentPath(sb, end);
+        if (NeedPercentEncode(sb.GetString() + 1, sb.GetSize() / sizeof(Ch) - 1)) {
+            // Rare case, let the pointer transcode the names
+            sb.Clear();
+            PointerType instancePointer = GetInvalidDocumentPointer();
+            ((parent && instancePointer.GetTokenCount() > 0)
+                ? PointerType(instancePointer.GetTokens(), instancePointer.GetTokenCount() - 1)
+                : instancePointer).StringifyUriFragment(sb);
+        }
         ValueType instanceRef(sb.GetString(), static_cast<SizeType>(sb.GetSize() / sizeof(Ch)),
             GetStateAllocator());
         result.AddMember(GetInstanceRefString(), instanceRef, GetStateAllocator());
@@ -2338,12 +3343,22 @@ private:
         memcpy(sb.Push(CurrentSchema().GetURI().GetStringLength()),
             CurrentSchema().GetURI().GetString(),
             CurrentSchema().GetURI().GetStringLength() * sizeof(Ch));
-        GetInvalidSchemaPointer().StringifyUriFragment(sb);
+        CurrentSchema().GetPointer().StringifyUriFragment(sb);
         ValueType schemaRef(sb.GetString(), static_cast<SizeType>(sb.GetSize() / sizeof(Ch)),
             GetStateAllocator());
         result.AddMember(GetSchemaRefString(), schemaRef, GetStateAllocator());
     }
 
+    // Whether a JSON pointer string has characters to be percent-encoded in its URI fragment.
+    static bool NeedPercentEncode(const Ch* str, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            Ch c = str[i];
+            if (!((c >= '0' && c <= '9') || (c >= 'A' && c <='Z') || (c >= 'a' && c <= 'z') || c == '-' || c == '.' || c == '_' || c =='~' || c == '/'))
+                return true;
+        }
+        return false;
+    }
+
     void AddError(ValueType& keyword, ValueType& error) {
         typename ValueType::MemberIterator member = error_.FindMember(keyword);
         if (member == error_.MemberEnd())
@@ -2395,17 +3410,22 @@ private:
 
     static const size_t kDefaultSchemaStackCapacity = 1024;
     static const size_t kDefaultDocumentStackCapacity = 256;
+    static const size_t kDefaultPoolCapacity = 8 * sizeof(void*);
     const SchemaDocumentType* schemaDocument_;
     const SchemaType& root_;
     StateAllocator* stateAllocator_;
     StateAllocator* ownStateAllocator_;
     internal::Stack<StateAllocator> schemaStack_;    //!< stack to store the current path of schema (BaseSchemaType *)
-    internal::Stack<StateAllocator> documentStack_;  //!< stack to store the current path of validating document (Ch)
+    internal::Stack<StateAllocator> documentStack_;  //!< stack to store the current path of validating document (SizeType)
+    size_t basePathSize_;                            //!< size of the path of the parent validator at the bottom of documentStack_
+    internal::Stack<StateAllocator> validatorPool_;  //!< released sub-validators for recycling (GenericSchemaValidator*)
+    internal::Stack<StateAllocator> hasherPool_;     //!< released hashers for recycling (HasherType*)
     OutputHandler* outputHandler_;
     ValueType error_;
     ValueType currentError_;
     ValueType missingDependents_;
     bool valid_;
+    bool topLevel_;                                  //!< not a sub-validator, so it releases its pools after each root value
 #if RAPIDJSON_SCHEMA_VERBOSE
     unsigned depth_;
 #endif
@@ -971,4 +971,105 @@ TEST_F(Misc, itoa64_Writer2_InsituStringStream) { itoa64_Writer_InsituStringStre
 TEST_F(Misc, itoa64_Writer3_InsituStringStream) { itoa64_Writer_InsituStringStream<Writer3<rapidjson::InsituStringStream> >(); }
 TEST_F(Misc, itoa64_Writer4_InsituStringStream) { itoa64_Writer_InsituStringStream<Writer4<rapidjson::InsituStringStream> >(); }
 
+
+// dtoa
+
+static const size_t kDtoaCount = 10000;
+static const size_t kDtoaTrialCount = 100;
+
+// Doubles with random bits, except for zeros, infinities and NaNs.
+static const double* GetDtoaRandval() {
+    static double values[kDtoaCount];
+    static bool initialized = false;
+    if (!initialized) {
+        uint64_t x = RAPIDJSON_UINT64_C2(0x9E3779B9, 0x7F4A7C15);
+        for (size_t i = 0; i < kDtoaCount; ) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            const uint64_t u = x & RAPIDJSON_UINT64_C2(0x7FFFFFFF, 0xFFFFFFFF);
+            if ((u >> 52) == 0x7FF || u == 0)
+                continue;
+            memcpy(&values[i++], &u, sizeof(double));
+        }
+        initialized = true;
+    }
+    return values;
+}
+
+// Digits and exponent of a positive double, where value = digits * 10^K.
+typedef void (*DigitGenFunc)(double, char*, int*, int*);
+
+inline void dtoa_sprintf(double value, char* buffer, int* length, int* K) {
+    // Shortest precision which round-trips
+    char s[32];
+    for (int precision = 1; precision <= 17; precision++) {
+        sprintf(s, "%.*e", precision - 1, value);
+        if (strtod(s, 0) == value)
+            break;
+    }
+    *length = 0;
+    const char* p = s;
+    for (; *p != 'e'; p++)
+        if (*p != '.')
+            buffer[(*length)++] = *p;
+    while (*length > 1 && buffer[*length - 1] == '0')
+        --*length;
+    *K = atoi(p + 1) - (*length - 1);
+}
+
+template <DigitGenFunc f>
+void dtoaVerify() {
+    const double* values = GetDtoaRandval();
+    size_t length = 0;
+    for (size_t j = 0; j < kDtoaCount; j++) {
+        char buffer[32], expected[32];
+        int len, K, expectedLen, expectedK;
+        f(values[j], buffer, &len, &K);
+        dtoa_sprintf(values[j], expected, &expectedLen, &expectedK);
+        buffer[len] = expected[expectedLen] = '\0';
+        char s[48];
+        sprintf(s, "%se%d", buffer, K);
+        ASSERT_EQ(values[j], strtod(s, 0)) << s;
+        ASSERT_GE(len, expectedLen);
+        length += static_cast<size_t>(len);
+    }
+    OUTPUT_LENGTH(length);
+}
+
+template <DigitGenFunc f>
+void dtoaShortestVerify() {
+    const double* values = GetDtoaRandval();
+    for (size_t j = 0; j < kDtoaCount; j++) {
+        char buffer[32], expected[32];
+        int len, K, expectedLen, expectedK;
+        f(values[j], buffer, &len, &K);
+        dtoa_sprintf(values[j], expected, &expectedLen, &expectedK);
+        buffer[len] = expected[expectedLen] = '\0';
+        ASSERT_STREQ(expected, buffer);
+        ASSERT_EQ(expectedK, K);
+    }
+}
+
+template <DigitGenFunc f>
+void dtoaSpeed() {
+    const double* values = GetDtoaRandval();
+    size_t length = 0;
+    for (size_t i = 0; i < kDtoaTrialCount; i++) {
+        for (size_t j = 0; j < kDtoaCount; j++) {
+            char buffer[32];
+            int len, K;
+            f(values[j], buffer, &len, &K);
+            length += static_cast<size_t>(len);
+        }
+    }
+    OUTPUT_LENGTH(length);
+}
+
+TEST_F(Misc, dtoa_Grisu2Verify) { dtoaVerify<rapidjson::internal::Grisu2>(); }
+TEST_F(Misc, dtoa_RyuVerify) { dtoaVerify<rapidjson::internal::Ryu>(); }
+TEST_F(Misc, dtoa_RyuShortestVerify) { dtoaShortestVerify<rapidjson::internal::Ryu>(); }
+TEST_F(Misc, dtoa_Grisu2) { dtoaSpeed<rapidjson::internal::Grisu2>(); }
+TEST_F(Misc, dtoa_Ryu) { dtoaSpeed<rapidjson::internal::Ryu>(); }
+
 #endif // TEST_MISC
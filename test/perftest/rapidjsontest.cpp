@@ -18,16 +18,30 @@
 
 #include "rapidjson/rapidjson.h"
 #include "rapidjson/document.h"
+#include "rapidjson/lazydocument.h"
 #include "rapidjson/prettywriter.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/filereadstream.h"
 #include "rapidjson/encodedstream.h"
 #include "rapidjson/memorystream.h"
+#include "rapidjson/memorymappedfilestream.h"
+#include "rapidjson/ndjson.h"
+#include "rapidjson/parallelwriter.h"
+#include "rapidjson/projection.h"
+
+#if RAPIDJSON_HAS_CXX11_THREADS
+#include <chrono>
+#include <string>
+#endif
 
 #ifdef RAPIDJSON_SSE2
 #define SIMD_SUFFIX(name) name##_SSE2
 #elif defined(RAPIDJSON_SSE42)
 #define SIMD_SUFFIX(name) name##_SSE42
+#elif defined(RAPIDJSON_AVX2)
+#define SIMD_SUFFIX(name) name##_AVX2
+#elif defined(RAPIDJSON_AVX512)
+#define SIMD_SUFFIX(name) name##_AVX512
 #elif defined(RAPIDJSON_NEON)
 #define SIMD_SUFFIX(name) name##_NEON
 #else
@@ -38,7 +52,7 @@ using namespace rapidjson;
 
 class RapidJson : public PerfTest {
 public:
-    RapidJson() : temp_(), doc_() {}
+    RapidJson() : temp_(), doc_(), longStrings_(), longStringsLength_(), longStringsTemp_(), longStringsDoc_() {}
 
     virtual void SetUp() {
         PerfTest::SetUp();
@@ -51,11 +65,37 @@ public:
 
         for (size_t i = 0; i < 7; i++)
             EXPECT_FALSE(typesDoc_[i].Parse(types_[i]).HasParseError());
+
+        // String-heavy payload: an array of 1024 strings of 1000 characters,
+        // with an escape near the end of every string.
+        {
+            const size_t count = 1024, strLength = 1000;
+            longStringsLength_ = 2 + count * (strLength + 3);
+            longStrings_ = (char *)malloc(longStringsLength_ + 1);
+            char* p = longStrings_;
+            *p++ = '[';
+            for (size_t i = 0; i < count; i++) {
+                *p++ = '\"';
+                for (size_t j = 0; j < strLength - 2; j++)
+                    *p++ = "The quick brown fox jumps over the lazy dog. "[(i + j) % 45];
+                *p++ = '\\';
+                *p++ = 'n';
+                *p++ = '\"';
+                *p++ = (i + 1 < count) ? ',' : ']';
+            }
+            *p++ = '\n';
+            *p = '\0';
+            RAPIDJSON_ASSERT(static_cast<size_t>(p - longStrings_) == longStringsLength_);
+            longStringsTemp_ = (char *)malloc(longStringsLength_ + 1);
+            EXPECT_FALSE(longStringsDoc_.Parse(longStrings_).HasParseError());
+        }
     }
 
     virtual void TearDown() {
         PerfTest::TearDown();
         free(temp_);
+        free(longStrings_);
+        free(longStringsTemp_);
     }
 
 private:
@@ -66,6 +106,10 @@ protected:
     char *temp_;
     Document doc_;
     Document typesDoc_[7];
+    char *longStrings_;
+    size_t longStringsLength_;
+    char *longStringsTemp_;
+    Document longStringsDoc_;
 };
 
 TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseInsitu_DummyHandler)) {
@@ -114,6 +158,14 @@ TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseInsitu_DummyHandler_##Name)) {\
         Reader reader;\
         EXPECT_TRUE(reader.Parse<kParseInsituFlag>(s, h));\
     }\
+}\
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseStructuralIndex_DummyHandler_##Name)) {\
+    for (size_t i = 0; i < kTrialCount * 10; i++) {\
+        StringStream s(types_[index]);\
+        BaseReaderHandler<> h;\
+        Reader reader;\
+        EXPECT_TRUE(reader.Parse<kParseStructuralIndexFlag>(s, h));\
+    }\
 }
 
 TEST_TYPED(0, Booleans)
@@ -126,6 +178,42 @@ TEST_TYPED(6, Paragraphs)
 
 #undef TEST_TYPED
 
+// integers.json as 13-digit millisecond timestamps, like IDs and timestamps of records.
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_Timestamps)) {
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    writer.StartArray();
+    for (Value::ConstValueIterator itr = typesDoc_[3].Begin(); itr != typesDoc_[3].End(); ++itr)
+        writer.Uint64(RAPIDJSON_UINT64_C2(0x174, 0x876E8000) + itr->GetUint64() * 1000);    // 1600000000000 ms
+    writer.EndArray();
+
+    for (size_t i = 0; i < kTrialCount * 10; i++) {
+        StringStream s(sb.GetString());
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse(s, h));
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_LongStrings)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(longStrings_);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse(s, h));
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseInsitu_DummyHandler_LongStrings)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        memcpy(longStringsTemp_, longStrings_, longStringsLength_ + 1);
+        InsituStringStream s(longStringsTemp_);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseInsituFlag>(s, h));
+    }
+}
+
 TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_FullPrecision)) {
     for (size_t i = 0; i < kTrialCount; i++) {
         StringStream s(json_);
@@ -183,6 +271,34 @@ TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseIterativePullInsitu_DummyHandler)) {
     }
 }
 
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseStructuralIndex_DummyHandler)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(json_);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseStructuralIndexFlag>(s, h));
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseStructuralIndexInsitu_DummyHandler)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        memcpy(temp_, json_, length_ + 1);
+        InsituStringStream s(temp_);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseStructuralIndexFlag|kParseInsituFlag>(s, h));
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseStructuralIndex_DummyHandler_LongStrings)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(longStrings_);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseStructuralIndexFlag>(s, h));
+    }
+}
+
 TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_ValidateEncoding)) {
     for (size_t i = 0; i < kTrialCount; i++) {
         StringStream s(json_);
@@ -218,6 +334,60 @@ TEST_F(RapidJson, SIMD_SUFFIX(DocumentParse_MemoryPoolAllocator)) {
     }
 }
 
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseStructuralIndex_MemoryPoolAllocator)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Parse<kParseStructuralIndexFlag>(json_);
+        ASSERT_TRUE(doc.IsObject());
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseReferenceSource_MemoryPoolAllocator)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Parse<kParseReferenceSourceFlag>(json_);
+        ASSERT_TRUE(doc.IsObject());
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(LazyDocumentParse_OneMember)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        LazyDocument doc;
+        doc.Parse(json_);
+        ASSERT_TRUE(doc.IsObject());
+        ASSERT_TRUE(doc.MemberBegin() != doc.MemberEnd());
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(LazyDocumentParse_All)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        LazyDocument doc;
+        doc.Parse(json_);
+        Value v;
+        ASSERT_FALSE(doc.Materialize(v, doc.GetAllocator()).IsError());
+        ASSERT_TRUE(v.IsObject());
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderSkipValue)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(json_);
+        Reader reader;
+        EXPECT_FALSE(reader.SkipValue<kParseDefaultFlags>(s).IsError());
+        EXPECT_EQ(length_, s.Tell());
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ProjectionReader_OneMember)) {
+    Pointer pointer("/key");
+    for (size_t i = 0; i < kTrialCount; i++) {
+        ProjectionReader reader(&pointer, 1);
+        Document doc;
+        EXPECT_FALSE(reader.Parse<kParseDefaultFlags>(json_, doc).IsError());
+        ASSERT_TRUE(doc["key"].IsString());
+    }
+}
+
 TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseLength_MemoryPoolAllocator)) {
     for (size_t i = 0; i < kTrialCount; i++) {
         Document doc;
@@ -274,6 +444,45 @@ TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseAutoUTFInputStream_MemoryStream)) {
     }
 }
 
+#if RAPIDJSON_HAS_CXX11_THREADS
+
+// NDJSON text with the elements of an array as records, repeated to recordCount records.
+static std::string MakeNDJSON(const Document& array, size_t recordCount) {
+    std::string ndjson;
+    for (size_t i = 0; i < recordCount; i++) {
+        StringBuffer sb;
+        Writer<StringBuffer> writer(sb);
+        array[static_cast<SizeType>(i % array.Size())].Accept(writer);
+        ndjson.append(sb.GetString(), sb.GetSize());
+        ndjson += '\n';
+    }
+    return ndjson;
+}
+
+// Records of mixed.json, parsed into documents with the given number of threads.
+#define TEST_NDJSON(threadCount)\
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseNDJSON_##threadCount##Threads)) {\
+    const size_t recordCount = 10000;\
+    const size_t trialCount = 10;\
+    const std::string ndjson = MakeNDJSON(typesDoc_[4], recordCount);\
+    NDJSONReader reader(threadCount);\
+    std::vector<Document> documents;\
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();\
+    for (size_t i = 0; i < trialCount; i++) {\
+        EXPECT_TRUE(reader.Parse<0>(ndjson.data(), ndjson.size(), documents));\
+        ASSERT_EQ(recordCount, documents.size());\
+    }\
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();\
+    printf("%u threads: %.0f records/s\n", reader.GetThreadCount(), static_cast<double>(recordCount * trialCount) / seconds);\
+}
+TEST_NDJSON(1)
+TEST_NDJSON(2)
+TEST_NDJSON(4)
+TEST_NDJSON(8)
+#undef TEST_NDJSON
+
+#endif // RAPIDJSON_HAS_CXX11_THREADS
+
 template<typename T>
 size_t Traverse(const T& value) {
     size_t count = 1;
@@ -384,6 +593,43 @@ TEST_TYPED(6, Paragraphs)
 
 #undef TEST_TYPED
 
+TEST_F(RapidJson, SIMD_SUFFIX(Writer_StringBuffer_LongStrings)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringBuffer s(0, 2048 * 1024);
+        Writer<StringBuffer> writer(s);
+        longStringsDoc_.Accept(writer);
+        const char* str = s.GetString();
+        (void)str;
+    }
+}
+
+#if RAPIDJSON_HAS_CXX11_THREADS
+
+// Same output as Writer_StringBuffer, with the given number of threads.
+#define TEST_PARALLEL_WRITER(threadCount)\
+TEST_F(RapidJson, SIMD_SUFFIX(ParallelWriter_StringBuffer_##threadCount##Threads)) {\
+    StringBuffer expected;\
+    Writer<StringBuffer> w(expected);\
+    doc_.Accept(w);\
+    ParallelWriter writer(threadCount);\
+    StringBuffer actual;\
+    ASSERT_TRUE(writer.Write(doc_, actual));\
+    ASSERT_STREQ(expected.GetString(), actual.GetString());\
+    for (size_t i = 0; i < kTrialCount; i++) {\
+        StringBuffer s(0, 1024 * 1024);\
+        writer.Write(doc_, s);\
+        const char* str = s.GetString();\
+        (void)str;\
+    }\
+}
+TEST_PARALLEL_WRITER(1)
+TEST_PARALLEL_WRITER(2)
+TEST_PARALLEL_WRITER(4)
+TEST_PARALLEL_WRITER(8)
+#undef TEST_PARALLEL_WRITER
+
+#endif // RAPIDJSON_HAS_CXX11_THREADS
+
 TEST_F(RapidJson, SIMD_SUFFIX(PrettyWriter_StringBuffer)) {
     for (size_t i = 0; i < kTrialCount; i++) {
         StringBuffer s(0, 2048 * 1024);
@@ -463,6 +709,27 @@ TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_FileReadStream)) {
     }
 }
 
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParse_MmapFile)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        MemoryMappedFileStream s(filename_);
+        Document doc;
+        doc.ParseStream(s.GetStringStream());
+        ASSERT_TRUE(doc.IsObject());
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParse_FileReadStream)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        FILE *fp = fopen(filename_, "rb");
+        char buffer[65536];
+        FileReadStream s(fp, buffer, sizeof(buffer));
+        Document doc;
+        doc.ParseStream(s);
+        ASSERT_TRUE(doc.IsObject());
+        fclose(fp);
+    }
+}
+
 TEST_F(RapidJson, StringBuffer) {
     StringBuffer sb;
     for (int i = 0; i < 32 * 1024 * 1024; i++)
@@ -0,0 +1,76 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+// 
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed 
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR 
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the 
+// specific language governing permissions and limitations under the License.
+
+#include "perftest.h"
+
+#if TEST_RAPIDJSON
+
+#include "rapidjson/internal/regex.h"
+#include <ctime>
+#include <string>
+#include <vector>
+
+using rapidjson::internal::RegexSearch;
+
+class Regex : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        // Property names and phone numbers, like those matched by "patternProperties" and "pattern" in schemas
+        char buffer[64];
+        for (int i = 0; i < 10000; i++) {
+            sprintf(buffer, "property_%d_name", i);
+            names_.push_back(buffer);
+            sprintf(buffer, "(%03d)%03d-%04d", i % 1000, (i * 7) % 1000, (i * 7919) % 10000);
+            phones_.push_back(buffer);
+        }
+    }
+
+protected:
+    static void Run(const char* pattern, const std::vector<std::string>& strings, bool search) {
+        rapidjson::internal::Regex re(pattern);
+        ASSERT_TRUE(re.IsValid());
+        RegexSearch rs(re);
+        const int trialCount = 100;
+        size_t matchCount = 0;
+        clock_t start = clock();
+        for (int i = 0; i < trialCount; i++)
+            for (std::vector<std::string>::const_iterator itr = strings.begin(); itr != strings.end(); ++itr)
+                matchCount += (search ? rs.Search(itr->c_str()) : rs.Match(itr->c_str())) ? 1 : 0;
+        clock_t end = clock();
+        double duration = double(end - start) / CLOCKS_PER_SEC;
+        EXPECT_EQ(strings.size() * trialCount, matchCount);
+        printf("%d trials of %u strings in %f s -> %f strings per sec\n", trialCount, static_cast<unsigned>(strings.size()), duration, trialCount * strings.size() / duration);
+    }
+
+    std::vector<std::string> names_;
+    std::vector<std::string> phones_;
+};
+
+TEST_F(Regex, Match_PropertyName) {
+    Run("[a-z][a-z0-9_]*", names_, false);
+}
+
+TEST_F(Regex, Search_PropertyName) {
+    Run("_[0-9]+_", names_, true);
+}
+
+TEST_F(Regex, Match_Phone) {
+    Run("^(\\([0-9]{3}\\))?[0-9]{3}-[0-9]{4}$", phones_, false);
+}
+
+TEST_F(Regex, Search_Phone) {
+    Run("[0-9]{3}-[0-9]{4}$", phones_, true);
+}
+
+#endif // TEST_RAPIDJSON
@@ -3,10 +3,18 @@
 #if TEST_RAPIDJSON
 
 #include "rapidjson/schema.h"
+#include "rapidjson/parallelschema.h"
+#include "rapidjson/memorybuffer.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
 #include <ctime>
 #include <string>
 #include <vector>
 
+#if RAPIDJSON_HAS_CXX11_THREADS
+#include <chrono>
+#endif
+
 #define ARRAY_SIZE(a) sizeof(a) / sizeof(a[0])
 
 using namespace rapidjson;
@@ -213,4 +221,366 @@ TEST_F(Schema, TestSuite) {
     printf("%d tests per trial\n", testCount / trialCount);
 }
 
+TEST_F(Schema, UniqueItems_Large) {
+    Document sd;
+    sd.Parse("{\"type\": \"array\", \"items\": {\"type\": \"integer\"}, \"uniqueItems\": true}");
+    SchemaDocument schema(sd);
+
+    Document d;
+    d.SetArray();
+    for (int i = 0; i < 50000; i++)
+        d.PushBack(i * 7919, d.GetAllocator());
+
+    const int trialCount = 20;
+    clock_t start = clock();
+    for (int i = 0; i < trialCount; i++) {
+        SchemaValidator validator(schema);
+        EXPECT_TRUE(d.Accept(validator));
+    }
+    clock_t end = clock();
+    double duration = double(end - start) / CLOCKS_PER_SEC;
+    printf("%d trials of %u unique items in %f s -> %f trials per sec\n", trialCount, d.Size(), duration, trialCount / duration);
+}
+
+TEST_F(Schema, Object_ManyProperties) {
+    const int propertyCount = 500;
+    Document sd;
+    sd.SetObject();
+    Value properties(kObjectType);
+    Document d;
+    d.SetObject();
+    for (int i = 0; i < propertyCount; i++) {
+        char name[32];
+        sprintf(name, "property_%d", i);
+        Value type(kObjectType);
+        type.AddMember("type", "integer", sd.GetAllocator());
+        Value schemaName(name, sd.GetAllocator());
+        properties.AddMember(schemaName, type, sd.GetAllocator());
+        Value memberName(name, d.GetAllocator());
+        d.AddMember(memberName, i, d.GetAllocator());
+    }
+    sd.AddMember("properties", properties, sd.GetAllocator());
+    sd.AddMember("additionalProperties", false, sd.GetAllocator());
+    SchemaDocument schema(sd);
+
+    const int trialCount = 1000;
+    clock_t start = clock();
+    for (int i = 0; i < trialCount; i++) {
+        SchemaValidator validator(schema);
+        EXPECT_TRUE(d.Accept(validator));
+    }
+    clock_t end = clock();
+    double duration = double(end - start) / CLOCKS_PER_SEC;
+    printf("%d trials of %d properties in %f s -> %f trials per sec\n", trialCount, propertyCount, duration, trialCount / duration);
+}
+
+TEST_F(Schema, Enum_Large) {
+    const int enumCount = 5000;
+    Document sd;
+    sd.SetObject();
+    Value e(kArrayType);
+    for (int i = 0; i < enumCount; i++) {
+        char code[32];
+        sprintf(code, "SKU%06d", i);
+        e.PushBack(Value(code, sd.GetAllocator()).Move(), sd.GetAllocator());
+    }
+    Value items(kObjectType);
+    items.AddMember("enum", e, sd.GetAllocator());
+    sd.AddMember("type", "array", sd.GetAllocator());
+    sd.AddMember("items", items, sd.GetAllocator());
+    SchemaDocument schema(sd);
+
+    Document d;
+    d.SetArray();
+    for (int i = 0; i < 1000; i++) {
+        char code[32];
+        sprintf(code, "SKU%06d", (i * 7919) % enumCount);
+        d.PushBack(Value(code, d.GetAllocator()).Move(), d.GetAllocator());
+    }
+
+    const int trialCount = 100;
+    clock_t start = clock();
+    for (int i = 0; i < trialCount; i++) {
+        SchemaValidator validator(schema);
+        EXPECT_TRUE(d.Accept(validator));
+    }
+    clock_t end = clock();
+    double duration = double(end - start) / CLOCKS_PER_SEC;
+    printf("%d trials of %u values in an enum of %d in %f s -> %f trials per sec\n", trialCount, d.Size(), enumCount, duration, trialCount / duration);
+}
+
+TEST_F(Schema, Valid_LargeDocument) {
+    // Valid values, where the path of the document is never reported
+    Document sd;
+    sd.Parse(
+        "{ \"type\": \"array\", \"items\": {"
+        "    \"type\": \"object\","
+        "    \"properties\": {"
+        "        \"id\": { \"type\": \"integer\" },"
+        "        \"name\": { \"type\": \"string\" },"
+        "        \"tags\": { \"type\": \"array\", \"items\": { \"type\": \"string\" } },"
+        "        \"position\": { \"type\": \"array\", \"items\": { \"type\": \"number\" } }"
+        "    }"
+        "}}");
+    SchemaDocument schema(sd);
+
+    Document d;
+    d.SetArray();
+    for (int i = 0; i < 10000; i++) {
+        Value item(kObjectType);
+        item.AddMember("id", i, d.GetAllocator());
+        item.AddMember("name", "some/name~with escapes", d.GetAllocator());
+        Value tags(kArrayType);
+        for (int j = 0; j < 5; j++)
+            tags.PushBack("tag", d.GetAllocator());
+        item.AddMember("tags", tags, d.GetAllocator());
+        Value position(kArrayType);
+        for (int j = 0; j < 3; j++)
+            position.PushBack(i * 0.5, d.GetAllocator());
+        item.AddMember("position", position, d.GetAllocator());
+        d.PushBack(item, d.GetAllocator());
+    }
+
+    const int trialCount = 100;
+    clock_t start = clock();
+    for (int i = 0; i < trialCount; i++) {
+        SchemaValidator validator(schema);
+        EXPECT_TRUE(d.Accept(validator));
+    }
+    clock_t end = clock();
+    double duration = double(end - start) / CLOCKS_PER_SEC;
+    printf("%d trials of %u items in %f s -> %f trials per sec\n", trialCount, d.Size(), duration, trialCount / duration);
+}
+
+TEST_F(Schema, OneOf_LargeArray) {
+    // Every element spawns a sub-validator per branch of oneOf/allOf
+    Document sd;
+    sd.Parse(
+        "{ \"type\": \"array\", \"items\": { \"oneOf\": ["
+        "    { \"type\": \"object\", \"properties\": { \"kind\": { \"enum\": [\"circle\"] }, \"radius\": { \"type\": \"number\" } }, \"required\": [\"kind\", \"radius\"] },"
+        "    { \"type\": \"object\", \"properties\": { \"kind\": { \"enum\": [\"square\"] }, \"side\": { \"type\": \"number\" } }, \"required\": [\"kind\", \"side\"] },"
+        "    { \"allOf\": [ { \"type\": \"object\" }, { \"properties\": { \"kind\": { \"enum\": [\"point\"] } }, \"required\": [\"kind\"] } ] }"
+        "]}}");
+    SchemaDocument schema(sd);
+
+    Document d;
+    d.SetArray();
+    static const char* const kinds[] = { "circle", "square", "point" };
+    static const char* const sizes[] = { "radius", "side", "weight" };
+    for (int i = 0; i < 10000; i++) {
+        Value item(kObjectType);
+        item.AddMember("kind", StringRef(kinds[i % 3]), d.GetAllocator());
+        item.AddMember(StringRef(sizes[i % 3]), i * 0.5, d.GetAllocator());
+        d.PushBack(item, d.GetAllocator());
+    }
+
+    const int trialCount = 100;
+    clock_t start = clock();
+    for (int i = 0; i < trialCount; i++) {
+        SchemaValidator validator(schema);
+        EXPECT_TRUE(d.Accept(validator));
+    }
+    clock_t end = clock();
+    double duration = double(end - start) / CLOCKS_PER_SEC;
+    printf("%d trials of %u items in %f s -> %f trials per sec\n", trialCount, d.Size(), duration, trialCount / duration);
+}
+
+
+TEST_F(Schema, OneOf_Discriminated) {
+    // The kind of each element rules out all but one branch early, before its large payload
+    const int kindCount = 8;
+    Document sd;
+    sd.SetObject();
+    Value oneOf(kArrayType);
+    for (int k = 0; k < kindCount; k++) {
+        Value kindEnum(kArrayType);
+        kindEnum.PushBack(k, sd.GetAllocator());
+        Value kind(kObjectType);
+        kind.AddMember("enum", kindEnum, sd.GetAllocator());
+        Value items(kObjectType);
+        items.AddMember("type", "number", sd.GetAllocator());
+        Value payload(kObjectType);
+        payload.AddMember("type", "array", sd.GetAllocator());
+        payload.AddMember("items", items, sd.GetAllocator());
+        Value properties(kObjectType);
+        properties.AddMember("kind", kind, sd.GetAllocator());
+        properties.AddMember("payload", payload, sd.GetAllocator());
+        Value branch(kObjectType);
+        branch.AddMember("properties", properties, sd.GetAllocator());
+        oneOf.PushBack(branch, sd.GetAllocator());
+    }
+    Value itemSchema(kObjectType);
+    itemSchema.AddMember("oneOf", oneOf, sd.GetAllocator());
+    sd.AddMember("type", "array", sd.GetAllocator());
+    sd.AddMember("items", itemSchema, sd.GetAllocator());
+    SchemaDocument schema(sd);
+
+    Document d;
+    d.SetArray();
+    for (int i = 0; i < 1000; i++) {
+        Value item(kObjectType);
+        item.AddMember("kind", i % kindCount, d.GetAllocator());
+        Value payload(kArrayType);
+        for (int j = 0; j < 100; j++)
+            payload.PushBack(j * 0.5, d.GetAllocator());
+        item.AddMember("payload", payload, d.GetAllocator());
+        d.PushBack(item, d.GetAllocator());
+    }
+
+    const int trialCount = 100;
+    clock_t start = clock();
+    for (int i = 0; i < trialCount; i++) {
+        SchemaValidator validator(schema);
+        EXPECT_TRUE(d.Accept(validator));
+    }
+    clock_t end = clock();
+    double duration = double(end - start) / CLOCKS_PER_SEC;
+    printf("%d trials of %u items of %d kinds in %f s -> %f trials per sec\n", trialCount, d.Size(), kindCount, duration, trialCount / duration);
+}
+
+TEST_F(Schema, PatternProperties_Many) {
+    // Each member name is searched by all patternProperties
+    const int patternCount = 16;
+    Document sd;
+    sd.SetObject();
+    Value patternProperties(kObjectType);
+    for (int k = 0; k < patternCount; k++) {
+        char pattern[32];
+        sprintf(pattern, "^p%d_[a-z]+$", k);
+        Value name(pattern, sd.GetAllocator());
+        Value property(kObjectType);
+        property.AddMember("type", "integer", sd.GetAllocator());
+        patternProperties.AddMember(name, property, sd.GetAllocator());
+    }
+    sd.AddMember("type", "object", sd.GetAllocator());
+    sd.AddMember("patternProperties", patternProperties, sd.GetAllocator());
+    SchemaDocument schema(sd);
+
+    Document d;
+    d.SetObject();
+    for (int i = 0; i < 1000; i++) {
+        char buffer[32];
+        sprintf(buffer, "p%d_member%c", i % patternCount, 'a' + i % 26);
+        Value name(buffer, d.GetAllocator());
+        d.AddMember(name, i, d.GetAllocator());
+    }
+
+    const int trialCount = 1000;
+    clock_t start = clock();
+    for (int i = 0; i < trialCount; i++) {
+        SchemaValidator validator(schema);
+        EXPECT_TRUE(d.Accept(validator));
+    }
+    clock_t end = clock();
+    double duration = double(end - start) / CLOCKS_PER_SEC;
+    printf("%d trials of %u members of %d patterns in %f s -> %f trials per sec\n", trialCount, d.MemberCount(), patternCount, duration, trialCount / duration);
+}
+
+TEST_F(Schema, Image_Load) {
+    // A bundle of definitions referencing each other, compiled from its JSON text or loaded from its image
+    const int definitionCount = 500;
+    Document sd;
+    sd.SetObject();
+    Value definitions(kObjectType);
+    for (int k = 0; k < definitionCount; k++) {
+        char buffer[64];
+        Value properties(kObjectType);
+        for (int j = 0; j < 8; j++) {
+            Value property(kObjectType);
+            if (j == 0 && k + 1 < definitionCount) {
+                sprintf(buffer, "#/definitions/d%d", k + 1);
+                property.AddMember("$ref", Value(buffer, sd.GetAllocator()).Move(), sd.GetAllocator());
+            }
+            else {
+                property.AddMember("type", StringRef(j % 2 ? "string" : "integer"), sd.GetAllocator());
+                property.AddMember(StringRef(j % 2 ? "maxLength" : "minimum"), j, sd.GetAllocator());
+            }
+            sprintf(buffer, "p%d", j);
+            properties.AddMember(Value(buffer, sd.GetAllocator()).Move(), property, sd.GetAllocator());
+        }
+        Value definition(kObjectType);
+        definition.AddMember("type", "object", sd.GetAllocator());
+        definition.AddMember("properties", properties, sd.GetAllocator());
+        sprintf(buffer, "d%d", k);
+        definitions.AddMember(Value(buffer, sd.GetAllocator()).Move(), definition, sd.GetAllocator());
+    }
+    sd.AddMember("definitions", definitions, sd.GetAllocator());
+    sd.AddMember("$ref", "#/definitions/d0", sd.GetAllocator());
+
+    StringBuffer json;
+    Writer<StringBuffer> writer(json);
+    sd.Accept(writer);
+    MemoryBuffer image;
+    SchemaDocument(sd).Serialize(image);
+
+    const int trialCount = 20;
+    clock_t start = clock();
+    for (int i = 0; i < trialCount; i++) {
+        Document d;
+        d.Parse(json.GetString());
+        SchemaDocument schema(d);
+    }
+    clock_t end = clock();
+    double duration = double(end - start) / CLOCKS_PER_SEC;
+    printf("%d trials of compiling %u bytes of JSON in %f s -> %f trials per sec\n", trialCount, static_cast<unsigned>(json.GetSize()), duration, trialCount / duration);
+
+    start = clock();
+    for (int i = 0; i < trialCount; i++) {
+        SchemaDocument schema(image.GetBuffer(), image.GetSize());
+        EXPECT_TRUE(schema.IsValid());
+    }
+    end = clock();
+    duration = double(end - start) / CLOCKS_PER_SEC;
+    printf("%d trials of loading %u bytes of image in %f s -> %f trials per sec\n", trialCount, static_cast<unsigned>(image.GetSize()), duration, trialCount / duration);
+}
+
+
+#if RAPIDJSON_HAS_CXX11_THREADS
+
+// Records of Valid_LargeDocument as the elements of an array, validated one by one with the given number of threads.
+#define TEST_PARALLEL(threadCount)\
+TEST_F(Schema, ParallelValidate_##threadCount##Threads) {\
+    Document sd;\
+    sd.Parse(\
+        "{ \"type\": \"object\","\
+        "  \"properties\": {"\
+        "      \"id\": { \"type\": \"integer\" },"\
+        "      \"name\": { \"type\": \"string\" },"\
+        "      \"tags\": { \"type\": \"array\", \"items\": { \"type\": \"string\" } },"\
+        "      \"position\": { \"type\": \"array\", \"items\": { \"type\": \"number\" } }"\
+        "  }"\
+        "}");\
+    SchemaDocument schema(sd);\
+    Document d;\
+    d.SetArray();\
+    for (int i = 0; i < 10000; i++) {\
+        Value item(kObjectType);\
+        item.AddMember("id", i, d.GetAllocator());\
+        item.AddMember("name", "some/name~with escapes", d.GetAllocator());\
+        Value tags(kArrayType);\
+        for (int j = 0; j < 5; j++)\
+            tags.PushBack("tag", d.GetAllocator());\
+        item.AddMember("tags", tags, d.GetAllocator());\
+        Value position(kArrayType);\
+        for (int j = 0; j < 3; j++)\
+            position.PushBack(i * 0.5, d.GetAllocator());\
+        item.AddMember("position", position, d.GetAllocator());\
+        d.PushBack(item, d.GetAllocator());\
+    }\
+    const int trialCount = 100;\
+    ParallelSchemaValidator validator(schema, threadCount);\
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();\
+    for (int i = 0; i < trialCount; i++)\
+        EXPECT_TRUE(validator.Validate(d));\
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();\
+    printf("%u threads: %d trials of %u items in %f s -> %f trials per sec\n", validator.GetThreadCount(), trialCount, d.Size(), seconds, trialCount / seconds);\
+}
+TEST_PARALLEL(1)
+TEST_PARALLEL(2)
+TEST_PARALLEL(4)
+TEST_PARALLEL(8)
+#undef TEST_PARALLEL
+
+#endif // RAPIDJSON_HAS_CXX11_THREADS
+
 #endif
@@ -15,6 +15,12 @@
 #include "unittest.h"
 
 #include "rapidjson/allocators.h"
+#include "rapidjson/document.h"
+
+#if RAPIDJSON_HAS_CXX11_THREADS
+#include <thread>
+#include <vector>
+#endif
 
 using namespace rapidjson;
 
@@ -62,6 +68,109 @@ TEST(Allocator, MemoryPoolAllocator) {
     }
 }
 
+#if RAPIDJSON_HAS_CXX11_THREADS
+
+TEST(Allocator, ConcurrentMemoryPoolAllocator) {
+    ConcurrentMemoryPoolAllocator<> a;
+    TestAllocator(a);
+
+    for (size_t i = 1; i < 1000; i++) {
+        EXPECT_TRUE(a.Malloc(i) != 0);
+        EXPECT_LE(a.Size(), a.Capacity());
+    }
+
+    // Expand the last allocation in place
+    a.Clear();
+    void* p = a.Malloc(100);
+    EXPECT_EQ(p, a.Realloc(p, 100, 200));
+    EXPECT_TRUE(a.Malloc(2 * 64 * 1024) != 0);  // larger than a chunk
+    void* q = a.Realloc(p, 200, 300);
+    EXPECT_EQ(p, q);
+    EXPECT_LE(a.Size(), a.Capacity());
+
+    a.Clear();
+    EXPECT_EQ(0u, a.Capacity());
+    EXPECT_EQ(0u, a.Size());
+    EXPECT_TRUE(a.Malloc(10) != 0);
+}
+
+TEST(Allocator, ConcurrentMemoryPoolAllocator_Threads) {
+    const unsigned threadCount = 24;    // more than the cache slots
+    const unsigned blockCount = 2000;
+    ConcurrentMemoryPoolAllocator<> a(4096);
+    std::vector<std::vector<uint8_t*> > blocks(threadCount);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadCount; t++)
+        threads.push_back(std::thread([&a, &blocks, t]() {
+            for (unsigned i = 0; i < blockCount; i++) {
+                const size_t size = 1 + (i * 7 + t) % 100;
+                uint8_t* p = static_cast<uint8_t*>(a.Malloc(size));
+                if (i % 3 == 0)
+                    p = static_cast<uint8_t*>(a.Realloc(p, size, size + 50));
+                ASSERT_TRUE(p != 0);
+                std::memset(p, static_cast<int>(t), size);
+                blocks[t].push_back(p);
+            }
+        }));
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+
+    // Blocks of different threads do not overlap
+    for (unsigned t = 0; t < threadCount; t++) {
+        ASSERT_EQ(blockCount, blocks[t].size());
+        for (unsigned i = 0; i < blockCount; i++) {
+            const size_t size = 1 + (i * 7 + t) % 100;
+            for (size_t j = 0; j < size; j++)
+                ASSERT_EQ(t, blocks[t][i][j]);
+        }
+    }
+    EXPECT_LE(a.Size(), a.Capacity());
+}
+
+TEST(Allocator, ConcurrentMemoryPoolAllocator_Document) {
+    typedef GenericDocument<UTF8<>, ConcurrentMemoryPoolAllocator<> > DocumentType;
+    typedef DocumentType::ValueType ValueType;
+    const unsigned threadCount = 8;
+    const unsigned count = 1000;
+
+    // Each thread builds an element of the root array with the allocator of the document
+    DocumentType d(kArrayType);
+    std::vector<ValueType> elements(threadCount);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadCount; t++)
+        threads.push_back(std::thread([&d, &elements, t]() {
+            DocumentType::AllocatorType& allocator = d.GetAllocator();
+            ValueType& e = elements[t];
+            e.SetObject();
+            for (unsigned i = 0; i < count; i++) {
+                char name[32];
+                const int length = sprintf(name, "%u-%u", t, i);
+                ValueType v(kArrayType);
+                v.PushBack(i, allocator).PushBack(ValueType(name, static_cast<SizeType>(length), allocator), allocator);
+                e.AddMember(ValueType(name, static_cast<SizeType>(length), allocator), v, allocator);
+            }
+        }));
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+    for (unsigned t = 0; t < threadCount; t++)
+        d.PushBack(elements[t], d.GetAllocator());
+
+    ASSERT_EQ(threadCount, d.Size());
+    for (unsigned t = 0; t < threadCount; t++) {
+        ASSERT_EQ(count, d[t].MemberCount());
+        for (unsigned i = 0; i < count; i++) {
+            char name[32];
+            sprintf(name, "%u-%u", t, i);
+            const ValueType& v = d[t][name];
+            EXPECT_EQ(i, v[0].GetUint());
+            EXPECT_STREQ(name, v[1].GetString());
+        }
+    }
+}
+
+#endif // RAPIDJSON_HAS_CXX11_THREADS
+
 TEST(Allocator, Alignment) {
 #if RAPIDJSON_64BIT == 1
     EXPECT_EQ(RAPIDJSON_UINT64_C2(0x00000000, 0x00000000), RAPIDJSON_ALIGN(0));
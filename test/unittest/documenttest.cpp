@@ -153,6 +153,38 @@ TEST(Document, UnchangedOnParseError) {
     EXPECT_EQ(doc.MemberCount(), 0u);
 }
 
+TEST(Document, Parse_ReferenceSource) {
+    const char* json = "{\"hello\":\"world\",\"esc\\n\":\"a\\tb\",\"a\":[\"x\",\"y\"]}";
+    const size_t length = strlen(json);
+
+    for (int structural = 0; structural < 2; structural++) {
+        Document doc;
+        if (structural)
+            doc.Parse<kParseReferenceSourceFlag | kParseStructuralIndexFlag>(json);
+        else
+            doc.Parse<kParseReferenceSourceFlag>(json);
+        ASSERT_FALSE(doc.HasParseError());
+
+        Document expected;
+        expected.Parse(json);
+        EXPECT_TRUE(doc == expected);
+
+        // Unescaped names and strings refer to the source, and are not null-terminated
+        const Value::ConstMemberIterator hello = doc.MemberBegin();
+        EXPECT_TRUE(hello->name.GetString() >= json && hello->name.GetString() < json + length);
+        EXPECT_EQ(5u, hello->name.GetStringLength());
+        EXPECT_TRUE(hello->value.GetString() >= json && hello->value.GetString() < json + length);
+        EXPECT_EQ('\"', hello->value.GetString()[hello->value.GetStringLength()]);
+        EXPECT_TRUE(doc["a"][1].GetString() >= json && doc["a"][1].GetString() < json + length);
+
+        // Escaped ones are copied
+        const Value::ConstMemberIterator esc = doc.MemberBegin() + 1;
+        EXPECT_FALSE(esc->name.GetString() >= json && esc->name.GetString() < json + length);
+        EXPECT_STREQ("esc\n", esc->name.GetString());
+        EXPECT_STREQ("a\tb", esc->value.GetString());
+    }
+}
+
 static FILE* OpenEncodedFile(const char* filename) {
     const char *paths[] = {
         "encodings",
@@ -14,6 +14,9 @@
 
 #include "unittest.h"
 #include "rapidjson/internal/dtoa.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 #ifdef __GNUC__
 RAPIDJSON_DIAG_PUSH
@@ -93,6 +96,85 @@ TEST(dtoa, maxDecimalPlaces) {
 }
 
 
+// dtoa() with the shortest digits of Ryu
+static char* ShortestDtoa(double value, char* buffer, int maxDecimalPlaces = 324) {
+    if (Double(value).IsZero())
+        return dtoa(value, buffer, maxDecimalPlaces);
+    if (value < 0) {
+        *buffer++ = '-';
+        value = -value;
+    }
+    int length, K;
+    Ryu(value, buffer, &length, &K);
+    return Prettify(buffer, length, K, maxDecimalPlaces);
+}
+
+TEST(dtoa, Ryu) {
+    char buffer[30];
+
+#define TEST_DTOA(d, a)\
+    *ShortestDtoa(d, buffer) = '\0';\
+    EXPECT_STREQ(a, buffer)
+
+    TEST_DTOA(1.0, "1.0");
+    TEST_DTOA(-1.0, "-1.0");
+    TEST_DTOA(1.2345, "1.2345");
+    TEST_DTOA(1.2345678, "1.2345678");
+    TEST_DTOA(0.123456789012, "0.123456789012");
+    TEST_DTOA(1234567.8, "1234567.8");
+    TEST_DTOA(-79.39773355813419, "-79.39773355813419");
+    TEST_DTOA(0.000001, "0.000001");
+    TEST_DTOA(0.0000001, "1e-7");
+    TEST_DTOA(1e30, "1e30");
+    TEST_DTOA(1.234567890123456e30, "1.234567890123456e30");
+    TEST_DTOA(5e-324, "5e-324"); // Min subnormal positive double
+    TEST_DTOA(2.225073858507201e-308, "2.225073858507201e-308"); // Max subnormal positive double
+    TEST_DTOA(2.2250738585072014e-308, "2.2250738585072014e-308"); // Min normal positive double
+    TEST_DTOA(1.7976931348623157e308, "1.7976931348623157e308"); // Max double
+    TEST_DTOA(9007199254740991.0, "9007199254740991.0"); // 2^53 - 1
+    TEST_DTOA(9007199254740992.0, "9007199254740992.0"); // 2^53
+    TEST_DTOA(123456789012345680.0, "123456789012345680.0");
+    TEST_DTOA(1e23, "1e23");
+    TEST_DTOA(0.3, "0.3");
+    TEST_DTOA(2.98023223876953125e-8, "2.9802322387695312e-8"); // 2^-25, halfway between digits rounds to even
+
+    // Grisu2 gives a longer or farther result for these
+    TEST_DTOA(4.1752050594835e78, "4.1752050594835e78");
+    TEST_DTOA(3.484060486691407e210, "3.484060486691407e210");
+    TEST_DTOA(2.522923758208279e-228, "2.522923758208279e-228");
+
+    *ShortestDtoa(1.2345, buffer, 2) = '\0';
+    EXPECT_STREQ("1.23", buffer);
+
+#undef TEST_DTOA
+}
+
+TEST(dtoa, Ryu_RoundTrip) {
+    // The shortest digits round-trip, are never longer than those of Grisu2, and have no trailing zero
+    uint64_t x = RAPIDJSON_UINT64_C2(0x9E3779B9, 0x7F4A7C15);
+    for (int i = 0; i < 100000; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        const uint64_t u = x & RAPIDJSON_UINT64_C2(0x7FFFFFFF, 0xFFFFFFFF);
+        if ((u >> 52) == 0x7FF || u == 0)
+            continue;
+        double value;
+        std::memcpy(&value, &u, sizeof(value));
+
+        char digits[30], grisu[30];
+        int length, K, grisuLength, grisuK;
+        Ryu(value, digits, &length, &K);
+        Grisu2(value, grisu, &grisuLength, &grisuK);
+        EXPECT_LE(length, grisuLength);
+        EXPECT_NE('0', digits[length - 1]);
+
+        char buffer[40];
+        std::sprintf(buffer, "%.*se%d", length, digits, K);
+        EXPECT_EQ(value, std::strtod(buffer, 0)) << buffer;
+    }
+}
+
 #ifdef __GNUC__
 RAPIDJSON_DIAG_POP
 #endif
@@ -15,6 +15,8 @@
 #include "unittest.h"
 #include "rapidjson/filereadstream.h"
 #include "rapidjson/filewritestream.h"
+#include "rapidjson/memorymappedfilestream.h"
+#include "rapidjson/document.h"
 #include "rapidjson/encodedstream.h"
 
 using namespace rapidjson;
@@ -86,6 +88,89 @@ TEST_F(FileStreamTest, FileReadStream) {
     fclose(fp);
 }
 
+TEST_F(FileStreamTest, MemoryMappedFileStream) {
+    MemoryMappedFileStream s(filename_);
+    ASSERT_TRUE(s.IsOpen());
+    EXPECT_EQ(length_, s.GetSize());
+    EXPECT_EQ(0, memcmp(json_, s.GetString(), length_));
+    EXPECT_EQ('\0', s.GetString()[length_]);
+
+    for (size_t i = 0; i < length_; i++) {
+        EXPECT_EQ(json_[i], s.Peek());
+        EXPECT_EQ(json_[i], s.Peek());  // 2nd time should be the same
+        EXPECT_EQ(json_[i], s.Take());
+    }
+
+    EXPECT_EQ(length_, s.Tell());
+    EXPECT_EQ('\0', s.Peek());
+}
+
+TEST_F(FileStreamTest, MemoryMappedFileStream_Parse) {
+    Document expected;
+    expected.Parse(json_);
+    ASSERT_FALSE(expected.HasParseError());
+
+    MemoryMappedFileStream s(filename_);
+    Document d;
+    d.ParseStream(s);
+    ASSERT_FALSE(d.HasParseError());
+    EXPECT_TRUE(d == expected);
+    EXPECT_EQ(length_, s.Tell());
+
+    MemoryMappedFileStream s2(filename_);
+    Document d2;
+    d2.ParseStream(s2.GetStringStream());
+    ASSERT_FALSE(d2.HasParseError());
+    EXPECT_TRUE(d2 == expected);
+    EXPECT_EQ(length_, s2.Tell());
+
+    MemoryMappedFileStream s3(filename_);
+    Document d3;
+    d3.ParseStream<kParseStructuralIndexFlag>(s3.GetStringStream());
+    ASSERT_FALSE(d3.HasParseError());
+    EXPECT_TRUE(d3 == expected);
+    // Strings reference the mapped file through GetStringStream() only
+    MemoryMappedFileStream s4(filename_);
+    Document d4;
+    d4.ParseStream<kParseReferenceSourceFlag>(s4.GetStringStream());
+    ASSERT_FALSE(d4.HasParseError());
+    EXPECT_TRUE(d4 == expected);
+    const char* name = d4.MemberBegin()->name.GetString();
+    EXPECT_TRUE(name >= s4.GetString() && name < s4.GetString() + s4.GetSize());
+
+    MemoryMappedFileStream s5(filename_);
+    Document d5;
+    d5.ParseStream<kParseReferenceSourceFlag>(s5);
+    ASSERT_FALSE(d5.HasParseError());
+    name = d5.MemberBegin()->name.GetString();
+    EXPECT_FALSE(name >= s5.GetString() && name < s5.GetString() + s5.GetSize());
+}
+
+TEST_F(FileStreamTest, MemoryMappedFileStream_Empty) {
+    char filename[L_tmpnam];
+    FILE* fp = TempFile(filename);
+    fclose(fp);
+
+    {
+        MemoryMappedFileStream s(filename);
+        ASSERT_TRUE(s.IsOpen());
+        EXPECT_EQ(0u, s.GetSize());
+        EXPECT_EQ('\0', s.Peek());
+
+        Document d;
+        d.ParseStream(s);
+        EXPECT_EQ(kParseErrorDocumentEmpty, d.GetParseError());
+    }
+    remove(filename);
+}
+
+TEST_F(FileStreamTest, MemoryMappedFileStream_NotExist) {
+    MemoryMappedFileStream s("data/notexist.json");
+    EXPECT_FALSE(s.IsOpen());
+    EXPECT_EQ(0u, s.GetSize());
+    EXPECT_EQ('\0', s.Peek());
+}
+
 TEST_F(FileStreamTest, FileWriteStream) {
     char filename[L_tmpnam];
     FILE* fp = TempFile(filename);
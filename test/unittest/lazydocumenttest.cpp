@@ -0,0 +1,261 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "unittest.h"
+
+#include "rapidjson/lazydocument.h"
+#include <string>
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+using namespace rapidjson;
+
+namespace {
+
+// Expands every object and array of a lazy value, and compares the result with Document
+template <typename LazyValueType>
+void ExpectEqual(const Value& expected, const LazyValueType& v) {
+    ASSERT_EQ(expected.GetType(), v.GetType());
+    switch (v.GetType()) {
+    case kObjectType:
+        ASSERT_EQ(expected.MemberCount(), v.MemberCount());
+        for (typename LazyValueType::ConstMemberIterator m = v.MemberBegin(); m != v.MemberEnd(); ++m) {
+            Value::ConstMemberIterator e = expected.MemberBegin() + (m - v.MemberBegin());
+            EXPECT_TRUE(e->name == m->name);
+            ExpectEqual(e->value, m->value);
+        }
+        break;
+    case kArrayType:
+        ASSERT_EQ(expected.Size(), v.Size());
+        for (SizeType i = 0; i < v.Size(); i++)
+            ExpectEqual(expected[i], v[i]);
+        break;
+    case kStringType:
+        EXPECT_EQ(expected.GetStringLength(), v.GetStringLength());
+        EXPECT_EQ(0, memcmp(expected.GetString(), v.GetString(), v.GetStringLength()));
+        break;
+    case kNumberType:
+        EXPECT_EQ(expected.IsInt(), v.IsInt());
+        EXPECT_EQ(expected.IsUint64(), v.IsUint64());
+        EXPECT_EQ(expected.IsDouble(), v.IsDouble());
+        EXPECT_EQ(expected.GetDouble(), v.GetDouble());
+        break;
+    default:
+        break;
+    }
+}
+
+} // namespace
+
+TEST(LazyDocument, SkipContainer) {
+    const char* json[] = {
+        "{}", "[]", "{\"a\":[1,2,{\"b\":\"]}\"}]}", "[\"\\\"]\", \"\\\\\"]", "[[[[]]],[]]  x", "{\"}\":\"{\"}"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        const char* end = internal::SkipContainer(json[i]);
+        ASSERT_TRUE(end != 0) << json[i];
+        EXPECT_TRUE(*end == '\0' || *end == ' ') << json[i];
+    }
+
+    EXPECT_TRUE(internal::SkipContainer("[1, 2") == 0);
+    EXPECT_TRUE(internal::SkipContainer("[\"]\"") == 0);
+    EXPECT_TRUE(internal::SkipContainer("{\"a\":\"}") == 0);
+
+    // Across 64-byte blocks, with each alignment of the beginning
+    std::string s = "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx";
+    for (size_t length = 0; length < 200; length++) {
+        s += "[\"";
+        s.append(length, 'a');
+        s += "\\\\\", [\"";
+        s.append(length % 67, ']');
+        s += "\\\"\"]]";
+    }
+    for (size_t offset = 0; offset < 64; offset++) {
+        std::string t = s.substr(offset);
+        for (size_t i = 0; i < t.size(); i = t.find('[', i + 1)) {
+            if (t[i] != '[' || t[i - 1] != 'x')
+                continue;
+            const char* end = internal::SkipContainer(t.c_str() + i);
+            ASSERT_TRUE(end != 0);
+            EXPECT_EQ(']', end[-1]);
+        }
+        EXPECT_TRUE(internal::SkipContainer(t.c_str() + t.find('[')) != 0);
+    }
+}
+
+TEST(LazyDocument, Parse) {
+    const char json[] = " { \"hello\" : \"world\", \"t\" : true , \"f\" : false, \"n\": null, \"i\":123, \"u\":4294967295,"
+        " \"i64\":-1234567890123, \"pi\": 3.1416, \"a\":[1, [2, {}], {\"b\\n\":[]}], \"o\":{\"x\":{\"y\":\"z\\u0041\"}} } ";
+    Document expected;
+    expected.Parse(json);
+    ASSERT_FALSE(expected.HasParseError());
+
+    LazyDocument doc;
+    doc.Parse(json);
+    ASSERT_FALSE(doc.HasParseError());
+    EXPECT_TRUE(doc.IsObject());
+    EXPECT_FALSE(doc.IsExpanded());
+
+    EXPECT_STREQ("world", doc["hello"].GetString());
+    EXPECT_TRUE(doc.IsExpanded());
+    EXPECT_EQ(10u, doc.MemberCount());
+    EXPECT_TRUE(doc["t"].GetBool());
+    EXPECT_TRUE(doc["f"].IsFalse());
+    EXPECT_TRUE(doc["n"].IsNull());
+    EXPECT_EQ(123, doc["i"].GetInt());
+    EXPECT_EQ(4294967295u, doc["u"].GetUint());
+    EXPECT_EQ(-1234567890123, doc["i64"].GetInt64());
+    EXPECT_EQ(3.1416, doc["pi"].GetDouble());
+    EXPECT_FALSE(doc.HasMember("x"));
+    EXPECT_TRUE(doc.FindMember("x") == doc.MemberEnd());
+
+    // Nested containers are expanded on access only
+    const LazyValue& a = doc["a"];
+    const LazyValue& o = doc["o"];
+    EXPECT_TRUE(a.IsArray());
+    EXPECT_FALSE(a.IsExpanded());
+    EXPECT_FALSE(o.IsExpanded());
+    EXPECT_EQ(3u, a.Size());
+    EXPECT_TRUE(a.IsExpanded());
+    EXPECT_FALSE(a[1].IsExpanded());
+    EXPECT_TRUE(a[1][1].ObjectEmpty());
+    EXPECT_TRUE(a[2]["b\n"].Empty());
+    EXPECT_FALSE(o.IsExpanded());
+    EXPECT_STREQ("zA", o["x"]["y"].GetString());
+
+    ExpectEqual(expected, doc);
+    EXPECT_FALSE(doc.HasParseError());
+
+    // Materialize
+    Value v;
+    EXPECT_FALSE(o.Materialize(v, doc.GetAllocator()).IsError());
+    EXPECT_TRUE(v == expected["o"]);
+    EXPECT_FALSE(doc["hello"].Materialize(v, doc.GetAllocator()).IsError());
+    EXPECT_STREQ("world", v.GetString());
+    EXPECT_FALSE(doc.Materialize(v, doc.GetAllocator()).IsError());
+    EXPECT_TRUE(v == expected);
+}
+
+TEST(LazyDocument, Scalar) {
+    LazyDocument doc;
+    EXPECT_FALSE(doc.Parse(" 1.5 ").HasParseError());
+    EXPECT_EQ(1.5, doc.GetDouble());
+    EXPECT_FALSE(doc.Parse("\"a\\tb\"").HasParseError());
+    EXPECT_STREQ("a\tb", doc.GetString());
+    EXPECT_FALSE(doc.Parse("null").HasParseError());
+    EXPECT_TRUE(doc.IsNull());
+}
+
+TEST(LazyDocument, ParseError) {
+#define TEST_ERROR(errorCode, json, errorOffset) \
+    { \
+        LazyDocument doc; \
+        doc.Parse(json); \
+        EXPECT_EQ(errorCode, doc.GetParseError()) << json; \
+        EXPECT_EQ(errorOffset, doc.GetErrorOffset()) << json; \
+        EXPECT_TRUE(doc.IsNull()); \
+    }
+
+    TEST_ERROR(kParseErrorDocumentEmpty, "", 0u);
+    TEST_ERROR(kParseErrorDocumentEmpty, "  ", 2u);
+    TEST_ERROR(kParseErrorDocumentRootNotSingular, "{} []", 3u);
+    TEST_ERROR(kParseErrorDocumentRootNotSingular, "1 2", 2u);
+    TEST_ERROR(kParseErrorObjectMissCommaOrCurlyBracket, "{\"a\": [1]", 9u);
+    TEST_ERROR(kParseErrorArrayMissCommaOrSquareBracket, "[\"]\"", 4u);
+    TEST_ERROR(kParseErrorValueInvalid, "nul", 3u);
+    TEST_ERROR(kParseErrorStringMissQuotationMark, "\"abc", 4u);
+#undef TEST_ERROR
+}
+
+TEST(LazyDocument, ExpandError) {
+#define TEST_ERROR(errorCode, json, errorOffset) \
+    { \
+        LazyDocument doc; \
+        doc.Parse(json); \
+        EXPECT_FALSE(doc.HasParseError()) << json; \
+        EXPECT_EQ(0u, doc.IsObject() ? doc.MemberCount() : doc.Size()) << json; \
+        EXPECT_EQ(errorCode, doc.GetParseError()) << json; \
+        EXPECT_EQ(errorOffset, doc.GetErrorOffset()) << json; \
+    }
+
+    TEST_ERROR(kParseErrorObjectMissName, "{1:2}", 1u);
+    TEST_ERROR(kParseErrorObjectMissName, "{\"a\":1,}", 7u);
+    TEST_ERROR(kParseErrorObjectMissColon, "{\"a\" 1}", 5u);
+    TEST_ERROR(kParseErrorObjectMissCommaOrCurlyBracket, "{\"a\":1 \"b\":2}", 7u);
+    TEST_ERROR(kParseErrorObjectMissCommaOrCurlyBracket, "{\"a\":[1}]", 8u);
+    TEST_ERROR(kParseErrorArrayMissCommaOrSquareBracket, "[1 2]", 3u);
+    TEST_ERROR(kParseErrorArrayMissCommaOrSquareBracket, "[1}", 2u);
+    TEST_ERROR(kParseErrorValueInvalid, "[1,tru]", 6u);
+    TEST_ERROR(kParseErrorValueInvalid, "[1,]", 3u);
+    TEST_ERROR(kParseErrorStringEscapeInvalid, "[\"\\x\"]", 2u);
+#undef TEST_ERROR
+
+    // Only the first error is kept, and other values are still accessible
+    LazyDocument doc;
+    doc.Parse("{\"a\":[1 2],\"b\":{3},\"c\":4}");
+    ASSERT_FALSE(doc.HasParseError());
+    EXPECT_EQ(4, doc["c"].GetInt());
+    EXPECT_TRUE(doc["b"].ObjectEmpty());
+    EXPECT_TRUE(doc["a"].Empty());
+    EXPECT_EQ(kParseErrorObjectMissName, doc.GetParseError());
+    EXPECT_EQ(16u, doc.GetErrorOffset());
+
+    // Materialize validates the whole value
+    Value v;
+    ParseResult r = doc.Materialize(v, doc.GetAllocator());
+    EXPECT_EQ(kParseErrorArrayMissCommaOrSquareBracket, r.Code());
+    EXPECT_EQ(8u, r.Offset());
+}
+
+TEST(LazyDocument, CrtAllocator) {
+    const char json[] = "{\"a\":[\"long string which is not a short string\", {\"b\":[1,2,3]}], \"c\":\"d\"}";
+    GenericLazyDocument<UTF8<>, CrtAllocator> doc;
+    doc.Parse(json);
+    EXPECT_EQ(3u, doc["a"][1]["b"].Size());
+    EXPECT_STREQ("long string which is not a short string", doc["a"][0u].GetString());
+    doc.Parse("[{\"x\":[]}]");
+    EXPECT_TRUE(doc[0u]["x"].Empty());
+}
+
+TEST(LazyDocument, LargeText) {
+    std::string json = "{";
+    for (int i = 0; i < 1000; i++) {
+        char key[32];
+        sprintf(key, "\"k%d\":", i);
+        json += key;
+        json += "{\"s\":\"a\\\"]}\\\\\",\"v\":[1,[2,[3,{\"w\":\"x\"}]]],\"n\":";
+        sprintf(key, "%d},", i);
+        json += key;
+    }
+    json += "\"last\":true}";
+
+    Document expected;
+    expected.Parse(json.c_str());
+    ASSERT_FALSE(expected.HasParseError());
+
+    LazyDocument doc;
+    doc.Parse(json.c_str());
+    ASSERT_FALSE(doc.HasParseError());
+    EXPECT_EQ(500, doc["k500"]["n"].GetInt());
+    EXPECT_FALSE(doc["k499"].IsExpanded());
+    ExpectEqual(expected, doc);
+    EXPECT_FALSE(doc.HasParseError());
+}
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
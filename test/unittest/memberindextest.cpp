@@ -0,0 +1,174 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Tests the hash index of object members (RAPIDJSON_MEMBER_HASH_INDEX), which
+// must find the same members as the linear search.
+
+#include "unittest.h"
+
+#define RAPIDJSON_MEMBER_HASH_INDEX 1
+#define RAPIDJSON_NAMESPACE rapidjson_memberindex
+
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include <cstdio>
+#include <string>
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+using namespace rapidjson_memberindex;
+
+namespace {
+
+std::string Key(unsigned i) {
+    char buffer[16];
+    sprintf(buffer, "key%u", i);
+    return buffer;
+}
+
+template <typename ValueType>
+typename ValueType::ConstMemberIterator LinearFind(const ValueType& object, const std::string& name) {
+    typename ValueType::ConstMemberIterator m = object.MemberBegin();
+    for (; m != object.MemberEnd(); ++m)
+        if (name == std::string(m->name.GetString(), m->name.GetStringLength()))
+            break;
+    return m;
+}
+
+template <typename ValueType>
+void CheckFind(const ValueType& object, unsigned keyCount) {
+    for (unsigned i = 0; i < keyCount; i++) {
+        const std::string name = Key(i);
+        typename ValueType::ValueType n(StringRef(name.c_str(), static_cast<SizeType>(name.size())));
+        EXPECT_TRUE(LinearFind(object, name) == object.FindMember(n)) << name;
+    }
+}
+
+template <typename Allocator>
+void TestAddRemoveErase() {
+    typedef GenericValue<UTF8<>, Allocator> ValueType;
+    Allocator allocator;
+    ValueType o(kObjectType);
+    const unsigned n = 200;
+
+    for (unsigned i = 0; i < n; i++) {
+        const std::string name = Key(i);
+        ValueType k(name.c_str(), static_cast<SizeType>(name.size()), allocator);
+        ValueType v(i);
+        EXPECT_FALSE(o.HasMember(k));
+        o.AddMember(k, v, allocator);
+        if (i % 17 == 0)
+            CheckFind(o, n);
+    }
+    CheckFind(o, n + 10);
+    for (unsigned i = 0; i < n; i++)
+        EXPECT_EQ(i, o[Key(i).c_str()].GetUint());
+
+    // Duplicated names are found in order
+    ValueType k("key5", allocator);
+    ValueType v(1000);
+    o.AddMember(k, v, allocator);
+    EXPECT_EQ(5u, o["key5"].GetUint());
+    EXPECT_TRUE(o.RemoveMember("key5"));
+    EXPECT_EQ(1000u, o["key5"].GetUint());
+    CheckFind(o, n);
+
+    // Moves the last member
+    for (unsigned i = 0; i < n; i += 3)
+        EXPECT_TRUE(o.RemoveMember(Key(i).c_str()));
+    EXPECT_FALSE(o.RemoveMember("key0"));
+    CheckFind(o, n);
+
+    // Keeps the order
+    for (unsigned i = 1; i < n; i += 7)
+        o.EraseMember(Key(i).c_str());
+    o.EraseMember(o.MemberBegin() + 3, o.MemberBegin() + 20);
+    CheckFind(o, n);
+    o.EraseMember(o.MemberBegin(), o.MemberBegin() + (o.MemberCount() - 40));
+    CheckFind(o, n);   // below the threshold
+    o.EraseMember(o.MemberBegin(), o.MemberEnd());
+    EXPECT_TRUE(o.ObjectEmpty());
+    CheckFind(o, n);
+
+    for (unsigned i = 0; i < n; i++) {
+        const std::string name = Key(n - i);
+        ValueType nk(name.c_str(), static_cast<SizeType>(name.size()), allocator);
+        ValueType nv(i);
+        o.AddMember(nk, nv, allocator);
+    }
+    CheckFind(o, n + 1);
+    o.RemoveAllMembers();
+    CheckFind(o, n + 1);
+    EXPECT_FALSE(o.HasMember("key1"));
+}
+
+} // namespace
+
+TEST(MemberIndex, AddRemoveErase_CrtAllocator) {
+    TestAddRemoveErase<CrtAllocator>();
+}
+
+TEST(MemberIndex, AddRemoveErase_MemoryPoolAllocator) {
+    TestAddRemoveErase<MemoryPoolAllocator<> >();
+}
+
+TEST(MemberIndex, Document) {
+    std::string json = "{";
+    for (unsigned i = 0; i < 100; i++)
+        json += (i ? ",\"" : "\"") + Key(i) + "\":{\"a\":1,\"" + Key(i) + "\":[]}";
+    json += "}";
+
+    Document d;
+    d.Parse(json.c_str());
+    ASSERT_FALSE(d.HasParseError());
+    EXPECT_EQ(100u, d.MemberCapacity());
+    CheckFind(d, 110);
+    EXPECT_TRUE(d["key42"]["key42"].IsArray());
+
+    Document copy;
+    copy.CopyFrom(d, copy.GetAllocator());
+    CheckFind(copy, 110);
+    EXPECT_TRUE(copy == d);
+
+    Value v(kObjectType);
+    v.Swap(copy);
+    EXPECT_TRUE(copy.IsObject() && copy.ObjectEmpty());
+    CheckFind(v, 110);
+    EXPECT_TRUE(v == d);
+
+    v.RemoveMember("key7");
+    EXPECT_FALSE(v == d);
+
+    // Reserved capacity above the threshold before any member
+    Value r(kObjectType);
+    r.MemberReserve(64, d.GetAllocator());
+    for (unsigned i = 0; i < 100; i++) {
+        Value k(Key(i).c_str(), d.GetAllocator());
+        r.AddMember(k, i, d.GetAllocator());
+    }
+    CheckFind(r, 110);
+
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    d.Accept(writer);
+    EXPECT_EQ(json, sb.GetString());
+}
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
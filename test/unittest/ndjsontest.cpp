@@ -0,0 +1,154 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "unittest.h"
+
+#include "rapidjson/ndjson.h"
+
+#if RAPIDJSON_HAS_CXX11_THREADS
+
+#include <cstdio>
+#include <string>
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+using namespace rapidjson;
+
+namespace {
+
+// Sums the integers of a record
+struct SumHandler : BaseReaderHandler<UTF8<>, SumHandler> {
+    SumHandler() : sum(), count() {}
+    bool Default() { count++; return true; }
+    bool Int(int i) { sum += i; return Default(); }
+    bool Uint(unsigned u) { sum += static_cast<int>(u); return Default(); }
+
+    int sum;
+    unsigned count;
+};
+
+} // namespace
+
+TEST(NDJSON, Documents) {
+    const char json[] =
+        "{\"a\":1,\"b\":[true,null]}\n"
+        "\n"
+        "[1,2,3]\r\n"
+        "  \t \r\n"
+        "\"string\"\n"
+        "{\"a\":1\n"                // incomplete, must not continue on the next line
+        "123\n"
+        "[1] [2]\n"
+        "  {\"c\":\"\\n\"}  ";      // no newline at the end
+
+    for (unsigned threadCount = 1; threadCount <= 4; threadCount++) {
+        NDJSONReader reader(threadCount);
+        std::vector<Document> documents;
+        EXPECT_FALSE(reader.Parse<kParseDefaultFlags>(json, sizeof(json) - 1, documents));
+        EXPECT_EQ(2u, reader.GetErrorCount());
+        EXPECT_EQ(threadCount, reader.GetThreadCount());
+
+        const std::vector<NDJSONRecord>& records = reader.GetRecords();
+        ASSERT_EQ(7u, records.size());
+        ASSERT_EQ(7u, documents.size());
+
+        EXPECT_EQ(0u, records[0].offset);
+        EXPECT_EQ(23u, records[0].length);
+        Document expected;
+        EXPECT_TRUE(documents[0] == expected.Parse("{\"a\":1,\"b\":[true,null]}"));
+        EXPECT_EQ(25u, records[1].offset);
+        EXPECT_TRUE(documents[1] == expected.Parse("[1,2,3]"));
+        EXPECT_STREQ("string", documents[2].GetString());
+
+        EXPECT_TRUE(documents[3].HasParseError());
+        EXPECT_EQ(kParseErrorObjectMissCommaOrCurlyBracket, records[3].result.Code());
+        EXPECT_EQ(kParseErrorObjectMissCommaOrCurlyBracket, documents[3].GetParseError());
+        EXPECT_EQ(6u, records[3].result.Offset());
+
+        EXPECT_EQ(123, documents[4].GetInt());
+        EXPECT_TRUE(documents[5].HasParseError());
+        EXPECT_EQ(kParseErrorDocumentRootNotSingular, records[5].result.Code());
+        EXPECT_STREQ("\n", documents[6]["c"].GetString());
+        EXPECT_FALSE(records[6].result.IsError());
+    }
+
+    std::vector<Document> documents;
+    EXPECT_TRUE(ParseNDJSON<kParseDefaultFlags>("", 0, documents));
+    EXPECT_TRUE(documents.empty());
+    EXPECT_TRUE(ParseNDJSON<kParseStructuralIndexFlag>("[1]\n[2]\n", 8, documents, 2));
+    ASSERT_EQ(2u, documents.size());
+    EXPECT_EQ(2, documents[1][0].GetInt());
+}
+
+TEST(NDJSON, Order) {
+    // Records of different lengths, with an error every 1000 records
+    const unsigned count = 5000;
+    std::string json;
+    std::vector<size_t> offsets;
+    for (unsigned i = 0; i < count; i++) {
+        offsets.push_back(json.size());
+        if (i % 1000 == 999) {
+            json += "[1,\n";
+            continue;
+        }
+        json += '[';
+        for (unsigned j = 0; j < i % 17; j++)
+            json += "1,";
+        char buffer[16];
+        sprintf(buffer, "%u]\n", i);
+        json += buffer;
+    }
+
+    NDJSONReader reader(8);
+    std::vector<SumHandler> handlers;
+    EXPECT_FALSE(reader.Parse<kParseDefaultFlags>(json.c_str(), json.size(), handlers));
+    ASSERT_EQ(count, handlers.size());
+    EXPECT_EQ(count / 1000, reader.GetErrorCount());
+    for (unsigned i = 0; i < count; i++) {
+        const NDJSONRecord& r = reader.GetRecords()[i];
+        EXPECT_EQ(offsets[i], r.offset);
+        if (i % 1000 == 999) {
+            EXPECT_TRUE(r.result.IsError());
+        }
+        else {
+            EXPECT_EQ(static_cast<int>(i + i % 17), handlers[i].sum);
+            EXPECT_EQ(i % 17 + 3, handlers[i].count);   // with StartArray and EndArray
+        }
+    }
+}
+
+TEST(NDJSON, Handlers) {
+    const char json[] = "[1,2,3]\n{\"a\":[4,5]}\n[1,\n\n7";
+
+    NDJSONReader reader(2);
+    std::vector<SumHandler> handlers;
+    EXPECT_FALSE(reader.Parse<kParseDefaultFlags>(json, sizeof(json) - 1, handlers));
+    ASSERT_EQ(4u, handlers.size());
+    EXPECT_EQ(6, handlers[0].sum);
+    EXPECT_EQ(9, handlers[1].sum);
+    EXPECT_EQ(7u, handlers[1].count);   // including the events of the object and the array
+    EXPECT_TRUE(reader.GetRecords()[2].result.IsError());
+    EXPECT_EQ(kParseErrorValueInvalid, reader.GetRecords()[2].result.Code());
+    EXPECT_EQ(7, handlers[3].sum);
+    EXPECT_EQ(1u, reader.GetErrorCount());
+}
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_HAS_CXX11_THREADS
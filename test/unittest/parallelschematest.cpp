@@ -0,0 +1,217 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "unittest.h"
+
+#include "rapidjson/parallelschema.h"
+#include "rapidjson/ndjson.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#if RAPIDJSON_HAS_CXX11_THREADS
+
+#include <cstdio>
+#include <string>
+
+using namespace rapidjson;
+
+namespace {
+
+template <typename ValueType>
+std::string Stringify(const ValueType& v) {
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    v.Accept(writer);
+    return sb.GetString();
+}
+
+const char kRecordSchema[] =
+    "{"
+    "  \"type\": \"object\","
+    "  \"properties\": {"
+    "    \"id\": { \"type\": \"integer\", \"minimum\": 0 },"
+    "    \"tags\": { \"type\": \"array\", \"items\": { \"type\": \"string\" } }"
+    "  },"
+    "  \"required\": [\"id\"]"
+    "}";
+
+// Records where every 7th has a negative id, and every 11th a tag which is not a string.
+Document MakeRecords(unsigned count) {
+    Document d(kArrayType);
+    for (unsigned i = 0; i < count; i++) {
+        Value record(kObjectType);
+        record.AddMember("id", i % 7 == 3 ? -1 : static_cast<int>(i), d.GetAllocator());
+        Value tags(kArrayType);
+        tags.PushBack("a", d.GetAllocator());
+        if (i % 11 == 5)
+            tags.PushBack(i, d.GetAllocator());
+        record.AddMember("tags", tags, d.GetAllocator());
+        d.PushBack(record, d.GetAllocator());
+    }
+    return d;
+}
+
+} // namespace
+
+TEST(ParallelSchemaValidator, Errors) {
+    Document sd;
+    sd.Parse(kRecordSchema);
+    SchemaDocument schema(sd);
+
+    Document d;
+    d.Parse("[{\"id\":1}, {\"id\":-2}, {}, {\"id\":3,\"tags\":[\"x\",4]}, {\"id\":-5}]");
+    ParallelSchemaValidator validator(schema, 2);
+    EXPECT_FALSE(validator.Validate(d));
+    EXPECT_FALSE(validator.IsValid());
+    EXPECT_EQ(2u, validator.GetThreadCount());
+    ASSERT_EQ(4u, validator.GetInvalidCount());
+    EXPECT_EQ(1u, validator.GetInvalidIndex(0));
+    EXPECT_EQ(2u, validator.GetInvalidIndex(1));
+    EXPECT_EQ(3u, validator.GetInvalidIndex(2));
+    EXPECT_EQ(4u, validator.GetInvalidIndex(3));
+    EXPECT_EQ(
+        "{\"required\":{\"missing\":[\"id\"],\"instanceRef\":\"#/2\",\"schemaRef\":\"#\"}}",
+        Stringify(validator.GetInvalidError(1)));
+    EXPECT_EQ(
+        "{\"minimum\":["
+            "{\"actual\":-2,\"expected\":0,\"instanceRef\":\"#/1/id\",\"schemaRef\":\"#/properties/id\"},"
+            "{\"actual\":-5,\"expected\":0,\"instanceRef\":\"#/4/id\",\"schemaRef\":\"#/properties/id\"}],"
+        "\"required\":{\"missing\":[\"id\"],\"instanceRef\":\"#/2\",\"schemaRef\":\"#\"},"
+        "\"type\":{\"expected\":[\"string\"],\"actual\":\"integer\",\"instanceRef\":\"#/3/tags/1\",\"schemaRef\":\"#/properties/tags/items\"}}",
+        Stringify(validator.GetError()));
+
+    // The validator is reused
+    d.Parse("[{\"id\":1}, {\"id\":2}]");
+    EXPECT_TRUE(validator.Validate(d));
+    EXPECT_EQ(0u, validator.GetInvalidCount());
+    EXPECT_EQ("{}", Stringify(validator.GetError()));
+
+    d.SetArray();
+    EXPECT_TRUE(validator.Validate(d));
+}
+
+TEST(ParallelSchemaValidator, Order) {
+    Document sd;
+    sd.Parse(kRecordSchema);
+    SchemaDocument schema(sd);
+
+    const unsigned count = 5000;
+    Document d = MakeRecords(count);
+
+    std::string expected;
+    for (unsigned threadCount = 1; threadCount <= 8; threadCount *= 2) {
+        ParallelSchemaValidator validator(schema, threadCount);
+        EXPECT_FALSE(validator.Validate(d));
+
+        size_t k = 0;
+        for (unsigned i = 0; i < count; i++) {
+            if (i % 7 != 3 && i % 11 != 5)
+                continue;
+            ASSERT_LT(k, validator.GetInvalidCount());
+            EXPECT_EQ(i, validator.GetInvalidIndex(k));
+            const ParallelSchemaValidator::ValueType& error = validator.GetInvalidError(k);
+            char instanceRef[32];
+            if (i % 7 == 3) {
+                sprintf(instanceRef, "#/%u/id", i);
+                EXPECT_STREQ(instanceRef, error["minimum"]["instanceRef"].GetString());
+            }
+            else {  // the validation stops at the first error
+                sprintf(instanceRef, "#/%u/tags/1", i);
+                EXPECT_STREQ(instanceRef, error["type"]["instanceRef"].GetString());
+            }
+            k++;
+        }
+        EXPECT_EQ(k, validator.GetInvalidCount());
+
+        const std::string error = Stringify(validator.GetError());
+        if (threadCount == 1)
+            expected = error;
+        else
+            EXPECT_EQ(expected, error);
+    }
+}
+
+TEST(ParallelSchemaValidator, MemoryPoolAllocator) {
+    Document sd;
+    sd.Parse(kRecordSchema);
+    SchemaDocument schema(sd);
+    Document d = MakeRecords(2000);
+    Document valid;
+    valid.Parse("[{\"id\":1}]");
+
+    // The pools are cleared between validations, which must not refer to the previous states
+    typedef GenericParallelSchemaValidator<SchemaDocument, MemoryPoolAllocator<> > PoolValidator;
+    PoolValidator validator(schema, 4);
+    EXPECT_FALSE(validator.Validate(d));
+    const std::string expected = Stringify(validator.GetError());
+    const size_t invalidCount = validator.GetInvalidCount();
+    for (int i = 0; i < 3; i++) {
+        EXPECT_TRUE(validator.Validate(valid));
+        EXPECT_EQ("{}", Stringify(validator.GetError()));
+        EXPECT_FALSE(validator.Validate(d));
+        EXPECT_EQ(invalidCount, validator.GetInvalidCount());
+        EXPECT_EQ(expected, Stringify(validator.GetError()));
+    }
+}
+
+TEST(ParallelSchemaValidator, NDJSON) {
+    Document sd;
+    sd.Parse(kRecordSchema);
+    SchemaDocument schema(sd);
+
+    const char json[] =
+        "{\"id\":1}\n"
+        "{\"id\":\"2\"}\n"
+        "{\"id\":3,\"tags\":[]}\n"
+        "{\"id\":\n"                // a parse error, validated as null
+        "{\"id\":5,\"tags\":[\"a\",\"b\"]}\n";
+    std::vector<Document> documents;
+    EXPECT_FALSE(ParseNDJSON<kParseDefaultFlags>(json, sizeof(json) - 1, documents));
+    ASSERT_EQ(5u, documents.size());
+
+    ParallelSchemaValidator validator(schema, 4);
+    EXPECT_FALSE(validator.Validate(documents));
+    ASSERT_EQ(2u, validator.GetInvalidCount());
+    EXPECT_EQ(1u, validator.GetInvalidIndex(0));
+    EXPECT_STREQ("#/1/id", validator.GetInvalidError(0)["type"]["instanceRef"].GetString());
+    EXPECT_EQ(3u, validator.GetInvalidIndex(1));
+    EXPECT_STREQ("#/3", validator.GetInvalidError(1)["type"]["instanceRef"].GetString());
+
+    documents.clear();
+    EXPECT_TRUE(validator.Validate(documents));
+}
+
+TEST(SchemaValidator, ResetAsElement) {
+    Document sd;
+    sd.Parse(kRecordSchema);
+    SchemaDocument schema(sd);
+    SchemaValidator validator(schema);
+
+    Document d;
+    d.Parse("{\"tags\":[1]}");
+    validator.ResetAsElement(42);
+    EXPECT_FALSE(d.Accept(validator));
+    EXPECT_STREQ("#/42/tags/0", validator.GetError()["type"]["instanceRef"].GetString());
+    StringBuffer sb;
+    validator.GetInvalidDocumentPointer().StringifyUriFragment(sb);
+    EXPECT_STREQ("#/42/tags/0", sb.GetString());
+
+    // Reset() keeps the index
+    validator.Reset();
+    d.Parse("{}");
+    EXPECT_FALSE(d.Accept(validator));
+    EXPECT_STREQ("#/42", validator.GetError()["required"]["instanceRef"].GetString());
+}
+
+#endif // RAPIDJSON_HAS_CXX11_THREADS
@@ -0,0 +1,180 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "unittest.h"
+
+#include "rapidjson/parallelwriter.h"
+
+#if RAPIDJSON_HAS_CXX11_THREADS
+
+#include <limits>
+#include <string>
+
+using namespace rapidjson;
+
+namespace {
+
+// Output of Writer, which ParallelWriter must reproduce.
+template <typename ValueType>
+std::string SerialStringify(const ValueType& v, int maxDecimalPlaces = Writer<StringBuffer>::kDefaultMaxDecimalPlaces) {
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    writer.SetMaxDecimalPlaces(maxDecimalPlaces);
+    v.Accept(writer);
+    return sb.GetString();
+}
+
+template <typename ValueType>
+std::string ParallelStringify(ParallelWriter& writer, const ValueType& v) {
+    StringBuffer sb;
+    EXPECT_TRUE(writer.Write(v, sb));
+    return std::string(sb.GetString(), sb.GetSize());
+}
+
+// Output stream without the StringBuffer overloads.
+struct StdStringStream {
+    typedef char Ch;
+    StdStringStream() : s() {}
+    void Put(char c) { s += c; }
+    void Flush() {}
+    std::string s;
+};
+
+// Records with nested arrays and objects, escaped strings and numbers of every kind,
+// and a large member holding a deeper tree.
+Document MakeDocument(unsigned count) {
+    Document d(kObjectType);
+    Document::AllocatorType& a = d.GetAllocator();
+    Value records(kArrayType);
+    for (unsigned i = 0; i < count; i++) {
+        Value record(kObjectType);
+        record.AddMember("id", i, a);
+        record.AddMember("neg", -static_cast<int64_t>(i) * 1000000007, a);
+        record.AddMember("x", i * 0.125 + 1e-7, a);
+        record.AddMember("name\t", Value(i % 3 ? "a\"b\\c\n" : "", a).Move(), a);
+        Value tags(kArrayType);
+        for (unsigned j = 0; j < i % 5; j++)
+            tags.PushBack(j % 2 ? Value(true) : Value(), a);
+        record.AddMember("tags", tags, a);
+        record.AddMember("empty", Value(kObjectType), a);
+        records.PushBack(record, a);
+    }
+    d.AddMember("records", records, a);
+    d.AddMember("count", count, a);
+
+    Value tree(kArrayType);
+    for (unsigned i = 0; i < 50; i++) {
+        Value branch(kArrayType);
+        for (unsigned j = 0; j < 50 * (i % 4); j++)
+            branch.PushBack(static_cast<uint64_t>(j) << 40, a);
+        tree.PushBack(Value(kArrayType).PushBack(branch, a).PushBack(i, a), a);
+    }
+    d.AddMember("tree", tree, a);
+    d.AddMember("end", Value(kArrayType), a);
+    return d;
+}
+
+} // namespace
+
+TEST(ParallelWriter, Identical) {
+    const Document d = MakeDocument(2000);
+    const std::string expected = SerialStringify(d);
+
+    const size_t chunkSizes[] = { 1, 7, 100, 4096, ParallelWriter::kDefaultChunkSize, 1u << 30 };
+    for (unsigned threadCount = 1; threadCount <= 8; threadCount *= 2) {
+        ParallelWriter writer(threadCount);
+        EXPECT_EQ(threadCount, writer.GetThreadCount());
+        for (size_t i = 0; i < sizeof(chunkSizes) / sizeof(chunkSizes[0]); i++) {
+            writer.SetChunkSize(chunkSizes[i]);
+            EXPECT_EQ(chunkSizes[i], writer.GetChunkSize());
+            EXPECT_EQ(expected, ParallelStringify(writer, d));   // the writer is reused
+
+            StdStringStream os;
+            EXPECT_TRUE(writer.Write(d, os));
+            EXPECT_EQ(expected, os.s);
+
+            // Inner values
+            EXPECT_EQ(SerialStringify(d["records"]), ParallelStringify(writer, d["records"]));
+            EXPECT_EQ(SerialStringify(d["tree"]), ParallelStringify(writer, d["tree"]));
+        }
+    }
+}
+
+TEST(ParallelWriter, Small) {
+    ParallelWriter writer(4);
+    writer.SetChunkSize(1);
+    const char* jsons[] = { "null", "true", "-1", "1.5", "\"\"", "[]", "{}", "[[]]", "{\"\":{}}", "[1,[2,[3]],{\"a\":[4]}]" };
+    for (size_t i = 0; i < sizeof(jsons) / sizeof(jsons[0]); i++) {
+        Document d;
+        d.Parse(jsons[i]);
+        EXPECT_EQ(jsons[i], ParallelStringify(writer, d));
+    }
+}
+
+TEST(ParallelWriter, MaxDecimalPlaces) {
+    Document d(kArrayType);
+    for (int i = 0; i < 1000; i++)
+        d.PushBack(i / 7.0, d.GetAllocator());
+
+    ParallelWriter writer(4);
+    writer.SetChunkSize(64);
+    writer.SetMaxDecimalPlaces(3);
+    EXPECT_EQ(3, writer.GetMaxDecimalPlaces());
+    EXPECT_EQ(SerialStringify(d, 3), ParallelStringify(writer, d));
+}
+
+TEST(ParallelWriter, Error) {
+    Document d(kArrayType);
+    for (int i = 0; i < 1000; i++)
+        d.PushBack(i, d.GetAllocator());
+    d[500] = std::numeric_limits<double>::quiet_NaN();
+
+    ParallelWriter writer(4);
+    writer.SetChunkSize(64);
+    StringBuffer sb;
+    EXPECT_FALSE(writer.Write(d, sb));
+
+    // The writer is still usable
+    d[500] = 500;
+    EXPECT_EQ(SerialStringify(d), ParallelStringify(writer, d));
+
+    // Same flags as Writer
+    d[500] = std::numeric_limits<double>::infinity();
+    GenericParallelWriter<UTF8<>, UTF8<>, CrtAllocator, kWriteNanAndInfFlag> nanWriter(4);
+    nanWriter.SetChunkSize(64);
+    sb.Clear();
+    EXPECT_TRUE(nanWriter.Write(d, sb));
+    StringBuffer expected;
+    Writer<StringBuffer, UTF8<>, UTF8<>, CrtAllocator, kWriteNanAndInfFlag> w(expected);
+    d.Accept(w);
+    EXPECT_STREQ(expected.GetString(), sb.GetString());
+}
+
+TEST(ParallelWriter, Transcoding) {
+    const Document d = MakeDocument(100);
+    typedef GenericStringBuffer<UTF16<> > StringBuffer16;
+
+    StringBuffer16 expected;
+    Writer<StringBuffer16, UTF8<>, UTF16<> > w(expected);
+    d.Accept(w);
+
+    GenericParallelWriter<UTF8<>, UTF16<> > writer(3);
+    writer.SetChunkSize(256);
+    StringBuffer16 sb;
+    EXPECT_TRUE(writer.Write(d, sb));
+    ASSERT_EQ(expected.GetLength(), sb.GetLength());
+    EXPECT_EQ(0, memcmp(expected.GetString(), sb.GetString(), sb.GetSize()));
+}
+
+#endif // RAPIDJSON_HAS_CXX11_THREADS
@@ -0,0 +1,162 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "unittest.h"
+
+#include "rapidjson/projection.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include <string>
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+using namespace rapidjson;
+
+namespace {
+
+const char* kJson =
+    "{ \"id\": 1, \"user\": { \"name\": \"a\", \"tags\": [1, 2] }, \"items\": [3, {\"x\": [4, 5]}, \"6\"],"
+    "  \"esc\\u0061pe\": true, \"a~b/c\": null }";
+
+template <unsigned parseFlags>
+std::string Project(const char* json, const char* const* paths, SizeType count, ParseErrorCode expectedCode = kParseErrorNone) {
+    Pointer pointers[8];
+    for (SizeType i = 0; i < count; i++)
+        pointers[i] = Pointer(paths[i]);
+    ProjectionReader reader(pointers, count);
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    ParseResult r = reader.Parse<parseFlags>(json, writer);
+    EXPECT_EQ(expectedCode, r.Code());
+    return sb.GetString();
+}
+
+std::string Project(const char* json, const char* const* paths, SizeType count) {
+    return Project<kParseDefaultFlags>(json, paths, count);
+}
+
+} // namespace
+
+TEST(Projection, Members) {
+    const char* paths[] = { "/user/name", "/id" };
+    EXPECT_EQ("{\"id\":1,\"user\":{\"name\":\"a\"}}", Project(kJson, paths, 2));
+}
+
+TEST(Projection, Elements) {
+    const char* paths[] = { "/items/1/x/1", "/items/2", "/items/7" };
+    EXPECT_EQ("{\"items\":[{\"x\":[5]},\"6\"]}", Project(kJson, paths, 3));
+
+    const char* indices[] = { "/0", "/2/a" };
+    EXPECT_EQ("[1,{\"a\":3}]", Project("[1, 2, {\"a\": 3, \"b\": 4}, 5]", indices, 2));
+}
+
+TEST(Projection, Subtree) {
+    // The selected value is parsed entirely, even if a longer path also selects in it
+    const char* paths[] = { "/user/tags/0", "/user" };
+    EXPECT_EQ("{\"user\":{\"name\":\"a\",\"tags\":[1,2]}}", Project(kJson, paths, 2));
+
+    const char* root[] = { "" };
+    Document d;
+    d.Parse(kJson);
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    d.Accept(writer);
+    EXPECT_EQ(sb.GetString(), Project(kJson, root, 1));
+}
+
+TEST(Projection, EscapedNames) {
+    const char* paths[] = { "/escape", "/a~0b~1c" };
+    EXPECT_EQ("{\"escape\":true,\"a~b/c\":null}", Project(kJson, paths, 2));
+}
+
+TEST(Projection, NoMatch) {
+    // A prefix of a path on a scalar is skipped
+    const char* paths[] = { "/id/0", "/missing", "/user/name/x" };
+    EXPECT_EQ("{\"user\":{}}", Project(kJson, paths, 3));
+    EXPECT_EQ("{}", Project(kJson, paths, 0));
+    EXPECT_EQ("", Project("123", paths, 1));
+}
+
+TEST(Projection, TrailingCommas) {
+    const char* paths[] = { "/a/1" };
+    EXPECT_EQ("{\"a\":[2]}", Project<kParseTrailingCommasFlag>("{\"a\": [1, 2, ], \"b\": 3, }", paths, 1));
+}
+
+TEST(Projection, Error) {
+    const char* paths[] = { "/a/b" };
+    Project<kParseDefaultFlags>("", paths, 1, kParseErrorDocumentEmpty);
+    Project<kParseDefaultFlags>("{\"a\": {\"b\": 1}} x", paths, 1, kParseErrorDocumentRootNotSingular);
+    Project<kParseDefaultFlags>("{\"a\" {\"b\": 1}}", paths, 1, kParseErrorObjectMissColon);
+    Project<kParseDefaultFlags>("{\"a\": {\"b\": 1} \"c\": 2}", paths, 1, kParseErrorObjectMissCommaOrCurlyBracket);
+    Project<kParseDefaultFlags>("{\"a\": {\"b\": 1}, 2}", paths, 1, kParseErrorObjectMissName);
+    Project<kParseDefaultFlags>("{\"c\": [1, 2", paths, 1, kParseErrorArrayMissCommaOrSquareBracket);
+    Project<kParseDefaultFlags>("{\"a\": {\"b\": tru}}", paths, 1, kParseErrorValueInvalid);
+
+    // Offsets are in the whole text
+    Pointer pointer("/a/b");
+    ProjectionReader reader(&pointer, 1);
+    BaseReaderHandler<> handler;
+    EXPECT_TRUE(reader.Parse("{\"c\": 1, \"a\": {\"b\": [1, 2 3]}}", handler).IsError());
+    EXPECT_EQ(kParseErrorArrayMissCommaOrSquareBracket, reader.GetParseErrorCode());
+    EXPECT_EQ(26u, reader.GetErrorOffset());
+}
+
+TEST(Projection, Termination) {
+    struct TerminateAtKey : BaseReaderHandler<UTF8<>, TerminateAtKey> {
+        bool Key(const char*, SizeType, bool) { return false; }
+    };
+    Pointer pointer("/a");
+    ProjectionReader reader(&pointer, 1);
+    TerminateAtKey handler;
+    EXPECT_EQ(kParseErrorTermination, reader.Parse("{\"b\": 1, \"a\": 2}", handler).Code());
+}
+
+TEST(Projection, Document) {
+    Pointer pointers[] = { Pointer("/user/tags"), Pointer("/items/1/x/0") };
+    ProjectionReader reader(pointers, 2);
+    Document d;
+    EXPECT_FALSE(reader.Parse<kParseDefaultFlags>(kJson, d).IsError());
+    EXPECT_TRUE(d.IsObject());
+    EXPECT_EQ(2u, d["user"]["tags"].Size());
+    EXPECT_EQ(4, d["items"][0]["x"][0].GetInt());
+    EXPECT_FALSE(d.HasMember("id"));
+
+    // The document is unchanged on error
+    EXPECT_TRUE(reader.Parse<kParseDefaultFlags>("{\"user\": {\"tags\": [1,]}}", d).IsError());
+    EXPECT_EQ(2u, d["user"]["tags"].Size());
+
+    // A root scalar which is not selected projects to null
+    EXPECT_FALSE(reader.Parse<kParseDefaultFlags>("\"s\"", d).IsError());
+    EXPECT_TRUE(d.IsNull());
+}
+
+TEST(Projection, Long) {
+    std::string json = "[";
+    for (int i = 0; i < 200; i++) {
+        if (i > 0)
+            json += ", ";
+        json += "{\"skip\": [\"\\\\\\\"]}\", {\"deep\": [[[]]]}], \"keep\": " + std::string(i == 150 ? "\"yes\"" : "0") + "}";
+    }
+    json += "]";
+
+    const char* paths[] = { "/150/keep" };
+    EXPECT_EQ("[{\"keep\":\"yes\"}]", Project(json.c_str(), paths, 1));
+}
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
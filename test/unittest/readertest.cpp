@@ -18,6 +18,7 @@
 #include "rapidjson/internal/dtoa.h"
 #include "rapidjson/internal/itoa.h"
 #include "rapidjson/memorystream.h"
+#include "rapidjson/writer.h"
 
 #include <limits>
 
@@ -895,6 +896,76 @@ TEST(Reader, ParseString_NonDestructive) {
     EXPECT_EQ(11u, h.length_);
 }
 
+TEST(Reader, ParseString_ReferenceSource) {
+    // Strings without escapes refer to the source
+    {
+        const char* json = "\"Hello\"";
+        StringStream s(json);
+        ParseStringHandler<UTF8<> > h;
+        Reader reader;
+        reader.Parse<kParseReferenceSourceFlag>(s, h);
+        EXPECT_FALSE(reader.HasParseError());
+        EXPECT_FALSE(h.copy_);
+        EXPECT_EQ(json + 1, h.str_);
+        EXPECT_EQ(5u, h.length_);
+        EXPECT_EQ(7u, s.Tell());
+    }
+    {
+        const wchar_t* json = L"\"Hello\"";
+        GenericStringStream<UTF16<> > s(json);
+        ParseStringHandler<UTF16<> > h;
+        GenericReader<UTF16<>, UTF16<> > reader;
+        reader.Parse<kParseReferenceSourceFlag | kParseValidateEncodingFlag>(s, h);
+        EXPECT_FALSE(reader.HasParseError());
+        EXPECT_FALSE(h.copy_);
+        EXPECT_EQ(json + 1, h.str_);
+        EXPECT_EQ(5u, h.length_);
+    }
+
+    // Escaped, validated non-ASCII or transcoded strings are copied
+    {
+        StringStream s("\"Hello\\nWorld\"");
+        ParseStringHandler<UTF8<> > h;
+        Reader reader;
+        reader.Parse<kParseReferenceSourceFlag>(s, h);
+        EXPECT_TRUE(h.copy_);
+        EXPECT_EQ(0, StrCmp("Hello\nWorld", h.str_));
+        EXPECT_EQ(11u, h.length_);
+    }
+    {
+        StringStream s("\"\xE2\x82\xAC\"");
+        ParseStringHandler<UTF8<> > h;
+        Reader reader;
+        reader.Parse<kParseReferenceSourceFlag | kParseValidateEncodingFlag>(s, h);
+        EXPECT_TRUE(h.copy_);
+        EXPECT_EQ(0, StrCmp("\xE2\x82\xAC", h.str_));
+    }
+    {
+        StringStream s("\"Hello\"");
+        ParseStringHandler<UTF16<> > h;
+        GenericReader<UTF8<>, UTF16<> > reader;
+        reader.Parse<kParseReferenceSourceFlag>(s, h);
+        EXPECT_TRUE(h.copy_);
+        EXPECT_EQ(0, StrCmp(L"Hello", h.str_));
+    }
+
+    // Errors are the same as without the flag
+    {
+        const char* json[] = { "\"Hello", "\"Hel\tlo\"", "\"Hello\\x\"", "\"\xC3\x28\"" };
+        for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+            for (int validate = 0; validate < 2; validate++) {
+                StringStream s1(json[i]), s2(json[i]);
+                BaseReaderHandler<> h;
+                Reader reader1, reader2;
+                ParseResult r1 = validate ? reader1.Parse<kParseValidateEncodingFlag>(s1, h) : reader1.Parse(s1, h);
+                ParseResult r2 = validate ? reader2.Parse<kParseValidateEncodingFlag | kParseReferenceSourceFlag>(s2, h) : reader2.Parse<kParseReferenceSourceFlag>(s2, h);
+                EXPECT_EQ(r1.Code(), r2.Code()) << json[i];
+                EXPECT_EQ(r1.Offset(), r2.Offset()) << json[i];
+            }
+        }
+    }
+}
+
 template <typename Encoding>
 ParseErrorCode TestString(const typename Encoding::Ch* str) {
     GenericStringStream<Encoding> s(str);
@@ -1357,6 +1428,24 @@ TEST(Reader, CustomStringStream) {
     EXPECT_EQ(20u, h.step_);
 }
 
+// A stream derived from StringStream, which hides Take() to count the characters taken.
+struct CountingStringStream : StringStream {
+    CountingStringStream(const Ch* src) : StringStream(src), count(0) {}
+    Ch Take() { ++count; return StringStream::Take(); }
+    size_t count;
+};
+
+TEST(Reader, DerivedStringStream) {
+    // The derived stream is parsed as itself, not as its base StringStream
+    const char json[] = "{ \"hello\" : \"world\", \"t\" : true , \"f\" : false, \"n\": null, \"i\":123, \"pi\": 3.1416, \"a\":[1, 2, 3] } ";
+    CountingStringStream s(json);
+    ParseObjectHandler h;
+    Reader reader;
+    reader.Parse(s, h);
+    EXPECT_EQ(20u, h.step_);
+    EXPECT_EQ(sizeof(json) - 1, s.count);
+}
+
 #include <sstream>
 
 class IStreamWrapper {
@@ -2025,6 +2114,10 @@ TEST(Reader, TrailingCommasIterative) {
     TestTrailingCommas<kParseIterativeFlag>();
 }
 
+TEST(Reader, TrailingCommasStructuralIndex) {
+    TestTrailingCommas<kParseStructuralIndexFlag>();
+}
+
 template <unsigned extraFlags>
 void TestMultipleTrailingCommaErrors() {
     // only a single trailing comma is allowed.
@@ -2058,6 +2151,10 @@ TEST(Reader, MultipleTrailingCommaErrorsIterative) {
     TestMultipleTrailingCommaErrors<kParseIterativeFlag>();
 }
 
+TEST(Reader, MultipleTrailingCommaErrorsStructuralIndex) {
+    TestMultipleTrailingCommaErrors<kParseStructuralIndexFlag>();
+}
+
 template <unsigned extraFlags>
 void TestEmptyExceptForCommaErrors() {
     // not allowed even with trailing commas enabled; the
@@ -2090,6 +2187,10 @@ TEST(Reader, EmptyExceptForCommaErrorsIterative) {
     TestEmptyExceptForCommaErrors<kParseIterativeFlag>();
 }
 
+TEST(Reader, EmptyExceptForCommaErrorsStructuralIndex) {
+    TestEmptyExceptForCommaErrors<kParseStructuralIndexFlag>();
+}
+
 template <unsigned extraFlags>
 void TestTrailingCommaHandlerTermination() {
     {
@@ -2120,6 +2221,10 @@ TEST(Reader, TrailingCommaHandlerTerminationIterative) {
     TestTrailingCommaHandlerTermination<kParseIterativeFlag>();
 }
 
+TEST(Reader, TrailingCommaHandlerTerminationStructuralIndex) {
+    TestTrailingCommaHandlerTermination<kParseStructuralIndexFlag>();
+}
+
 TEST(Reader, ParseNanAndInfinity) {
 #define TEST_NAN_INF(str, x) \
     { \
@@ -2187,4 +2292,199 @@ TEST(Reader, ParseNanAndInfinity) {
 #undef TEST_NAN_INF
 }
 
+// Test parsing with the structural index, which must behave as the recursive parser.
+
+template <unsigned parseFlags>
+static void TestStructuralIndex(const char* json) {
+    for (int insitu = 0; insitu < 2; insitu++) {
+        std::vector<char> buffer1(json, json + strlen(json) + 1), buffer2(buffer1);
+        StringBuffer sb1, sb2;
+        Writer<StringBuffer> writer1(sb1), writer2(sb2);
+        Reader reader1, reader2;
+        ParseResult r1, r2;
+        size_t tell1, tell2;
+        if (insitu) {
+            InsituStringStream s1(&buffer1[0]), s2(&buffer2[0]);
+            r1 = reader1.Parse<parseFlags | kParseInsituFlag>(s1, writer1);
+            r2 = reader2.Parse<parseFlags | kParseInsituFlag | kParseStructuralIndexFlag>(s2, writer2);
+            tell1 = s1.Tell();
+            tell2 = s2.Tell();
+        }
+        else {
+            StringStream s1(&buffer1[0]), s2(&buffer2[0]);
+            r1 = reader1.Parse<parseFlags>(s1, writer1);
+            r2 = reader2.Parse<parseFlags | kParseStructuralIndexFlag>(s2, writer2);
+            tell1 = s1.Tell();
+            tell2 = s2.Tell();
+        }
+        EXPECT_EQ(r1.Code(), r2.Code()) << json;
+        EXPECT_EQ(r1.Offset(), r2.Offset()) << json;
+        EXPECT_STREQ(sb1.GetString(), sb2.GetString()) << json;
+        if (r1.IsError() || (parseFlags & kParseStopWhenDoneFlag))
+            EXPECT_EQ(tell1, tell2) << json;
+    }
+}
+
+TEST(Reader, StructuralIndex_ReferenceSource) {
+    const char* json = "{\"a\": \"b\", \"c\\n\": [\"d\", \"e\\\"\"]}";
+    StringStream s(json);
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    Reader reader;
+    EXPECT_FALSE(reader.Parse<kParseStructuralIndexFlag | kParseReferenceSourceFlag>(s, writer).IsError());
+    EXPECT_STREQ("{\"a\":\"b\",\"c\\n\":[\"d\",\"e\\\"\"]}", sb.GetString());
+}
+
+template <typename InputStream>
+static void TestSkipValue(const char* json, size_t expectedOffset) {
+    InputStream s(json);
+    Reader reader;
+    ParseResult r = reader.SkipValue<kParseCommentsFlag>(s);
+    EXPECT_FALSE(r.IsError()) << json;
+    EXPECT_EQ(expectedOffset, s.Tell()) << json;
+}
+
+template <typename InputStream>
+static void TestSkipValueError(const char* json, ParseErrorCode expectedCode, size_t expectedOffset) {
+    InputStream s(json);
+    Reader reader;
+    ParseResult r = reader.SkipValue<kParseNoFlags>(s);
+    EXPECT_EQ(expectedCode, r.Code()) << json;
+    EXPECT_EQ(expectedOffset, r.Offset()) << json;
+}
+
+template <typename InputStream>
+static void TestSkipValueAll() {
+    TestSkipValue<InputStream>("null", 4);
+    TestSkipValue<InputStream>(" -1.5e10 , 2", 8);
+    TestSkipValue<InputStream>("\"a\\\"b\\\\\"]", 8);
+    TestSkipValue<InputStream>(" /* c */ {\"a\": [1, \"]}\", {}], \"b\": {\"c\": \"\\\\\"}} 1", 47);
+    TestSkipValue<InputStream>("[[[[]]]],[]", 8);
+
+    // Content is not validated
+    TestSkipValue<InputStream>("{ ] ", 3);
+    TestSkipValue<InputStream>("nul,", 3);
+
+    TestSkipValueError<InputStream>("", kParseErrorDocumentEmpty, 0);
+    TestSkipValueError<InputStream>("  ]", kParseErrorValueInvalid, 2);
+    TestSkipValueError<InputStream>("\"abc", kParseErrorStringMissQuotationMark, 4);
+    TestSkipValueError<InputStream>("\"abc\\", kParseErrorStringMissQuotationMark, 5);
+    TestSkipValueError<InputStream>("{\"a\": [1, 2]", kParseErrorObjectMissCommaOrCurlyBracket, 12);
+    TestSkipValueError<InputStream>("[\"]\"", kParseErrorArrayMissCommaOrSquareBracket, 4);
+}
+
+TEST(Reader, SkipValue) {
+    TestSkipValueAll<StringStream>();
+    TestSkipValueAll<CustomStringStream<UTF8<> > >();
+
+    // A stream derived from StringStream is skipped as itself
+    const char json[] = "{\"a\":[1,\"]\"]} ";
+    CountingStringStream s(json);
+    Reader reader;
+    EXPECT_FALSE(reader.SkipValue<kParseNoFlags>(s).IsError());
+    EXPECT_EQ(sizeof(json) - 2, s.count);
+}
+
+TEST(Reader, SkipValue_Long) {
+    // Cross several 64-byte blocks with strings and escapes on the boundaries
+    std::string json = "[";
+    for (int i = 0; i < 100; i++)
+        json += "{\"k\\\"\": [\"\\\\\", \"}]\"], \"n\": 12345},";
+    json += "0] ";
+    StringStream s(json.c_str());
+    Reader reader;
+    EXPECT_FALSE(reader.SkipValue<kParseNoFlags>(s).IsError());
+    EXPECT_EQ(json.size() - 1, s.Tell());
+
+    StringStream t(json.c_str());
+    BaseReaderHandler<> h;
+    EXPECT_FALSE(reader.Parse(t, h).IsError());
+    EXPECT_EQ(json.size(), t.Tell());
+}
+
+TEST(Reader, StructuralIndex_General) {
+    const char* json[] = {
+        "[1, {\"k\": [1, 2]}, null, false, true, \"string\", 1.2]",
+        " { \"a\" : \"b\" , \"c\" : [ ] , \"d\" : { } } ",
+        "\"string\"", "\"a\\\"b\\\\\"", "\"\\u0041\\uD834\\uDD1E\"", "123", "-1.5e10 ", "true", "null",
+        "{\"hello\":\"world\",\"t\":true,\"f\":false,\"n\":null,\"i\":123,\"pi\":3.1416,\"a\":[1,2,3]}",
+        "[\"{[:,]}\", \"\\\\\", \"\\\\\\\"\"]"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        TestStructuralIndex<kParseDefaultFlags>(json[i]);
+        TestStructuralIndex<kParseValidateEncodingFlag>(json[i]);
+        TestStructuralIndex<kParseNumbersAsStringsFlag>(json[i]);
+    }
+}
+
+TEST(Reader, StructuralIndex_LongText) {
+    // Strings and escapes at every position across the 64-byte blocks and the chunks
+    std::string json = "[";
+    for (size_t length = 0; length < 150; length++) {
+        json += "\"";
+        json.append(length, 'a');
+        json += "\", \"";
+        json.append(length, 'b');
+        json += (length % 3 == 0) ? "\\\\" : (length % 3 == 1) ? "\\\"" : "\\n";
+        json.append(length % 70, 'c');
+        json += "\",{\"";
+        json.append(length % 5, 'k');
+        json += "\":";
+        json.append(length % 65, ' ');
+        json += "12345678},";
+    }
+    json += "0]";
+    TestStructuralIndex<kParseDefaultFlags>(json.c_str());
+    TestStructuralIndex<kParseValidateEncodingFlag>(json.c_str());
+
+    // Errors far from the beginning
+    TestStructuralIndex<kParseDefaultFlags>((json + "]").c_str());
+    json[json.size() - 3] = ']';
+    TestStructuralIndex<kParseDefaultFlags>(json.c_str());
+    json[json.size() / 2] = '\t';
+    TestStructuralIndex<kParseDefaultFlags>(json.c_str());
+}
+
+TEST(Reader, StructuralIndex_Error) {
+    const char* json[] = {
+        "", "  ", "{}{}", "{1}", "{\"a\", 1}", "{\"a\"}", "{\"a\": 1", "[1 2 3]", "{\"a: 1",
+        "{\"a\":}", "{\"a\":]", "[1,2,}", "[}]", "[,]", "[1,,]", "{\"a\": 1,}", "[1,2,3,]",
+        "\"ab", "truE", "False", "true, false", "nulL", "null , null", "1a", "[1a]", "[1 a]",
+        "[\"a\"\"b\"]", "[\"a\"1]", "[\"a\\x\"]", "[\"a\tb\"]", "[\"\\u12\"]", "[\"\xC3\x28\"]",
+        "{\"a\"1}", "[tru]", "[-]", "[1.]", "[\"a\", [\"b\"", "[1] x", "x"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        TestStructuralIndex<kParseDefaultFlags>(json[i]);
+        TestStructuralIndex<kParseValidateEncodingFlag>(json[i]);
+        TestStructuralIndex<kParseStopWhenDoneFlag>(json[i]);
+        TestStructuralIndex<kParseTrailingCommasFlag | kParseNanAndInfFlag>(json[i]);
+    }
+}
+
+template <int e>
+static void TestStructuralIndexTermination(const char* json) {
+    Reader reader1, reader2;
+    TerminateHandler<e> h1, h2;
+    StringStream s1(json), s2(json);
+    ParseResult r1 = reader1.Parse(s1, h1);
+    ParseResult r2 = reader2.Parse<kParseStructuralIndexFlag>(s2, h2);
+    EXPECT_EQ(kParseErrorTermination, r2.Code()) << json;
+    EXPECT_EQ(r1.Offset(), r2.Offset()) << json;
+}
+
+TEST(Reader, StructuralIndex_Termination) {
+    TestStructuralIndexTermination<0>("[null]");
+    TestStructuralIndexTermination<1>("[true]");
+    TestStructuralIndexTermination<2>("[-1]");
+    TestStructuralIndexTermination<6>("[0.5]");
+    TestStructuralIndexTermination<8>("[\"a\"]");
+    TestStructuralIndexTermination<8>("[\"a\\n\"]");
+    TestStructuralIndexTermination<9>("[{}]");
+    TestStructuralIndexTermination<10>("[{\"a\":1}]");
+    TestStructuralIndexTermination<10>("[{\"\\u0041\":1}]");
+    TestStructuralIndexTermination<11>("[{\"a\":1}]");
+    TestStructuralIndexTermination<12>("{\"a\":[]}");
+    TestStructuralIndexTermination<13>("{\"a\":[1]}");
+}
+
 RAPIDJSON_DIAG_POP
@@ -16,6 +16,7 @@
 #include "rapidjson/internal/regex.h"
 
 using namespace rapidjson::internal;
+using rapidjson::SizeType;
 
 TEST(Regex, Single) {
     Regex re("a");
@@ -413,6 +414,31 @@ TEST(Regex, Unicode) {
     EXPECT_FALSE(rs.Match("a" EURO "\xAC" "b")); // unaware of UTF-8 will match
 }
 
+TEST(Regex, Unicode_Search) {
+    // Switch from the DFA to the NFA at the first non-ASCII character
+    Regex re("b" EURO "+c");
+    ASSERT_TRUE(re.IsValid());
+    RegexSearch rs(re);
+    EXPECT_TRUE(rs.Search("aab" EURO "c"));
+    EXPECT_TRUE(rs.Search("a" EURO "b" EURO EURO "cd"));
+    EXPECT_FALSE(rs.Search("aab" EURO "d"));
+    EXPECT_FALSE(rs.Search("a" EURO "c"));
+}
+
+TEST(Regex, ManyDfaStates) {
+    // The DFA needs 2^9 states, which exceeds RAPIDJSON_REGEX_MAX_DFA_STATES, so only the NFA is used
+    Regex re("(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)");
+    ASSERT_TRUE(re.IsValid());
+    RegexSearch rs(re);
+    EXPECT_TRUE(rs.Match("abbbbbbbb"));
+    EXPECT_TRUE(rs.Match("bbbbababababa"));
+    EXPECT_FALSE(rs.Match("bbbbbbbbb"));
+    EXPECT_FALSE(rs.Match("abbbbbbbbb"));
+    EXPECT_FALSE(rs.Match("abbbbbbb"));
+    EXPECT_TRUE(rs.Search("cabbbbbbbbc"));
+    EXPECT_FALSE(rs.Search("cbbbbbbbbbc"));
+}
+
 TEST(Regex, AnyCharacter) {
     Regex re(".");
     ASSERT_TRUE(re.IsValid());
@@ -635,4 +661,85 @@ TEST(Regex, Issue583) {
     ASSERT_TRUE(re.IsValid());
 }
 
+namespace {
+
+// Collects the indices found by RegexSet::Search() as a string of digits
+struct RegexSetHandler {
+    RegexSetHandler() : found() {}
+    void Found(SizeType index) { found += static_cast<char>('0' + index); }
+    std::string found;
+};
+
+std::string SearchAll(const RegexSet& set, const char* s) {
+    RegexSetHandler handler;
+    set.Search(s, handler);
+    return handler.found;
+}
+
+} // namespace
+
+TEST(Regex, RegexSet) {
+    Regex r0("^I_"), r1("30$"), r2("^a+b$"), r3("b[0-9]"), r4(EURO);
+    const Regex* regexes[] = { &r0, &r1, 0, &r2, &r3, &r4 };
+    RegexSet set(regexes, 6);
+    EXPECT_EQ(6u, set.GetRegexCount());
+
+    EXPECT_EQ("", SearchAll(set, ""));
+    EXPECT_EQ("", SearchAll(set, "xyz"));
+    EXPECT_EQ("01", SearchAll(set, "I_30"));
+    EXPECT_EQ("0", SearchAll(set, "I_300"));
+    EXPECT_EQ("1", SearchAll(set, "xI_30"));
+    EXPECT_EQ("3", SearchAll(set, "aaab"));
+    EXPECT_EQ("4", SearchAll(set, "aaab1"));
+    EXPECT_EQ("014", SearchAll(set, "I_b730"));
+    EXPECT_EQ("5", SearchAll(set, "a" EURO "b"));
+    EXPECT_EQ("045", SearchAll(set, "I_" EURO "b2"));
+    EXPECT_EQ("0", SearchAll(set, "I_Ã©"));
+}
+
+TEST(Regex, RegexSet_Empty) {
+    RegexSet set(0, 0);
+    EXPECT_EQ(0u, set.GetRegexCount());
+    EXPECT_EQ("", SearchAll(set, "abc"));
+}
+
+TEST(Regex, RegexSet_ManyDfaStates) {
+    // The product DFA would exceed RAPIDJSON_REGEX_MAX_DFA_STATES, so each regex is searched in turn
+    Regex r0("a(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)$"), r1("b(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)$"), r2("(a|b)*c");
+    const Regex* regexes[] = { &r0, &r1, &r2 };
+    RegexSet set(regexes, 3);
+    EXPECT_EQ("0", SearchAll(set, "abbbbbb"));
+    EXPECT_EQ("0", SearchAll(set, "babbbbbb"));
+    EXPECT_EQ("1", SearchAll(set, "bbbbbbb"));
+    EXPECT_EQ("2", SearchAll(set, "abc"));
+    EXPECT_EQ("", SearchAll(set, "ab"));
+}
+
+TEST(Regex, RegexSet_SameAsSearch) {
+    const char* patterns[] = { "^a", "b$", "^ab*c$", "a|b", "c+", "^$", "[^a]", "(ab){2}", "." };
+    const char* strings[] = { "", "a", "b", "c", "ab", "ba", "abc", "abbbc", "abab", "cba", "aabb", "ca", EURO, "a" EURO "b" };
+    const SizeType count = sizeof(patterns) / sizeof(patterns[0]);
+    Regex* regexes[count];
+    const Regex* pointers[count];
+    for (SizeType i = 0; i < count; i++) {
+        regexes[i] = new Regex(patterns[i]);
+        pointers[i] = regexes[i]->IsValid() ? regexes[i] : 0;
+    }
+    RegexSet set(pointers, count);
+
+    for (size_t j = 0; j < sizeof(strings) / sizeof(strings[0]); j++) {
+        std::string expected;
+        for (SizeType i = 0; i < count; i++)
+            if (pointers[i]) {
+                RegexSearch rs(*pointers[i]);
+                if (rs.Search(strings[j]))
+                    expected += static_cast<char>('0' + i);
+            }
+        EXPECT_EQ(expected, SearchAll(set, strings[j])) << strings[j];
+    }
+
+    for (SizeType i = 0; i < count; i++)
+        delete regexes[i];
+}
+
 #undef EURO
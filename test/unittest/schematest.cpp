@@ -16,6 +16,7 @@
 #include "rapidjson/schema.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
+#include "rapidjson/memorybuffer.h"
 
 #ifdef __clang__
 RAPIDJSON_DIAG_PUSH
@@ -231,6 +232,30 @@ TEST(SchemaValidator, Enum_InvalidType) {
         "}}");
 }
 
+TEST(SchemaValidator, Enum_Large) {
+    // Enough values to grow the enum set several times, with a duplicate
+    Document sd;
+    sd.SetObject();
+    Value e(kArrayType);
+    for (int i = 0; i < 1000; i++) {
+        char code[16];
+        sprintf(code, "SKU%04d", i);
+        e.PushBack(Value(code, sd.GetAllocator()).Move(), sd.GetAllocator());
+    }
+    e.PushBack(Value("SKU0000").Move(), sd.GetAllocator());
+    e.PushBack(Value(kObjectType).Move(), sd.GetAllocator());
+    sd.AddMember("enum", e, sd.GetAllocator());
+    SchemaDocument s(sd);
+
+    VALIDATE(s, "\"SKU0000\"", true);
+    VALIDATE(s, "\"SKU0999\"", true);
+    VALIDATE(s, "{}", true);
+    INVALIDATE(s, "\"SKU1000\"", "", "enum", "",
+        "{ \"enum\": { \"instanceRef\": \"#\", \"schemaRef\": \"#\" }}");
+    INVALIDATE(s, "[]", "", "enum", "",
+        "{ \"enum\": { \"instanceRef\": \"#\", \"schemaRef\": \"#\" }}");
+}
+
 TEST(SchemaValidator, AllOf) {
     {
         Document sd;
@@ -305,6 +330,33 @@ TEST(SchemaValidator, OneOf) {
         "{ \"oneOf\": { \"instanceRef\": \"#\", \"schemaRef\": \"#\", \"errors\": [{}, {}]}}");
 }
 
+TEST(SchemaValidator, OneOf_Discriminated) {
+    // A branch is no longer fed once it is invalid, but still reports its first error
+    Document sd;
+    sd.Parse(
+        "{\"oneOf\": ["
+        "  { \"properties\": { \"kind\": { \"enum\": [\"a\"] }, \"data\": { \"items\": { \"type\": \"string\" } } } },"
+        "  { \"properties\": { \"kind\": { \"enum\": [\"b\"] }, \"data\": { \"items\": { \"type\": \"number\" } } } }"
+        "]}");
+    SchemaDocument s(sd);
+
+    VALIDATE(s, "{\"kind\": \"a\", \"data\": [\"x\", \"y\"]}", true);
+    VALIDATE(s, "{\"kind\": \"b\", \"data\": [1, 2]}", true);
+    INVALIDATE(s, "{\"kind\": \"a\", \"data\": [\"x\", 2]}", "", "oneOf", "",
+        "{ \"oneOf\": {"
+        "    \"instanceRef\": \"#\", \"schemaRef\": \"#\","
+        "    \"errors\": ["
+        "      { \"type\": {"
+        "          \"instanceRef\": \"#/data/1\", \"schemaRef\": \"#/oneOf/0/properties/data/items\","
+        "          \"expected\": [\"string\"], \"actual\": \"integer\""
+        "      }},"
+        "      { \"enum\": {"
+        "          \"instanceRef\": \"#/kind\", \"schemaRef\": \"#/oneOf/1/properties/kind\""
+        "      }}"
+        "    ]"
+        "}}");
+}
+
 TEST(SchemaValidator, Not) {
     Document sd;
     sd.Parse("{\"not\":{ \"type\": \"string\"}}");
@@ -1049,6 +1101,54 @@ TEST(SchemaValidator, Object_Required) {
         "}}");
 }
 
+TEST(SchemaValidator, Object_ManyProperties) {
+    // Enough properties for collisions in the property table
+    StringBuffer schema, all, withoutRequired;
+    {
+        Writer<StringBuffer> w(schema), a(all), r(withoutRequired);
+        w.StartObject();
+        w.Key("properties");
+        w.StartObject();
+        a.StartObject();
+        r.StartObject();
+        for (int i = 0; i < 200; i++) {
+            char name[16];
+            sprintf(name, "p%d", i);
+            w.Key(name); w.StartObject(); w.Key("type"); w.String("integer"); w.EndObject();
+            a.Key(name); a.Int(i);
+            if (i != 150) {
+                r.Key(name); r.Int(i);
+            }
+        }
+        w.EndObject();
+        w.Key("required"); w.StartArray(); w.String("p150"); w.EndArray();
+        w.Key("additionalProperties"); w.Bool(false);
+        w.EndObject();
+        a.EndObject();
+        r.EndObject();
+    }
+    Document sd;
+    sd.Parse(schema.GetString());
+    SchemaDocument s(sd);
+
+    VALIDATE(s, all.GetString(), true);
+    INVALIDATE(s, "{ \"p150\": 1, \"p7\": \"7\" }", "/properties/p7", "type", "/p7",
+        "{ \"type\": {"
+        "    \"instanceRef\": \"#/p7\", \"schemaRef\": \"#/properties/p7\","
+        "    \"expected\": [\"integer\"], \"actual\": \"string\""
+        "}}");
+    INVALIDATE(s, "{ \"p150\": 1, \"p200\": 2 }", "", "additionalProperties", "/p200",
+        "{ \"additionalProperties\": {"
+        "    \"instanceRef\": \"#\", \"schemaRef\": \"#\","
+        "    \"disallowed\": \"p200\""
+        "}}");
+    INVALIDATE(s, withoutRequired.GetString(), "", "required", "",
+        "{ \"required\": {"
+        "    \"instanceRef\": \"#\", \"schemaRef\": \"#\","
+        "    \"missing\": [\"p150\"]"
+        "}}");
+}
+
 TEST(SchemaValidator, Object_Required_PassWithDefault) {
     Document sd;
     sd.Parse(
@@ -1218,6 +1318,39 @@ TEST(SchemaValidator, Object_PattternProperties_ErrorConflict) {
         "]}");
 }
 
+TEST(SchemaValidator, Object_PatternProperties_Many) {
+    Document sd;
+    sd.Parse(
+        "{"
+        "  \"type\": \"object\","
+        "  \"patternProperties\": {"
+        "    \"^s_\": { \"type\": \"string\" },"
+        "    \"^i_\": { \"type\": \"integer\" },"
+        "    \"_n$\": { \"minimum\": 0 },"
+        "    \"x\": { \"maxLength\": 3 }"
+        "  },"
+        "  \"additionalProperties\": false"
+        "}");
+    SchemaDocument s(sd);
+
+    VALIDATE(s, "{ \"s_a\": \"abc\", \"i_a\": 1, \"i_n\": 2, \"x\": \"abc\", \"s_\u00e9\": \"\u00e9\" }", true);
+    INVALIDATE(s, "{ \"i_n\": -1 }", "", "patternProperties", "/i_n",
+        "{ \"minimum\": {"
+        "    \"instanceRef\": \"#/i_n\", \"schemaRef\": \"#/patternProperties/_n%24\","
+        "    \"expected\": 0, \"actual\": -1"
+        "}}");
+    INVALIDATE(s, "{ \"s_\u00e9x\": \"abcd\" }", "", "patternProperties", "/s_\u00e9x",
+        "{ \"maxLength\": {"
+        "    \"instanceRef\": \"#/s_%C3%A9x\", \"schemaRef\": \"#/patternProperties/x\","
+        "    \"expected\": 3, \"actual\": \"abcd\""
+        "}}");
+    INVALIDATE(s, "{ \"y\": 1 }", "", "additionalProperties", "/y",
+        "{ \"additionalProperties\": {"
+        "    \"instanceRef\": \"#\", \"schemaRef\": \"#\","
+        "    \"disallowed\": \"y\""
+        "}}");
+}
+
 TEST(SchemaValidator, Object_Properties_PatternProperties) {
     Document sd;
     sd.Parse(
@@ -1429,6 +1562,39 @@ TEST(SchemaValidator, Array_UniqueItems) {
     VALIDATE(s, "[]", true);
 }
 
+TEST(SchemaValidator, Array_UniqueItems_Large) {
+    Document sd;
+    sd.Parse("{\"type\": \"array\", \"uniqueItems\": true}");
+    SchemaDocument s(sd);
+
+    // Enough elements to grow the hash set several times
+    StringBuffer unique, duplicate, duplicateObject;
+    {
+        Writer<StringBuffer> w1(unique), w2(duplicate), w3(duplicateObject);
+        w1.StartArray(); w2.StartArray(); w3.StartArray();
+        for (int i = 0; i < 1000; i++) {
+            w1.Int(i); w2.Int(i); w3.Int(i);
+        }
+        w1.StartObject(); w1.Key("a"); w1.Int(1); w1.Key("b"); w1.Int(2); w1.EndObject();
+        w2.Int(17);
+        w3.StartObject(); w3.Key("a"); w3.Int(1); w3.Key("b"); w3.Int(2); w3.EndObject();
+        w3.StartObject(); w3.Key("b"); w3.Int(2); w3.Key("a"); w3.Int(1); w3.EndObject();
+        w1.EndArray(); w2.EndArray(); w3.EndArray();
+    }
+
+    VALIDATE(s, unique.GetString(), true);
+    INVALIDATE(s, duplicate.GetString(), "", "uniqueItems", "/1000",
+        "{ \"uniqueItems\": {"
+        "    \"instanceRef\": \"#\", \"schemaRef\": \"#\","
+        "    \"duplicates\": [17, 1000]"
+        "}}");
+    INVALIDATE(s, duplicateObject.GetString(), "", "uniqueItems", "/1001",
+        "{ \"uniqueItems\": {"
+        "    \"instanceRef\": \"#\", \"schemaRef\": \"#\","
+        "    \"duplicates\": [1000, 1001]"
+        "}}");
+}
+
 TEST(SchemaValidator, Boolean) {
     Document sd;
     sd.Parse("{\"type\":\"boolean\"}");
@@ -1611,6 +1777,140 @@ TEST(SchemaValidator, EscapedPointer) {
         "}}");
 }
 
+TEST(SchemaValidator, NestedDocumentPointer) {
+    // The path is rebuilt from the names and indices only when an error is reported,
+    // including in the validators of allOf, which start from the path of their parent
+    Document sd;
+    sd.Parse(
+        "{"
+        "  \"properties\": {"
+        "    \"a/b\": { \"items\": { \"allOf\": [{ \"properties\": { \"c~d\": { \"type\": \"integer\" } } }] } }"
+        "  }"
+        "}");
+    SchemaDocument s(sd);
+    VALIDATE(s, "{\"a/b\": [{\"c~d\": 1}, {\"x\": [1, {\"y\": 2}]}], \"c~d\": \"x\"}", true);
+    INVALIDATE(s, "{\"e\": [0], \"a/b\": [{\"c~d\": 1}, {\"x\": [1, {\"y\": 2}], \"c~d\": \"x\"}]}", "/properties/a~1b/items", "allOf", "/a~1b/1",
+        "{ \"type\": {"
+        "    \"instanceRef\": \"#/a~1b/1/c~0d\", \"schemaRef\": \"#/properties/a~1b/items/allOf/0/properties/c~0d\","
+        "    \"expected\": [\"integer\"], \"actual\": \"string\""
+        "}}");
+}
+
+TEST(SchemaValidator, PercentEncodedDocumentPointer) {
+    Document sd;
+    sd.Parse("{\"additionalProperties\": { \"type\": \"integer\" }}");
+    SchemaDocument s(sd);
+    INVALIDATE(s, "{\"a b\": \"x\"}", "/additionalProperties", "type", "/a b",
+        "{ \"type\": {"
+        "    \"instanceRef\": \"#/a%20b\", \"schemaRef\": \"#/additionalProperties\","
+        "    \"expected\": [\"integer\"], \"actual\": \"string\""
+        "}}");
+}
+
+namespace {
+
+// Counts the allocations made for the validation states
+class CountingAllocator : public CrtAllocator {
+public:
+    void* Malloc(size_t size) { mallocCount++; return CrtAllocator::Malloc(size); }
+    void* Realloc(void* originalPtr, size_t originalSize, size_t newSize) {
+        if (!originalPtr) mallocCount++;
+        return CrtAllocator::Realloc(originalPtr, originalSize, newSize);
+    }
+    static size_t mallocCount;
+};
+
+size_t CountingAllocator::mallocCount = 0;
+
+} // namespace
+
+TEST(SchemaValidator, RecycledValidators) {
+    // The validators of allOf/oneOf branches and the hashers of uniqueItems are
+    // recycled for each element, so the allocations do not grow with the elements
+    typedef GenericSchemaValidator<SchemaDocument, BaseReaderHandler<UTF8<> >, CountingAllocator> CountingValidator;
+    Document sd;
+    sd.Parse(
+        "{ \"type\": \"array\", \"items\": { \"allOf\": ["
+        "    { \"type\": \"array\", \"uniqueItems\": true },"
+        "    { \"items\": { \"allOf\": [{ \"type\": \"integer\" }, { \"minimum\": 0 }] } }"
+        "]}}");
+    SchemaDocument s(sd);
+
+    size_t mallocCounts[2];
+    const int elementCounts[2] = { 10, 1000 };
+    for (int t = 0; t < 2; t++) {
+        StringBuffer sb;
+        Writer<StringBuffer> w(sb);
+        w.StartArray();
+        for (int i = 0; i < elementCounts[t]; i++) {
+            w.StartArray(); w.Int(i); w.Int(i + 1); w.EndArray();
+        }
+        w.EndArray();
+
+        Document d;
+        d.Parse(sb.GetString());
+        CountingAllocator::mallocCount = 0;
+        {
+            CountingValidator validator(s);
+            EXPECT_TRUE(d.Accept(validator));
+            validator.Reset();
+            EXPECT_TRUE(d.Accept(validator));
+        }
+        mallocCounts[t] = CountingAllocator::mallocCount;
+    }
+    // Per element and pass, only the 3 arrays of branch validators and the set of unique items are allocated
+    const size_t kMallocPerElement = 3 + 2;
+    EXPECT_EQ(2u * kMallocPerElement * static_cast<size_t>(elementCounts[1] - elementCounts[0]), mallocCounts[1] - mallocCounts[0]);
+
+    sd.Parse(
+        "{ \"type\": \"array\", \"items\": { \"oneOf\": ["
+        "    { \"type\": \"object\", \"required\": [\"radius\"], \"properties\": { \"radius\": { \"type\": \"number\" } } },"
+        "    { \"allOf\": [{ \"type\": \"object\" }, { \"required\": [\"side\"] }] },"
+        "    { \"type\": \"array\", \"uniqueItems\": true }"
+        "]}}");
+    SchemaDocument s2(sd);
+
+    // A recycled validator reports the path of the element it is reused for
+    INVALIDATE(s2, "[{\"radius\": 1}, {\"side\": 2}, [3], {\"radius\": \"4\"}]", "/items", "oneOf", "/3",
+        "{ \"oneOf\": {"
+        "    \"instanceRef\": \"#/3\", \"schemaRef\": \"#/items\","
+        "    \"errors\": ["
+        "      { \"type\": {"
+        "          \"instanceRef\": \"#/3/radius\", \"schemaRef\": \"#/items/oneOf/0/properties/radius\","
+        "          \"expected\": [\"number\"], \"actual\": \"string\""
+        "      }},"
+        "      { \"required\": {"
+        "          \"instanceRef\": \"#/3\", \"schemaRef\": \"#/items/oneOf/1/allOf/1\","
+        "          \"missing\": [\"side\"]"
+        "      }},"
+        "      { \"type\": {"
+        "          \"instanceRef\": \"#/3\", \"schemaRef\": \"#/items/oneOf/2\","
+        "          \"expected\": [\"array\"], \"actual\": \"object\""
+        "      }}"
+        "    ]"
+        "}}");
+}
+
+TEST(SchemaValidator, RecycledValidators_ClearStateAllocator) {
+    // No recycled validator or hasher is left in the state allocator after a validation,
+    // so it can be cleared before the validator is destroyed
+    typedef GenericSchemaValidator<SchemaDocument, BaseReaderHandler<UTF8<> >, MemoryPoolAllocator<> > PoolValidator;
+    Document sd;
+    sd.Parse("{ \"items\": { \"oneOf\": [{ \"type\": \"integer\" }, { \"allOf\": [{ \"type\": \"array\" }, { \"uniqueItems\": true }] }] } }");
+    SchemaDocument s(sd);
+    Document d;
+    d.Parse("[1, [2, 3], 4, [5]]");
+
+    MemoryPoolAllocator<> allocator;
+    for (int i = 0; i < 3; i++) {
+        PoolValidator validator(s, &allocator);
+        EXPECT_TRUE(d.Accept(validator));
+        validator.Reset();
+        EXPECT_TRUE(d.Accept(validator));
+        allocator.Clear();
+    }
+}
+
 template <typename Allocator>
 static char* ReadFile(const char* filename, Allocator& allocator) {
     const char *paths[] = {
@@ -1765,38 +2065,38 @@ private:
     char schemaBuffer_[128 * 1024];
 };
 
-TEST(SchemaValidator, TestSuite) {
-    const char* filenames[] = {
-        "additionalItems.json",
-        "additionalProperties.json",
-        "allOf.json",
-        "anyOf.json",
-        "default.json",
-        "definitions.json",
-        "dependencies.json",
-        "enum.json",
-        "items.json",
-        "maximum.json",
-        "maxItems.json",
-        "maxLength.json",
-        "maxProperties.json",
-        "minimum.json",
-        "minItems.json",
-        "minLength.json",
-        "minProperties.json",
-        "multipleOf.json",
-        "not.json",
-        "oneOf.json",
-        "pattern.json",
-        "patternProperties.json",
-        "properties.json",
-        "ref.json",
-        "refRemote.json",
-        "required.json",
-        "type.json",
-        "uniqueItems.json"
-    };
+static const char* const kTestSuiteFilenames[] = {
+    "additionalItems.json",
+    "additionalProperties.json",
+    "allOf.json",
+    "anyOf.json",
+    "default.json",
+    "definitions.json",
+    "dependencies.json",
+    "enum.json",
+    "items.json",
+    "maximum.json",
+    "maxItems.json",
+    "maxLength.json",
+    "maxProperties.json",
+    "minimum.json",
+    "minItems.json",
+    "minLength.json",
+    "minProperties.json",
+    "multipleOf.json",
+    "not.json",
+    "oneOf.json",
+    "pattern.json",
+    "patternProperties.json",
+    "properties.json",
+    "ref.json",
+    "refRemote.json",
+    "required.json",
+    "type.json",
+    "uniqueItems.json"
+};
 
+TEST(SchemaValidator, TestSuite) {
     const char* onlyRunDescription = 0;
     //const char* onlyRunDescription = "a string is a string";
 
@@ -1817,9 +2117,9 @@ TEST(SchemaValidator, TestSuite) {
     MemoryPoolAllocator<> schemaAllocator(schemaBuffer, sizeof(schemaBuffer));
     MemoryPoolAllocator<> validatorAllocator(validatorBuffer, sizeof(validatorBuffer));
 
-    for (size_t i = 0; i < sizeof(filenames) / sizeof(filenames[0]); i++) {
+    for (size_t i = 0; i < sizeof(kTestSuiteFilenames) / sizeof(kTestSuiteFilenames[0]); i++) {
         char filename[FILENAME_MAX];
-        sprintf(filename, "jsonschema/tests/draft4/%s", filenames[i]);
+        sprintf(filename, "jsonschema/tests/draft4/%s", kTestSuiteFilenames[i]);
         char* json = ReadFile(filename, jsonAllocator);
         if (!json) {
             printf("json test suite file %s not found", filename);
@@ -1835,7 +2135,7 @@ TEST(SchemaValidator, TestSuite) {
             else {
                 for (Value::ConstValueIterator schemaItr = d.Begin(); schemaItr != d.End(); ++schemaItr) {
                     {
-                        SchemaDocumentType schema((*schemaItr)["schema"], filenames[i], static_cast<SizeType>(strlen(filenames[i])), &provider, &schemaAllocator);
+                        SchemaDocumentType schema((*schemaItr)["schema"], kTestSuiteFilenames[i], static_cast<SizeType>(strlen(kTestSuiteFilenames[i])), &provider, &schemaAllocator);
                         GenericSchemaValidator<SchemaDocumentType, BaseReaderHandler<UTF8<> >, MemoryPoolAllocator<> > validator(schema, &validatorAllocator);
                         const char* description1 = (*schemaItr)["description"].GetString();
                         const Value& tests = (*schemaItr)["tests"];
@@ -1869,6 +2169,143 @@ TEST(SchemaValidator, TestSuite) {
     //     ADD_FAILURE();
 }
 
+template <typename SchemaDocumentType>
+static std::string ValidateToString(const SchemaDocumentType& schema, const Value& data) {
+    GenericSchemaValidator<SchemaDocumentType> validator(schema);
+    bool valid = data.Accept(validator);
+    StringBuffer sb;
+    Writer<StringBuffer> w(sb);
+    validator.GetError().Accept(w);
+    return std::string(valid ? "valid " : "invalid ") + sb.GetString();
+}
+
+TEST(SchemaValidator, TestSuite_Image) {
+    // A schema document loaded from its image validates as the original one, including the errors
+    typedef GenericSchemaDocument<Value, MemoryPoolAllocator<> > SchemaDocumentType;
+    RemoteSchemaDocumentProvider<SchemaDocumentType> provider;
+
+    for (size_t i = 0; i < sizeof(kTestSuiteFilenames) / sizeof(kTestSuiteFilenames[0]); i++) {
+        char filename[FILENAME_MAX];
+        sprintf(filename, "jsonschema/tests/draft4/%s", kTestSuiteFilenames[i]);
+        CrtAllocator allocator;
+        char* json = ReadFile(filename, allocator);
+        ASSERT_TRUE(json != 0) << filename;
+        Document d;
+        d.Parse(json);
+        CrtAllocator::Free(json);
+        ASSERT_FALSE(d.HasParseError()) << filename;
+
+        for (Value::ConstValueIterator schemaItr = d.Begin(); schemaItr != d.End(); ++schemaItr) {
+            SchemaDocumentType schema((*schemaItr)["schema"], kTestSuiteFilenames[i], static_cast<SizeType>(strlen(kTestSuiteFilenames[i])), &provider);
+            MemoryBuffer image;
+            schema.Serialize(image);
+            SchemaDocumentType loaded(image.GetBuffer(), image.GetSize());
+            EXPECT_TRUE(loaded.IsValid());
+
+            const Value& tests = (*schemaItr)["tests"];
+            for (Value::ConstValueIterator testItr = tests.Begin(); testItr != tests.End(); ++testItr)
+                EXPECT_EQ(ValidateToString(schema, (*testItr)["data"]), ValidateToString(loaded, (*testItr)["data"]))
+                    << filename << ": " << (*schemaItr)["description"].GetString() << ": " << (*testItr)["description"].GetString();
+        }
+    }
+}
+
+TEST(SchemaValidator, Image) {
+    Document sd;
+    sd.Parse(
+        "{"
+        "  \"type\": \"object\","
+        "  \"properties\": {"
+        "    \"a\": { \"$ref\": \"#/definitions/positive\" },"
+        "    \"b\": { \"type\": \"string\", \"pattern\": \"^[a-z]+$\" }"
+        "  },"
+        "  \"definitions\": { \"positive\": { \"type\": \"integer\", \"minimum\": 1 } }"
+        "}");
+    SchemaDocument s(sd);
+    MemoryBuffer image;
+    s.Serialize(image);
+
+    SchemaDocument loaded(image.GetBuffer(), image.GetSize());
+    EXPECT_TRUE(loaded.IsValid());
+    VALIDATE(loaded, "{ \"a\": 1, \"b\": \"xyz\" }", true);
+    INVALIDATE(loaded, "{ \"a\": 0 }", "/definitions/positive", "minimum", "/a",
+        "{ \"minimum\": {"
+        "    \"instanceRef\": \"#/a\", \"schemaRef\": \"#/definitions/positive\","
+        "    \"expected\": 1, \"actual\": 0"
+        "}}");
+
+    // The loaded document is also a remote document
+    Document rd;
+    rd.Parse("{ \"$ref\": \"http://example.com/s.json#/definitions/positive\" }");
+    class Provider : public IRemoteSchemaDocumentProvider {
+    public:
+        Provider(const SchemaDocument& sd) : sd_(sd) {}
+        virtual const SchemaDocument* GetRemoteDocument(const char*, SizeType) { return &sd_; }
+    private:
+        const SchemaDocument& sd_;
+    } provider(loaded);
+    SchemaDocument rs(rd, 0, 0, &provider);
+    VALIDATE(rs, "1", true);
+    VALIDATE(rs, "0", false);
+}
+
+TEST(SchemaValidator, Image_Malformed) {
+    Document sd;
+    sd.Parse("{ \"items\": { \"enum\": [1, \"a\"] }, \"patternProperties\": { \"^a\": { \"not\": {} } } }");
+    SchemaDocument s(sd);
+    MemoryBuffer image;
+    s.Serialize(image);
+
+    // Every truncation of the image is rejected, and the root schema accepts any value
+    for (size_t size = 0; size < image.GetSize(); size += sizeof(uint32_t)) {
+        SchemaDocument loaded(image.GetBuffer(), size);
+        EXPECT_FALSE(loaded.IsValid()) << size;
+        VALIDATE(loaded, "[2]", true);
+    }
+
+    MemoryBuffer corrupted;
+    for (size_t i = 0; i < image.GetSize(); i++)
+        corrupted.Put(i == 0 ? 'X' : image.GetBuffer()[i]);
+    SchemaDocument loaded(corrupted.GetBuffer(), corrupted.GetSize());
+    EXPECT_FALSE(loaded.IsValid());
+
+    // Changing any byte either is rejected, or gives schemas which can still validate
+    const char* jsons[] = { "null", "2", "\"a\"", "[1, \"a\", [], {}]", "{\"ab\": 1, \"b\": [2]}" };
+    const unsigned char flips[] = { 0x00, 0x01, 0x7F, 0x80, 0xFF };   // the first one clears the byte
+    for (size_t i = 0; i < image.GetSize(); i++) {
+        for (size_t f = 0; f < sizeof(flips); f++) {
+            std::string bytes(image.GetBuffer(), image.GetSize());
+            bytes[i] = static_cast<char>(f == 0 ? 0 : bytes[i] ^ static_cast<char>(flips[f]));
+            SchemaDocument flipped(bytes.data(), bytes.size());
+            for (size_t j = 0; j < sizeof(jsons) / sizeof(jsons[0]); j++) {
+                Document d;
+                d.Parse(jsons[j]);
+                SchemaValidator validator(flipped);
+                d.Accept(validator);
+                if (!flipped.IsValid()) {
+                    EXPECT_TRUE(validator.IsValid()) << i;
+                }
+            }
+        }
+    }
+
+    // Subschemas validating the same value must not lead back to their schema
+    Document cd;
+    cd.Parse("{ \"properties\": { \"a\": { \"$ref\": \"#\" } }, \"anyOf\": [{}, { \"not\": { \"$ref\": \"#\" } }] }");
+    SchemaDocument cyclic(cd);
+    MemoryBuffer cyclicImage;
+    cyclic.Serialize(cyclicImage);
+    EXPECT_FALSE(SchemaDocument(cyclicImage.GetBuffer(), cyclicImage.GetSize()).IsValid());
+
+    cd.Parse("{ \"properties\": { \"a\": { \"$ref\": \"#\" } }, \"anyOf\": [{}, { \"not\": {} }] }");
+    SchemaDocument recursive(cd);
+    MemoryBuffer recursiveImage;
+    recursive.Serialize(recursiveImage);
+    SchemaDocument loadedRecursive(recursiveImage.GetBuffer(), recursiveImage.GetSize());
+    EXPECT_TRUE(loadedRecursive.IsValid());
+    VALIDATE(loadedRecursive, "{\"a\": {\"a\": {}}}", true);
+}
+
 TEST(SchemaValidatingReader, Simple) {
     Document sd;
     sd.Parse("{ \"type\": \"string\", \"enum\" : [\"red\", \"amber\", \"green\"] }");
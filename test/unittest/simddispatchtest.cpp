@@ -0,0 +1,182 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Tests the runtime dispatched SIMD kernels at every level supported by the
+// running CPU. The tests prefix with SIMD so they are skipped by Valgrind test.
+
+#include "unittest.h"
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+
+#define RAPIDJSON_SIMD_DISPATCH
+#define RAPIDJSON_NAMESPACE rapidjson_dispatch
+
+#include "rapidjson/reader.h"
+#include "rapidjson/writer.h"
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+using namespace rapidjson_dispatch;
+
+namespace {
+
+// Restores the automatically selected level when a test finishes.
+class ScopedSimdLevel {
+public:
+    explicit ScopedSimdLevel(SimdLevel level) : previous_(GetSimdLevel()) { level_ = SetSimdLevel(level); }
+    ~ScopedSimdLevel() { SetSimdLevel(previous_); }
+    SimdLevel Level() const { return level_; }
+
+private:
+    SimdLevel previous_;
+    SimdLevel level_;
+};
+
+struct CopyStringHandler : BaseReaderHandler<UTF8<>, CopyStringHandler> {
+    bool String(const char* str, SizeType length, bool) {
+        s.assign(str, length);
+        return true;
+    }
+    std::string s;
+};
+
+void TestSkipWhitespace() {
+    char buffer[1024 + 64 + 1];
+    for (size_t offset = 0; offset < 64; offset += 7) {
+        for (size_t step = 1; step < 80; step++) {
+            char* json = buffer + offset;
+            for (size_t i = 0; i < 1024; i++)
+                json[i] = " \t\r\n"[i % 4];
+            for (size_t i = 0; i < 1024; i += step)
+                json[i] = 'X';
+            json[1024] = '\0';
+
+            StringStream s(json);
+            MemoryStream ms(json, 1024);
+            EncodedInputStream<UTF8<>, MemoryStream> es(ms);
+            for (size_t i = 0; i < 1024; i += step) {
+                SkipWhitespace(s);
+                SkipWhitespace(es);
+                EXPECT_EQ(i, s.Tell());
+                EXPECT_EQ('X', s.Take());
+                EXPECT_EQ('X', es.Take());
+            }
+            SkipWhitespace(s);
+            SkipWhitespace(es);
+            EXPECT_EQ('\0', s.Peek());
+            EXPECT_EQ('\0', es.Peek());
+        }
+    }
+}
+
+template <unsigned parseFlags>
+void TestScanCopyUnescapedString() {
+    char buffer[1024 + 8 + 64];
+    for (size_t offset = 0; offset < 64; offset += 5) {
+        for (size_t step = 0; step < 300; step++) {
+            for (size_t e = 0; e < 3; e++) {
+                // "ABCD...<escape>ABCD..."
+                std::string expected;
+                char* json = buffer + offset;
+                char* p = json;
+                *p++ = '\"';
+                for (size_t i = 0; i < step; i++)
+                    expected += *p++ = "ABCD"[i % 4];
+                *p++ = '\\';
+                *p++ = "n\\\""[e];
+                expected += "\n\\\""[e];
+                for (size_t i = 0; i < step; i++)
+                    expected += *p++ = "EFGH"[i % 4];
+                *p++ = '\"';
+                *p++ = '\0';
+
+                StringStream s(json);
+                Reader reader;
+                CopyStringHandler h;
+                if (parseFlags & kParseInsituFlag) {
+                    InsituStringStream is(json);
+                    EXPECT_TRUE(reader.Parse<parseFlags>(is, h));
+                }
+                else
+                    EXPECT_TRUE(reader.Parse<parseFlags>(s, h));
+                EXPECT_EQ(expected, h.s);
+            }
+        }
+    }
+}
+
+void TestScanWriteUnescapedString() {
+    char buffer[1024 + 1 + 64];
+    for (size_t offset = 0; offset < 64; offset += 3) {
+        for (size_t step = 0; step < 300; step++) {
+            char* s = buffer + offset;
+            char* p = s;
+            for (size_t i = 0; i < step; i++)
+                *p++ = "ABCD"[i % 4];
+            const char escape = "\x01\n\\\""[step % 4];
+            *p++ = escape;
+            for (size_t i = 0; i < step; i++)
+                *p++ = "ABCD"[i % 4];
+
+            std::string expected = "\"" + std::string(s, step);
+            expected += escape == '\x01' ? "\\u0001" : escape == '\n' ? "\\n" : escape == '\\' ? "\\\\" : "\\\"";
+            expected += std::string(s, step) + "\"";
+
+            StringBuffer sb;
+            Writer<StringBuffer> writer(sb);
+            writer.String(s, SizeType(step * 2 + 1));
+            EXPECT_EQ(expected, std::string(sb.GetString(), sb.GetSize()));
+        }
+    }
+}
+
+} // namespace
+
+TEST(SIMD, Dispatch_Level) {
+    const SimdLevel supported = GetSupportedSimdLevel();
+    EXPECT_EQ(supported, GetSimdLevel());
+#if defined(__x86_64__) || defined(_M_X64)
+    EXPECT_GE(supported, kSimdLevelSSE2);   // SSE2 is part of x86-64
+#endif
+    {
+        ScopedSimdLevel level(kSimdLevelNone);
+        EXPECT_EQ(kSimdLevelNone, level.Level());
+        EXPECT_EQ(kSimdLevelNone, GetSimdLevel());
+    }
+    {
+        ScopedSimdLevel level(kSimdLevelAVX512); // lowered to what the CPU supports
+        EXPECT_EQ(supported, level.Level());
+    }
+    EXPECT_EQ(supported, GetSimdLevel());
+}
+
+TEST(SIMD, Dispatch_AllLevels) {
+    for (int l = kSimdLevelNone; l <= GetSupportedSimdLevel(); l++) {
+        ScopedSimdLevel level(static_cast<SimdLevel>(l));
+        EXPECT_EQ(l, level.Level());
+        TestSkipWhitespace();
+        TestScanCopyUnescapedString<kParseDefaultFlags>();
+        TestScanCopyUnescapedString<kParseInsituFlag>();
+        TestScanWriteUnescapedString();
+    }
+}
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // x86
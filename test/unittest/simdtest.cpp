@@ -15,9 +15,13 @@
 // Since Travis CI installs old Valgrind 3.7.0, which fails with some SSE4.2
 // The unit tests prefix with SIMD should be skipped by Valgrind test
 
-// __SSE2__ and __SSE4_2__ are recognized by gcc, clang, and the Intel compiler.
-// We use -march=native with gmake to enable -msse2 and -msse4.2, if supported.
-#if defined(__SSE4_2__)
+// __SSE2__, __SSE4_2__, __AVX2__ and __AVX512BW__ are recognized by gcc, clang, and the Intel compiler.
+// We use -march=native with gmake to enable -msse2, -msse4.2, -mavx2 and -mavx512bw, if supported.
+#if defined(__AVX512BW__)
+#  define RAPIDJSON_AVX512
+#elif defined(__AVX2__)
+#  define RAPIDJSON_AVX2
+#elif defined(__SSE4_2__)
 #  define RAPIDJSON_SSE42
 #elif defined(__SSE2__)
 #  define RAPIDJSON_SSE2
@@ -43,6 +47,10 @@ using namespace rapidjson_simd;
 #define SIMD_SUFFIX(name) name##_SSE2
 #elif defined(RAPIDJSON_SSE42)
 #define SIMD_SUFFIX(name) name##_SSE42
+#elif defined(RAPIDJSON_AVX2)
+#define SIMD_SUFFIX(name) name##_AVX2
+#elif defined(RAPIDJSON_AVX512)
+#define SIMD_SUFFIX(name) name##_AVX512
 #elif defined(RAPIDJSON_NEON)
 #define SIMD_SUFFIX(name) name##_NEON
 #else
@@ -104,16 +112,16 @@ struct ScanCopyUnescapedStringHandler : BaseReaderHandler<UTF8<>, ScanCopyUnesca
         memcpy(buffer, str, length + 1);
         return true;
     }
-    char buffer[1024 + 5 + 32];
+    char buffer[1024 + 5 + 64];
 };
 
 template <unsigned parseFlags, typename StreamType>
 void TestScanCopyUnescapedString() {
-    char buffer[1024 + 5 + 32];
-    char backup[1024 + 5 + 32];
+    char buffer[1024 + 5 + 64];
+    char backup[1024 + 5 + 64];
 
     // Test "ABCDABCD...\\"
-    for (size_t offset = 0; offset < 32; offset++) {
+    for (size_t offset = 0; offset < 64; offset++) {
         for (size_t step = 0; step < 1024; step++) {
             char* json = buffer + offset;
             char *p = json;
@@ -137,7 +145,7 @@ void TestScanCopyUnescapedString() {
     }
 
     // Test "\\ABCDABCD..."
-    for (size_t offset = 0; offset < 32; offset++) {
+    for (size_t offset = 0; offset < 64; offset++) {
         for (size_t step = 0; step < 1024; step++) {
             char* json = buffer + offset;
             char *p = json;
@@ -166,9 +174,73 @@ TEST(SIMD, SIMD_SUFFIX(ScanCopyUnescapedString)) {
     TestScanCopyUnescapedString<kParseInsituFlag, InsituStringStream>();
 }
 
+struct ParseDigitsHandler : BaseReaderHandler<UTF8<>, ParseDigitsHandler> {
+    ParseDigitsHandler() : i64(), u64(), d(), type() {}
+    bool Int(int i) { i64 = i; type = 'i'; return true; }
+    bool Uint(unsigned u) { u64 = u; type = 'u'; return true; }
+    bool Int64(int64_t i) { i64 = i; type = 'i'; return true; }
+    bool Uint64(uint64_t u) { u64 = u; type = 'u'; return true; }
+    bool Double(double x) { d = x; type = 'd'; return true; }
+    int64_t i64;
+    uint64_t u64;
+    double d;
+    char type;
+};
+
+template <unsigned parseFlags, typename StreamType>
+void TestParseDigits() {
+    char buffer[64 + 16];
+    const char* suffixes[] = { "", ",", "]", "/", ":", ".5", "e1" };
+    for (size_t offset = 0; offset < 16; offset++) {
+        for (size_t length = 1; length <= 21; length++) {
+            for (size_t k = 0; k < sizeof(suffixes) / sizeof(suffixes[0]); k++) {
+                for (int minus = 0; minus < 2; minus++) {
+                    std::string number(minus ? "-" : "");
+                    for (size_t i = 0; i < length; i++)
+                        number += static_cast<char>('1' + (i * 7 + offset) % 9);
+                    if (k < 5) {
+                        // Only the number is parsed from "<number><suffix>"
+                        char* json = buffer + offset;
+                        strcpy(json, number.c_str());
+                        strcat(json, suffixes[k]);
+                        StreamType s(json);
+                        Reader reader;
+                        ParseDigitsHandler h;
+                        reader.Parse<parseFlags | kParseStopWhenDoneFlag>(s, h);
+                        EXPECT_EQ(number.size(), s.Tell()) << json;
+                        if (h.type == 'i')
+                            EXPECT_EQ(strtoll(number.c_str(), 0, 10), h.i64) << number;
+                        else if (h.type == 'u')
+                            EXPECT_EQ(strtoull(number.c_str(), 0, 10), h.u64) << number;
+                        else
+                            EXPECT_DOUBLE_EQ(strtod(number.c_str(), 0), h.d) << number;
+                        EXPECT_EQ(length <= 18 ? (minus ? 'i' : 'u') : length >= 20 ? 'd' : h.type, h.type) << number;
+                    }
+                    else {
+                        char* json = buffer + offset;
+                        strcpy(json, number.c_str());
+                        strcat(json, suffixes[k]);
+                        StreamType s(json);
+                        Reader reader;
+                        ParseDigitsHandler h;
+                        reader.Parse<parseFlags>(s, h);
+                        EXPECT_EQ('d', h.type);
+                        EXPECT_DOUBLE_EQ(strtod((number + suffixes[k]).c_str(), 0), h.d) << number;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(SIMD, SIMD_SUFFIX(ParseDigits)) {
+    TestParseDigits<kParseDefaultFlags, StringStream>();
+    TestParseDigits<kParseInsituFlag, InsituStringStream>();
+}
+
 TEST(SIMD, SIMD_SUFFIX(ScanWriteUnescapedString)) {
-    char buffer[2048 + 1 + 32];
-    for (size_t offset = 0; offset < 32; offset++) {
+    char buffer[2048 + 1 + 64];
+    for (size_t offset = 0; offset < 64; offset++) {
         for (size_t step = 0; step < 1024; step++) {
             char* s = buffer + offset;
             char* p = s;
@@ -16,6 +16,8 @@
 
 #include "rapidjson/internal/strtod.h"
 
+#include <cstring>
+
 #ifdef __clang__
 RAPIDJSON_DIAG_PUSH
 RAPIDJSON_DIAG_OFF(unreachable-code)
@@ -127,6 +129,34 @@ TEST(Strtod, CheckApproximationCase) {
     EXPECT_EQ(-1, delta.Compare(hS));
 }
 
+static uint64_t StrtodEiselLemireBits(const char* decimals, int dExp) {
+    double d = 0.0;
+    EXPECT_TRUE(StrtodEiselLemire(decimals, static_cast<int>(std::strlen(decimals)), dExp, &d));
+    return Double(d).Uint64Value();
+}
+
+TEST(Strtod, EiselLemire) {
+    EXPECT_EQ(RAPIDJSON_UINT64_C2(0x3FB99999, 0x9999999A), StrtodEiselLemireBits("1", -1));                    // 0.1
+    EXPECT_EQ(RAPIDJSON_UINT64_C2(0x44B52D02, 0xC7E14AF6), StrtodEiselLemireBits("1", 23));                    // 1e23
+    EXPECT_EQ(RAPIDJSON_UINT64_C2(0x7FEFFFFF, 0xFFFFFFFF), StrtodEiselLemireBits("17976931348623157", 292));   // DBL_MAX
+    EXPECT_EQ(RAPIDJSON_UINT64_C2(0x7FF00000, 0x00000000), StrtodEiselLemireBits("17976931348623159", 292));   // infinity
+    EXPECT_EQ(RAPIDJSON_UINT64_C2(0x00100000, 0x00000000), StrtodEiselLemireBits("22250738585072014", -324));  // DBL_MIN
+    EXPECT_EQ(RAPIDJSON_UINT64_C2(0x000FFFFF, 0xFFFFFFFF), StrtodEiselLemireBits("22250738585072009", -324));  // largest subnormal
+    EXPECT_EQ(RAPIDJSON_UINT64_C2(0x00000000, 0x00000001), StrtodEiselLemireBits("49406564584124654", -340));  // smallest subnormal
+    EXPECT_EQ(RAPIDJSON_UINT64_C2(0x00000000, 0x00000000), StrtodEiselLemireBits("1", -342));
+
+    // Exactly halfway between two doubles: round to even
+    EXPECT_EQ(RAPIDJSON_UINT64_C2(0x43400000, 0x00000000), StrtodEiselLemireBits("9007199254740993", 0));      // 2^53 + 1
+    EXPECT_EQ(RAPIDJSON_UINT64_C2(0x43400000, 0x00000002), StrtodEiselLemireBits("9007199254740995", 0));      // 2^53 + 3
+
+    // More than 19 digits, where the truncated significand and its successor round alike
+    EXPECT_EQ(RAPIDJSON_UINT64_C2(0x44F056E0, 0xF36A6444), StrtodEiselLemireBits("1234567890123456789012345", 0));
+
+    // ... or not: 2^53 + 1 + 10^-7 rounds up, but its first 19 digits are halfway, which is left to the big integer comparison
+    double d = 0.0;
+    EXPECT_FALSE(StrtodEiselLemire("90071992547409930000001", 23, -7, &d));
+}
+
 #ifdef __clang__
 RAPIDJSON_DIAG_POP
 #endif